@@ -0,0 +1,96 @@
+/**
+ * @file	main.cpp
+ * @brief	Scene baking tool (converts OVO files into engine scene caches)
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ovo_archive.h>
+#include <ovo_parser.h>
+#include <scene_cache.h>
+
+/**
+ * Prints the command-line usage of the tool.
+ */
+static void print_usage() {
+    fprintf(stderr,
+        "Usage: lrvg-bake [options] <file.ovo>...\n"
+        "Bakes OVO files into scene caches, written next to them unless -o is given.\n"
+        "The caches must be baked with the same OVO parser settings as the application.\n"
+        "With --compress, OVO files are compressed into .ovz files instead.\n\n"
+        "Options:\n"
+        "  -o <path>        output path (single input only)\n"
+        "  --lods <n>       generate n levels of detail for meshes without any (default: 0)\n"
+        "  --meshlets <n>   split levels with at least n faces into meshlets, 0 to disable\n"
+        "  --no-optimize    do not optimize meshes\n"
+        "  --force          bake even if the cache is up to date\n"
+        "  --compress       write compressed OVO files instead of scene caches\n");
+}
+
+/**
+ * Application entry point.
+ *
+ * @param argc number of command-line arguments passed
+ * @param argv array containing up to argc passed arguments
+ * @return error code (0 on success, error code otherwise)
+ */
+int main(int argc, char *argv[]) {
+    std::vector<std::string> inputs;
+    std::string output;
+    bool force = false;
+    bool compress = false;
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-o") == 0 && has_value) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--lods") == 0 && has_value) {
+            lrvg::OVOParser::set_lod_generation((unsigned int)atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--meshlets") == 0 && has_value) {
+            lrvg::OVOParser::set_meshlet_generation((size_t)atoll(argv[++i]));
+        } else if (strcmp(argv[i], "--no-optimize") == 0) {
+            lrvg::OVOParser::set_mesh_optimization(false);
+        } else if (strcmp(argv[i], "--force") == 0) {
+            force = true;
+        } else if (strcmp(argv[i], "--compress") == 0) {
+            compress = true;
+        } else if (argv[i][0] == '-') {
+            print_usage();
+            return EXIT_FAILURE;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty() || (!output.empty() && inputs.size() > 1)) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    for (const std::string &input : inputs) {
+        if (compress) {
+            const std::string path = output.empty() ? lrvg::OVOArchive::get_default_path(input) : output;
+            if (lrvg::OVOArchive::write(input, path)) {
+                printf("%s -> %s\n", input.c_str(), path.c_str());
+            } else {
+                failures++;
+            }
+            continue;
+        }
+        const std::string path = output.empty() ? lrvg::SceneCache::get_default_path(input) : output;
+        if (!force && lrvg::SceneCache::is_valid(path, input)) {
+            printf("%s is up to date\n", path.c_str());
+        } else if (lrvg::SceneCache::bake(input, path)) {
+            printf("%s -> %s\n", input.c_str(), path.c_str());
+        } else {
+            failures++;
+        }
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
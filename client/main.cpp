@@ -18,6 +18,7 @@
 #include <directional_light.h>
 #include <point_light.h>
 #include <ovo_parser.h>
+#include <scene_cache.h>
 
 std::shared_ptr<lrvg::PerspectiveCamera>    saved_persp_camera = nullptr;
 std::shared_ptr<lrvg::OrthoCamera>          saved_ortho_camera = nullptr;
@@ -74,7 +75,10 @@ int main() {
     });
 
     // Scene setup
-    root = lrvg::OVOParser::from_file("HanoiBased.ovo");
+    root = lrvg::SceneCache::load(lrvg::SceneCache::get_default_path("HanoiBased.ovo"), "HanoiBased.ovo");
+    if (root == nullptr) {
+        root = lrvg::OVOParser::from_file("HanoiBased.ovo");
+    }
     if (LIKELY(saved_ortho_camera == nullptr || saved_persp_camera == nullptr)) {
         std::shared_ptr<lrvg::OrthoCamera> camera_1 = std::make_shared<lrvg::OrthoCamera>();
         camera_1->set_zoom(zoom);
@@ -0,0 +1,134 @@
+/**
+ * @file	atom.cpp
+ * @brief	Interned string class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "atom.h"
+
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "common.h"
+
+using namespace lrvg;
+
+namespace {
+
+struct StringHash {
+	using is_transparent = void;
+	size_t operator()(const std::string_view key) const {
+		return std::hash<std::string_view>{}(key);
+	}
+};
+
+/**
+ * Global string table. Set elements never move, so atoms keep pointing at them;
+ * the table is never destroyed, so that atoms held by static objects stay valid at exit.
+ */
+struct AtomTable {
+	std::shared_mutex mutex;
+	std::unordered_set<std::string, StringHash, std::equal_to<>> strings;
+	static AtomTable &get() {
+		static AtomTable *table = new AtomTable();
+		return *table;
+	}
+};
+
+const std::string empty_string;
+
+}
+
+/**
+ * Creates the null atom, standing for the empty string.
+ */
+ENG_API Atom::Atom() : entry{ nullptr } {
+}
+
+/**
+ * Creates an atom from a string, adding the string to the global table if not yet there.
+ * The empty string maps to the null atom.
+ *
+ * @param str The string to intern.
+ */
+ENG_API Atom::Atom(const std::string_view str) : entry{ nullptr } {
+	if (str.empty()) return;
+	AtomTable &table = AtomTable::get();
+	{
+		std::shared_lock<std::shared_mutex> lock(table.mutex);
+		const auto it = table.strings.find(str);
+		if (LIKELY(it != table.strings.end())) {
+			this->entry = &*it;
+			return;
+		}
+	}
+	std::unique_lock<std::shared_mutex> lock(table.mutex);
+	this->entry = &*table.strings.emplace(str).first;
+}
+
+/**
+ * Creates an atom from an entry of the global table.
+ *
+ * @param entry The interned string, or nullptr for the null atom.
+ */
+Atom::Atom(const std::string *entry) : entry{ entry } {
+}
+
+/**
+ * Retrieves the string of the atom. The reference stays valid for the whole life of the program.
+ *
+ * @return The interned string, or an empty string for the null atom.
+ */
+const std::string ENG_API &Atom::str() const {
+	return this->entry != nullptr ? *this->entry : empty_string;
+}
+
+/**
+ * Checks whether this is the null atom.
+ *
+ * @return True for the null atom, false otherwise.
+ */
+bool ENG_API Atom::is_null() const {
+	return this->entry == nullptr;
+}
+
+/**
+ * Computes a hash of the atom from its identity, without reading the string.
+ *
+ * @return The hash of the atom.
+ */
+size_t ENG_API Atom::hash() const {
+	return std::hash<const std::string *>{}(this->entry);
+}
+
+/**
+ * Looks up an already interned string, without adding it to the table.
+ *
+ * @param str The string to look up.
+ * @return The atom of the string, or the null atom if the string was never interned.
+ */
+Atom ENG_API Atom::find(const std::string_view str) {
+	if (str.empty()) return Atom();
+	AtomTable &table = AtomTable::get();
+	std::shared_lock<std::shared_mutex> lock(table.mutex);
+	const auto it = table.strings.find(str);
+	return Atom(it != table.strings.end() ? &*it : nullptr);
+}
+
+/**
+ * Retrieves the number of distinct strings interned so far.
+ *
+ * @return The size of the global string table.
+ */
+size_t ENG_API Atom::get_table_size() {
+	AtomTable &table = AtomTable::get();
+	std::shared_lock<std::shared_mutex> lock(table.mutex);
+	return table.strings.size();
+}
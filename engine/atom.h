@@ -0,0 +1,51 @@
+/**
+ * @file	atom.h
+ * @brief	Interned string class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Interned string. Every distinct string is stored once in a global, never shrinking table,
+ * so that atoms are pointer-sized and compare by identity. The null atom stands for the empty string.
+ */
+class ENG_API Atom final {
+public:
+	Atom();
+	explicit Atom(const std::string_view str);
+	const std::string &str() const;
+	bool is_null() const;
+	size_t hash() const;
+	bool operator==(const Atom other) const { return this->entry == other.entry; }
+	bool operator!=(const Atom other) const { return this->entry != other.entry; }
+	static Atom find(const std::string_view str);
+	static size_t get_table_size();
+private:
+	explicit Atom(const std::string *entry);
+	const std::string *entry;
+};
+
+}
+
+/**
+ * @brief Hash of an atom, for use as key in unordered containers.
+ */
+template <>
+struct std::hash<lrvg::Atom> {
+	size_t operator()(const lrvg::Atom atom) const {
+		return atom.hash();
+	}
+};
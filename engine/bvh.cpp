@@ -0,0 +1,394 @@
+/**
+ * @file	bvh.cpp
+ * @brief	Mesh bounding volume hierarchy class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+
+#if defined(HAS_SSE2)
+#include <emmintrin.h>
+#elif defined(HAS_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace lrvg;
+
+/**
+ * Maximum number of triangles stored in a leaf, i.e. the width of a triangle packet.
+ */
+static constexpr uint32_t LEAF_SIZE = 4;
+
+/**
+ * Number of bins used to evaluate the surface area heuristic.
+ */
+static constexpr int SAH_BINS = 12;
+
+/**
+ * Depth past which nodes are split at the median instead of with the surface area heuristic.
+ * Median splits add at most 32 more levels, which bounds the traversal stack.
+ */
+static constexpr int MAX_SAH_DEPTH = 96;
+
+/**
+ * Size of the traversal stack.
+ */
+static constexpr int STACK_SIZE = MAX_SAH_DEPTH + 40;
+
+/**
+ * Computes half the surface area of an axis-aligned box.
+ *
+ * @param bounds_min The minimum corner of the box.
+ * @param bounds_max The maximum corner of the box.
+ * @return Half the surface area of the box.
+ */
+static float half_area(const glm::vec3 &bounds_min, const glm::vec3 &bounds_max) {
+	const glm::vec3 extent = glm::max(bounds_max - bounds_min, glm::vec3(0.0f));
+	return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+/**
+ * Builds the hierarchy over the triangles of a mesh.
+ * The hierarchy is split with a binned surface area heuristic.
+ *
+ * @param vertices The vertex positions of the mesh.
+ * @param faces The triangular faces of the mesh.
+ */
+ENG_API MeshBVH::MeshBVH(const std::vector<glm::vec3> &vertices, const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces) {
+	this->triangle_count = faces.size();
+	if (faces.empty()) return;
+	std::vector<BuildItem> items(faces.size());
+	for (size_t i = 0; i < faces.size(); i++) {
+		const glm::vec3 &v0 = vertices[std::get<0>(faces[i])];
+		const glm::vec3 &v1 = vertices[std::get<1>(faces[i])];
+		const glm::vec3 &v2 = vertices[std::get<2>(faces[i])];
+		items[i].bounds_min = glm::min(v0, glm::min(v1, v2));
+		items[i].bounds_max = glm::max(v0, glm::max(v1, v2));
+		items[i].centroid = (v0 + v1 + v2) / 3.0f;
+		items[i].face = (uint32_t)i;
+	}
+	this->nodes.reserve(2 * (faces.size() / LEAF_SIZE + 1));
+	this->packets.reserve(faces.size() / LEAF_SIZE + 1);
+	this->nodes.emplace_back();
+	this->build(items, 0, 0, (uint32_t)items.size(), 0, vertices, faces);
+}
+
+/**
+ * Retrieves the number of nodes of the hierarchy.
+ *
+ * @return The number of nodes.
+ */
+size_t ENG_API MeshBVH::get_node_count() const {
+	return this->nodes.size();
+}
+
+/**
+ * Retrieves the number of triangles referenced by the hierarchy.
+ *
+ * @return The number of triangles.
+ */
+size_t ENG_API MeshBVH::get_triangle_count() const {
+	return this->triangle_count;
+}
+
+/**
+ * Finds the nearest intersection between a ray and the mesh. Both faces of each triangle are considered.
+ * Children are visited near to far, and subtrees farther than the nearest hit found so far are skipped.
+ *
+ * @param ray The ray, in the local space of the mesh.
+ * @param t_max The maximum ray parameter to consider.
+ * @param hit The nearest intersection, written only if one is found.
+ * @return true if the ray hits the mesh before t_max, false otherwise.
+ */
+bool ENG_API MeshBVH::intersect(const Ray &ray, const float t_max, RayHit &hit) const {
+	if (UNLIKELY(this->nodes.empty())) return false;
+	const glm::vec3 inv_direction = 1.0f / ray.direction;
+	float t_best = t_max;
+	float t_entry;
+	bool found = false;
+	if (!MeshBVH::intersect_bounds(ray, inv_direction, this->nodes[0].bounds_min, this->nodes[0].bounds_max, t_best, t_entry)) return false;
+	uint32_t stack[STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+	while (stack_size > 0) {
+		const BVHNode &node = this->nodes[stack[--stack_size]];
+		if (node.count > 0) {
+			found |= this->intersect_packet(this->packets[node.first], ray, t_best, hit);
+			continue;
+		}
+		const BVHNode &left = this->nodes[node.first];
+		const BVHNode &right = this->nodes[node.first + 1];
+		float t_left, t_right;
+		const bool hit_left = MeshBVH::intersect_bounds(ray, inv_direction, left.bounds_min, left.bounds_max, t_best, t_left);
+		const bool hit_right = MeshBVH::intersect_bounds(ray, inv_direction, right.bounds_min, right.bounds_max, t_best, t_right);
+		if (hit_left && hit_right) {
+			const bool left_first = t_left <= t_right;
+			stack[stack_size++] = left_first ? node.first + 1 : node.first;
+			stack[stack_size++] = left_first ? node.first : node.first + 1;
+		} else if (hit_left) {
+			stack[stack_size++] = node.first;
+		} else if (hit_right) {
+			stack[stack_size++] = node.first + 1;
+		}
+	}
+	return found;
+}
+
+/**
+ * Intersects a ray with an axis-aligned box using the slab method.
+ *
+ * @param ray The ray.
+ * @param inv_direction The component-wise inverse of the ray direction.
+ * @param bounds_min The minimum corner of the box.
+ * @param bounds_max The maximum corner of the box.
+ * @param t_max The maximum ray parameter to consider.
+ * @param t_entry The ray parameter at which the ray enters the box (0 if the origin is inside).
+ * @return true if the ray overlaps the box within [0, t_max], false otherwise.
+ */
+bool ENG_API MeshBVH::intersect_bounds(const Ray &ray, const glm::vec3 inv_direction, const glm::vec3 bounds_min, const glm::vec3 bounds_max, const float t_max, float &t_entry) {
+	const glm::vec3 t0 = (bounds_min - ray.origin) * inv_direction;
+	const glm::vec3 t1 = (bounds_max - ray.origin) * inv_direction;
+	const glm::vec3 t_near = glm::min(t0, t1);
+	const glm::vec3 t_far = glm::max(t0, t1);
+	t_entry = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f));
+	const float t_exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, t_max));
+	return t_entry <= t_exit;
+}
+
+/**
+ * Recursively builds the subtree of a node over the items [begin, end).
+ * The two children of an inner node are always stored next to each other.
+ *
+ * @param items The build items, reordered in place.
+ * @param node_index The index of the node to build.
+ * @param begin The first item of the node.
+ * @param end One past the last item of the node.
+ * @param depth The depth of the node.
+ * @param vertices The vertex positions of the mesh.
+ * @param faces The triangular faces of the mesh.
+ */
+void MeshBVH::build(std::vector<BuildItem> &items, const uint32_t node_index, const uint32_t begin, const uint32_t end, const int depth, const std::vector<glm::vec3> &vertices, const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces) {
+	glm::vec3 bounds_min(std::numeric_limits<float>::max());
+	glm::vec3 bounds_max(-std::numeric_limits<float>::max());
+	glm::vec3 centroid_min = bounds_min;
+	glm::vec3 centroid_max = bounds_max;
+	for (uint32_t i = begin; i < end; i++) {
+		bounds_min = glm::min(bounds_min, items[i].bounds_min);
+		bounds_max = glm::max(bounds_max, items[i].bounds_max);
+		centroid_min = glm::min(centroid_min, items[i].centroid);
+		centroid_max = glm::max(centroid_max, items[i].centroid);
+	}
+	this->nodes[node_index].bounds_min = bounds_min;
+	this->nodes[node_index].bounds_max = bounds_max;
+	const uint32_t count = end - begin;
+	if (count <= LEAF_SIZE) {
+		TrianglePacket packet;
+		std::memset(&packet, 0, sizeof(TrianglePacket));
+		for (uint32_t lane = 0; lane < LEAF_SIZE; lane++) {
+			if (lane >= count) {
+				packet.face[lane] = UINT32_MAX;
+				continue;
+			}
+			const auto &face = faces[items[begin + lane].face];
+			const glm::vec3 &v0 = vertices[std::get<0>(face)];
+			const glm::vec3 e1 = vertices[std::get<1>(face)] - v0;
+			const glm::vec3 e2 = vertices[std::get<2>(face)] - v0;
+			for (int axis = 0; axis < 3; axis++) {
+				packet.v0[axis][lane] = v0[axis];
+				packet.e1[axis][lane] = e1[axis];
+				packet.e2[axis][lane] = e2[axis];
+			}
+			packet.face[lane] = items[begin + lane].face;
+		}
+		this->nodes[node_index].first = (uint32_t)this->packets.size();
+		this->nodes[node_index].count = count;
+		this->packets.push_back(packet);
+		return;
+	}
+	const glm::vec3 extent = centroid_max - centroid_min;
+	const int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+	uint32_t mid = begin + count / 2;
+	if (extent[axis] > 0.0f && depth < MAX_SAH_DEPTH) {
+		struct Bin {
+			glm::vec3 bounds_min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 bounds_max = glm::vec3(-std::numeric_limits<float>::max());
+			uint32_t count = 0;
+		};
+		Bin bins[SAH_BINS];
+		const float scale = (float)SAH_BINS / extent[axis];
+		const auto bin_of = [&](const BuildItem &item) {
+			return std::min((int)((item.centroid[axis] - centroid_min[axis]) * scale), SAH_BINS - 1);
+		};
+		for (uint32_t i = begin; i < end; i++) {
+			Bin &bin = bins[bin_of(items[i])];
+			bin.bounds_min = glm::min(bin.bounds_min, items[i].bounds_min);
+			bin.bounds_max = glm::max(bin.bounds_max, items[i].bounds_max);
+			bin.count++;
+		}
+		// Sweep from the right to accumulate the cost of every right-hand partition
+		float right_cost[SAH_BINS];
+		Bin acc;
+		for (int b = SAH_BINS - 1; b > 0; b--) {
+			acc.bounds_min = glm::min(acc.bounds_min, bins[b].bounds_min);
+			acc.bounds_max = glm::max(acc.bounds_max, bins[b].bounds_max);
+			acc.count += bins[b].count;
+			right_cost[b] = acc.count ? half_area(acc.bounds_min, acc.bounds_max) * (float)acc.count : 0.0f;
+		}
+		acc = Bin();
+		float best_cost = std::numeric_limits<float>::max();
+		int best_split = -1;
+		for (int b = 0; b < SAH_BINS - 1; b++) {
+			acc.bounds_min = glm::min(acc.bounds_min, bins[b].bounds_min);
+			acc.bounds_max = glm::max(acc.bounds_max, bins[b].bounds_max);
+			acc.count += bins[b].count;
+			if (acc.count == 0 || acc.count == count) continue;
+			const float cost = half_area(acc.bounds_min, acc.bounds_max) * (float)acc.count + right_cost[b + 1];
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_split = b;
+			}
+		}
+		if (best_split >= 0) {
+			const auto split = std::partition(items.begin() + begin, items.begin() + end, [&](const BuildItem &item) {
+				return bin_of(item) <= best_split;
+			});
+			mid = (uint32_t)(split - items.begin());
+		}
+	}
+	if (mid == begin || mid == end || depth >= MAX_SAH_DEPTH) {
+		mid = begin + count / 2;
+		if (extent[axis] > 0.0f) {
+			std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end, [axis](const BuildItem &a, const BuildItem &b) {
+				return a.centroid[axis] < b.centroid[axis];
+			});
+		}
+	}
+	const uint32_t left = (uint32_t)this->nodes.size();
+	this->nodes.emplace_back();
+	this->nodes.emplace_back();
+	this->nodes[node_index].first = left;
+	this->nodes[node_index].count = 0;
+	this->build(items, left, begin, mid, depth + 1, vertices, faces);
+	this->build(items, left + 1, mid, end, depth + 1, vertices, faces);
+}
+
+/**
+ * Intersects a ray with a packet of four triangles (Moller-Trumbore).
+ * Lanes are evaluated together with SSE2 or NEON when available.
+ *
+ * @param packet The triangle packet.
+ * @param ray The ray.
+ * @param t_best The ray parameter of the nearest hit so far, updated on a nearer hit.
+ * @param hit The nearest intersection, updated on a nearer hit.
+ * @return true if a nearer hit was found in the packet, false otherwise.
+ */
+bool MeshBVH::intersect_packet(const TrianglePacket &packet, const Ray &ray, float &t_best, RayHit &hit) const {
+	alignas(16) float t_lanes[LEAF_SIZE];
+	alignas(16) float u_lanes[LEAF_SIZE];
+	alignas(16) float v_lanes[LEAF_SIZE];
+	alignas(16) uint32_t valid[LEAF_SIZE];
+#if defined(HAS_SSE2)
+	const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+	const __m128 e1x = _mm_load_ps(packet.e1[0]), e1y = _mm_load_ps(packet.e1[1]), e1z = _mm_load_ps(packet.e1[2]);
+	const __m128 e2x = _mm_load_ps(packet.e2[0]), e2y = _mm_load_ps(packet.e2[1]), e2z = _mm_load_ps(packet.e2[2]);
+	const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+	const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+	const __m128 tx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(packet.v0[0]));
+	const __m128 ty = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(packet.v0[1]));
+	const __m128 tz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(packet.v0[2]));
+	const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inv_det);
+	const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+	const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+	const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+	const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv_det);
+	const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv_det);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 abs_det = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+	__m128 mask = _mm_cmpgt_ps(abs_det, _mm_set1_ps(1e-20f));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+	mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(t_best)));
+	if (_mm_movemask_ps(mask) == 0) return false;
+	_mm_store_ps(t_lanes, t);
+	_mm_store_ps(u_lanes, u);
+	_mm_store_ps(v_lanes, v);
+	_mm_store_si128((__m128i *)valid, _mm_castps_si128(mask));
+#elif defined(HAS_NEON)
+	const float32x4_t dx = vdupq_n_f32(ray.direction.x), dy = vdupq_n_f32(ray.direction.y), dz = vdupq_n_f32(ray.direction.z);
+	const float32x4_t e1x = vld1q_f32(packet.e1[0]), e1y = vld1q_f32(packet.e1[1]), e1z = vld1q_f32(packet.e1[2]);
+	const float32x4_t e2x = vld1q_f32(packet.e2[0]), e2y = vld1q_f32(packet.e2[1]), e2z = vld1q_f32(packet.e2[2]);
+	const float32x4_t px = vmlsq_f32(vmulq_f32(dy, e2z), dz, e2y);
+	const float32x4_t py = vmlsq_f32(vmulq_f32(dz, e2x), dx, e2z);
+	const float32x4_t pz = vmlsq_f32(vmulq_f32(dx, e2y), dy, e2x);
+	const float32x4_t det = vmlaq_f32(vmlaq_f32(vmulq_f32(e1x, px), e1y, py), e1z, pz);
+	float32x4_t inv_det = vrecpeq_f32(det);
+	inv_det = vmulq_f32(vrecpsq_f32(det, inv_det), inv_det);
+	inv_det = vmulq_f32(vrecpsq_f32(det, inv_det), inv_det);
+	const float32x4_t tx = vsubq_f32(vdupq_n_f32(ray.origin.x), vld1q_f32(packet.v0[0]));
+	const float32x4_t ty = vsubq_f32(vdupq_n_f32(ray.origin.y), vld1q_f32(packet.v0[1]));
+	const float32x4_t tz = vsubq_f32(vdupq_n_f32(ray.origin.z), vld1q_f32(packet.v0[2]));
+	const float32x4_t u = vmulq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(tx, px), ty, py), tz, pz), inv_det);
+	const float32x4_t qx = vmlsq_f32(vmulq_f32(ty, e1z), tz, e1y);
+	const float32x4_t qy = vmlsq_f32(vmulq_f32(tz, e1x), tx, e1z);
+	const float32x4_t qz = vmlsq_f32(vmulq_f32(tx, e1y), ty, e1x);
+	const float32x4_t v = vmulq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(dx, qx), dy, qy), dz, qz), inv_det);
+	const float32x4_t t = vmulq_f32(vmlaq_f32(vmlaq_f32(vmulq_f32(e2x, qx), e2y, qy), e2z, qz), inv_det);
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	uint32x4_t mask = vcgtq_f32(vabsq_f32(det), vdupq_n_f32(1e-20f));
+	mask = vandq_u32(mask, vcgeq_f32(u, zero));
+	mask = vandq_u32(mask, vcgeq_f32(v, zero));
+	mask = vandq_u32(mask, vcleq_f32(vaddq_f32(u, v), vdupq_n_f32(1.0f)));
+	mask = vandq_u32(mask, vcgeq_f32(t, zero));
+	mask = vandq_u32(mask, vcltq_f32(t, vdupq_n_f32(t_best)));
+	vst1q_f32(t_lanes, t);
+	vst1q_f32(u_lanes, u);
+	vst1q_f32(v_lanes, v);
+	vst1q_u32(valid, mask);
+#else
+	for (uint32_t lane = 0; lane < LEAF_SIZE; lane++) {
+		const glm::vec3 e1(packet.e1[0][lane], packet.e1[1][lane], packet.e1[2][lane]);
+		const glm::vec3 e2(packet.e2[0][lane], packet.e2[1][lane], packet.e2[2][lane]);
+		const glm::vec3 p = glm::cross(ray.direction, e2);
+		const float det = glm::dot(e1, p);
+		valid[lane] = 0;
+		if (std::fabs(det) <= 1e-20f) continue;
+		const float inv_det = 1.0f / det;
+		const glm::vec3 tv = ray.origin - glm::vec3(packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane]);
+		const glm::vec3 q = glm::cross(tv, e1);
+		u_lanes[lane] = glm::dot(tv, p) * inv_det;
+		v_lanes[lane] = glm::dot(ray.direction, q) * inv_det;
+		t_lanes[lane] = glm::dot(e2, q) * inv_det;
+		valid[lane] = u_lanes[lane] >= 0.0f && v_lanes[lane] >= 0.0f && u_lanes[lane] + v_lanes[lane] <= 1.0f &&
+			t_lanes[lane] >= 0.0f && t_lanes[lane] < t_best;
+	}
+#endif
+	bool found = false;
+	for (uint32_t lane = 0; lane < LEAF_SIZE; lane++) {
+		if (!valid[lane] || packet.face[lane] == UINT32_MAX || t_lanes[lane] >= t_best) continue;
+		t_best = t_lanes[lane];
+		hit.t = t_lanes[lane];
+		hit.face = packet.face[lane];
+		hit.barycentric = glm::vec2(u_lanes[lane], v_lanes[lane]);
+		found = true;
+	}
+	return found;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file	bvh.h
+ * @brief	Mesh bounding volume hierarchy class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Ray, defined by an origin and a (non-normalized) direction. Points on the ray are origin + t * direction.
+ */
+struct ENG_API Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;
+};
+
+/**
+ * @brief Nearest intersection between a ray and a triangle mesh.
+ */
+struct ENG_API RayHit {
+	float t;
+	uint32_t face;
+	glm::vec2 barycentric;
+};
+
+/**
+ * @brief Bounding volume hierarchy over the triangles of a mesh, used for ray queries.
+ * Leaves hold packets of four triangles, intersected at once with SIMD when available.
+ */
+class ENG_API MeshBVH final {
+public:
+	MeshBVH(const std::vector<glm::vec3> &vertices, const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces);
+	size_t get_node_count() const;
+	size_t get_triangle_count() const;
+	bool intersect(const Ray &ray, const float t_max, RayHit &hit) const;
+	static bool intersect_bounds(const Ray &ray, const glm::vec3 inv_direction, const glm::vec3 bounds_min, const glm::vec3 bounds_max, const float t_max, float &t_entry);
+private:
+	struct BVHNode {
+		glm::vec3 bounds_min;
+		uint32_t first;
+		glm::vec3 bounds_max;
+		uint32_t count;
+	};
+	struct alignas(16) TrianglePacket {
+		float v0[3][4];
+		float e1[3][4];
+		float e2[3][4];
+		uint32_t face[4];
+	};
+	struct BuildItem {
+		glm::vec3 bounds_min;
+		glm::vec3 bounds_max;
+		glm::vec3 centroid;
+		uint32_t face;
+	};
+	void build(std::vector<BuildItem> &items, const uint32_t node_index, const uint32_t begin, const uint32_t end, const int depth, const std::vector<glm::vec3> &vertices, const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces);
+	bool intersect_packet(const TrianglePacket &packet, const Ray &ray, float &t_best, RayHit &hit) const;
+	std::vector<BVHNode> nodes;
+	std::vector<TrianglePacket> packets;
+	size_t triangle_count;
+};
+
+}
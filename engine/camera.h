@@ -28,6 +28,7 @@ public:
 	void set_fov(const float fov);
 	void set_clipping(const float near_clipping, const float far_clipping);
 	void set_active(const bool is_active);
+	virtual glm::mat4 get_projection_matrix() const = 0;
     virtual void render(const glm::mat4 world_matrix) const override = 0;
 protected:
 	float fov;
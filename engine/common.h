@@ -82,6 +82,12 @@ typedef unsigned char bool;
 #define UNREF
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAS_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define HAS_NEON
+#endif
+
 #ifdef __cplusplus
 }
 #endif
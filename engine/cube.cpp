@@ -9,61 +9,91 @@
 
 #include "cube.h"
 
+#include <algorithm>
+#include <span>
+#include <tuple>
+
 #include <glad/gl.h>
 #include <glm/glm.hpp>
 
+#include "geometry_cache.h"
 #include "mesh.h"
+#include "mesh_builder.h"
+#include "mesh_optimizer.h"
 
 using namespace lrvg;
 
 /**
  * Creates a new instance of Cube with predefined mesh data.
  * The cube is centered at the origin with a size of 2 units (from -1 to 1) in each dimension.
+ * Cubes with the same segment count share their geometry.
  * 
- * @param segments Number of subdivisions per face side (default: 1)
+ * @param segments Number of subdivisions per face side (default: 40)
  */
 Cube::Cube(int segments) {
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> uvs;
-    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
-    auto generate_face = [&](glm::vec3 normal, glm::vec3 tangent, glm::vec3 bitangent, glm::vec3 origin) {
-        uint32_t base_idx = vertices.size();
-        for (int y = 0; y <= segments; y++) {
+    segments = std::max(segments, 1);
+    this->set_geometry(GeometryCache::get_shared().get(PrimitiveType::Cube, segments, 0, [=]() {
+        return Cube::generate(segments);
+    }));
+    this->set_cast_shadows(true);
+}
+
+/**
+ * Generates the optimized geometry of a cube. Rows are generated in parallel for large cubes.
+ * 
+ * @param segments Number of subdivisions per face side
+ * @return The full-resolution level of detail of the cube.
+ */
+MeshLOD Cube::generate(int segments) {
+    // Normal, tangent, bitangent and origin of each side: +Z, -Z, +X, -X, +Y, -Y
+    static const glm::vec3 sides[6][4] = {
+        { glm::vec3(0, 0, 1), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) },
+        { glm::vec3(0, 0, -1), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, -1) },
+        { glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), glm::vec3(1, 0, 0) },
+        { glm::vec3(-1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(-1, 0, 0) },
+        { glm::vec3(0, 1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0) },
+        { glm::vec3(0, -1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, -1, 0) }
+    };
+    const size_t row_size = (size_t)segments + 1;
+    const size_t side_vertices = row_size * row_size;
+    const size_t side_faces = 2 * (size_t)segments * segments;
+    MeshBuilder builder;
+    builder.resize(6 * side_vertices, 6 * side_faces);
+    const std::span<glm::vec3> vertices = builder.get_vertices();
+    const std::span<glm::vec3> normals = builder.get_normals();
+    const std::span<glm::vec2> uvs = builder.get_uvs();
+    const std::span<std::tuple<uint32_t, uint32_t, uint32_t>> faces = builder.get_faces();
+    // Rows of all six sides, one after the other
+    GeometryCache::parallel_rows(6 * row_size, row_size, [&](const size_t begin, const size_t end) {
+        for (size_t row = begin; row < end; row++) {
+            const glm::vec3 *side = sides[row / row_size];
+            const size_t y = row % row_size;
             for (int x = 0; x <= segments; x++) {
                 float u = (float)x / segments;
                 float v = (float)y / segments;
-                glm::vec3 pos = origin + tangent * (u * 2.0f - 1.0f) + bitangent * (v * 2.0f - 1.0f);
-                vertices.push_back(pos);
-                normals.push_back(normal);
-                uvs.push_back(glm::vec2(u, v));
+                const size_t i = row * row_size + x;
+                vertices[i] = side[3] + side[1] * (u * 2.0f - 1.0f) + side[2] * (v * 2.0f - 1.0f);
+                normals[i] = side[0];
+                uvs[i] = glm::vec2(u, v);
             }
         }
-        for (int y = 0; y < segments; y++) {
+    });
+    GeometryCache::parallel_rows(6 * (size_t)segments, row_size, [&](const size_t begin, const size_t end) {
+        for (size_t row = begin; row < end; row++) {
+            const size_t side = row / segments;
+            const size_t y = row % segments;
             for (int x = 0; x < segments; x++) {
-                uint32_t i0 = base_idx + y * (segments + 1) + x;
+                uint32_t i0 = (uint32_t)(side * side_vertices + y * row_size + x);
                 uint32_t i1 = i0 + 1;
-                uint32_t i2 = i0 + (segments + 1);
+                uint32_t i2 = i0 + (uint32_t)row_size;
                 uint32_t i3 = i2 + 1;
-                
-                faces.push_back(std::make_tuple(i0, i1, i2));
-                faces.push_back(std::make_tuple(i2, i1, i3));
+                const size_t f = side * side_faces + 2 * (y * segments + x);
+                faces[f] = std::make_tuple(i0, i1, i2);
+                faces[f + 1] = std::make_tuple(i2, i1, i3);
             }
         }
-    };
-    // Front (+Z)
-    generate_face(glm::vec3(0, 0, 1), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1));
-    // Back (-Z)
-    generate_face(glm::vec3(0, 0, -1), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, -1));
-    // Right (+X)
-    generate_face(glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), glm::vec3(1, 0, 0));
-    // Left (-X)
-    generate_face(glm::vec3(-1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(-1, 0, 0));
-    // Top (+Y)
-    generate_face(glm::vec3(0, 1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
-    // Bottom (-Y)
-    generate_face(glm::vec3(0, -1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, -1, 0));
-    
-    this->set_mesh_data(vertices, faces, normals, uvs);
-    this->set_cast_shadows(true);
+    });
+    MeshLOD lod = builder.build();
+    MeshOptimizer::optimize(lod);
+    return lod;
 }
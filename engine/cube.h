@@ -20,6 +20,7 @@ namespace lrvg {
 class ENG_API Cube : public Mesh {
 public:
     Cube(int segments = 40);
+    static MeshLOD generate(int segments);
 };
 
 }
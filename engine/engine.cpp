@@ -1,5 +1,7 @@
 #include "engine.h"
 #include "common.h"
+#include "lazy_mesh_loader.h"
+#include "light.h"
 #include "material.h"
 #include "mesh.h"
 
@@ -25,6 +27,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReser
 
 #include <algorithm>
 #include <cstdio>
+#include <functional>
 #include <memory>
 #include <string>
 #include <sstream>
@@ -43,12 +46,18 @@ using namespace lrvg;
 bool Engine::is_initialized_f = false;
 bool Engine::is_running_f = false;
 int Engine::window_id = 0;
+std::shared_ptr<SceneIndex> Engine::scene_index = std::make_shared<SceneIndex>();
 std::shared_ptr<Node> Engine::scene;
 std::shared_ptr<Camera> Engine::active_camera;
 std::string Engine::screen_text;
 int Engine::window_width = 0;
 int Engine::window_height = 0;
 std::shared_ptr<Material> Engine::shadow_material = std::make_shared<Material>();
+std::shared_ptr<OcclusionCuller> Engine::occlusion_culler = std::make_shared<OcclusionCuller>();
+std::shared_ptr<RenderQueue> Engine::render_queue = std::make_shared<RenderQueue>();
+std::shared_ptr<LODSelector> Engine::lod_selector = std::make_shared<LODSelector>();
+std::shared_ptr<MeshletCuller> Engine::meshlet_culler = std::make_shared<MeshletCuller>();
+bool Engine::occlusion_culling_f = false;
 
 int Engine::frames = 0;
 float Engine::fps = 0.0f;
@@ -117,6 +126,10 @@ bool ENG_API Engine::init(const std::string window_title, const int width, const
    const glm::vec4 ambient(0.2f, 0.2f, 0.2f, 1.0f);
    glLightModelf(GL_LIGHT_MODEL_LOCAL_VIEWER, 1.0f);
    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, glm::value_ptr(ambient));
+   // Query the light count while the context is current, for lights created on other threads
+   int max_lights = 0;
+   glGetIntegerv(GL_MAX_LIGHTS, &max_lights);
+   Light::set_max_lights(max_lights);
    FreeImage_Initialise();
    Engine::shadow_material->set_ambient_color(glm::vec3(0.0f, 0.0f, 0.0f));
    Engine::shadow_material->set_diffuse_color(glm::vec3(0.0f, 0.0f, 0.0f));
@@ -196,11 +209,18 @@ void ENG_API Engine::set_active_camera(const std::shared_ptr<Camera> camera) {
 
 /**
  * Sets the scene.
+ * The nodes of the new scene are registered in the scene index used by the lookup functions.
  *
  * @param scene the root node of the scene to set
  */
 void ENG_API Engine::set_scene(const std::shared_ptr<Node> scene) {
+    if (Engine::scene != nullptr) {
+        Engine::scene_index->remove(*Engine::scene);
+    }
     Engine::scene = scene;
+    if (Engine::scene != nullptr) {
+        Engine::scene_index->insert(*Engine::scene);
+    }
 	Engine::active_camera = nullptr;
 }
 
@@ -224,6 +244,17 @@ void ENG_API Engine::set_screen_text(const std::string text) {
     Engine::screen_text = text;
 }
 
+/**
+ * Enables or disables CPU occlusion culling.
+ * When enabled, meshes flagged as occluders (or, if none is flagged, the largest meshes on screen)
+ * are rasterized into a low-resolution depth buffer, and meshes hidden behind them are not submitted.
+ *
+ * @param enabled true to enable occlusion culling, false to disable it
+ */
+void ENG_API Engine::set_occlusion_culling(const bool enabled) {
+    Engine::occlusion_culling_f = enabled;
+}
+
 /**
  * Sets the keyboard callback function.
  *
@@ -271,6 +302,33 @@ std::shared_ptr<Node> ENG_API Engine::get_scene() {
     return Engine::scene;
 }
 
+/**
+ * Gets the level of detail selector, to tune its parameters or read its per-frame statistics.
+ *
+ * @return the level of detail selector used by the engine
+ */
+std::shared_ptr<LODSelector> ENG_API Engine::get_lod_selector() {
+    return Engine::lod_selector;
+}
+
+/**
+ * Gets the meshlet culler, to tune its parameters or read its per-frame statistics.
+ *
+ * @return the meshlet culler used by the engine
+ */
+std::shared_ptr<MeshletCuller> ENG_API Engine::get_meshlet_culler() {
+    return Engine::meshlet_culler;
+}
+
+/**
+ * Gets the occlusion culler, to tune its parameters or read its per-frame statistics.
+ *
+ * @return the occlusion culler used by the engine
+ */
+std::shared_ptr<OcclusionCuller> ENG_API Engine::get_occlusion_culler() {
+    return Engine::occlusion_culler;
+}
+
 /**
  * Gets the window size.
  *
@@ -316,45 +374,76 @@ void ENG_API Engine::render() {
         return;
 	}
 	Engine::active_camera->set_window_size(Engine::window_width, Engine::window_height);
-    int max_lights;
-	glGetIntegerv(GL_MAX_LIGHTS, &max_lights);
+    const int max_lights = Light::get_max_lights();
 	for (int i = 0; i < max_lights; i++) {
 	    glDisable(GL_LIGHT0 + i);
 	}
-    auto render_list = Engine::build_render_list(Engine::scene, glm::mat4(1.0f));
-    std::sort(
-        render_list.begin(),
-        render_list.end(),
-        [](
-            const std::pair<std::shared_ptr<Object>, glm::mat4> a,
-            const std::pair<std::shared_ptr<Object>, glm::mat4> b
-        ) {
-            return a.first->get_priority() > b.first->get_priority();
-        }
-    );
-    
+    // Meshes whose geometry was loaded lazily since the last frame are drawn from this frame on
+    LazyMeshLoader &lazy_mesh_loader = LazyMeshLoader::get_shared();
+    lazy_mesh_loader.update();
+    const auto render_list = Engine::build_render_list();
     const glm::mat4 inv_camera_matrix = glm::inverse(Engine::active_camera->get_local_matrix());
+    const glm::mat4 projection_matrix = Engine::active_camera->get_projection_matrix();
     
-    // Render scene normally
-    for (const auto& node : render_list) {
-        node.first->render(inv_camera_matrix * node.second);
+    std::vector<bool> visible(render_list.size(), true);
+    if (Engine::occlusion_culling_f) {
+        visible = Engine::cull_occluded(render_list, inv_camera_matrix);
+    }
+    // Queue the visible entries by sort key: priority first, then state, then front to back
+    RenderQueue &queue = *Engine::render_queue;
+    queue.clear();
+    queue.reserve(render_list.size());
+    Engine::lod_selector->begin_frame(projection_matrix);
+    Engine::meshlet_culler->begin_frame(projection_matrix);
+    for (size_t i = 0; i < render_list.size(); i++) {
+        if (!visible[i]) continue;
+        const glm::mat4 model_view = inv_camera_matrix * render_list[i].second;
+        Mesh *mesh = dynamic_cast<Mesh *>(render_list[i].first);
+        if (mesh != nullptr) {
+            lazy_mesh_loader.request(*mesh, projection_matrix * model_view);
+            Engine::lod_selector->select(*mesh, model_view);
+            Engine::meshlet_culler->cull(*mesh, model_view);
+        }
+        queue.push(RenderQueue::make_key(*render_list[i].first, model_view), (uint32_t)i);
+    }
+    queue.sort();
+    // Render opaque scene, front to back
+    size_t q = 0;
+    for (; q < queue.size() && queue.get_pass(q) == RenderQueue::PASS_OPAQUE; q++) {
+        const auto &entry = render_list[queue.get_index(q)];
+        entry.first->render(inv_camera_matrix * entry.second);
     }
     // Shadow rendering
     glDepthFunc(GL_LEQUAL);
     const glm::mat4 shadow_model_scale_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 0.05f, 1.0f));
     for (const auto& node : render_list) {
-        std::shared_ptr<Mesh> mesh = std::dynamic_pointer_cast<Mesh>(node.first);
+        Mesh *mesh = dynamic_cast<Mesh *>(node.first);
         if (mesh != nullptr && mesh->get_cast_shadows()) {
             glm::mat4 shadow_world_matrix = node.second;
             shadow_world_matrix[3][1] = 0.01f;
             const std::shared_ptr<Material> original_material = mesh->get_material();
+            // Meshlets culled for the camera may still cast a visible shadow
+            const bool cluster_culling = mesh->get_cluster_culling();
             mesh->set_material(Engine::shadow_material);
+            mesh->set_cluster_culling(false);
             const glm::mat4 shadow_matrix = shadow_model_scale_matrix * shadow_world_matrix;
             mesh->render(inv_camera_matrix * shadow_matrix);
+            mesh->set_cluster_culling(cluster_culling);
             mesh->set_material(original_material);
         }
     }
     glDepthFunc(GL_LESS);
+    // Render blended scene, back to front, testing against the opaque depth without writing to it
+    if (q < queue.size()) {
+        glEnable(GL_BLEND);
+        glDepthMask(GL_FALSE);
+        for (; q < queue.size(); q++) {
+            const auto &entry = render_list[queue.get_index(q)];
+            entry.first->render(inv_camera_matrix * entry.second);
+        }
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+    }
 
     std::stringstream fps;
     fps << Engine::fps << " fps";
@@ -397,18 +486,154 @@ void ENG_API Engine::swap_buffers() {
 
 /**
  * Finds an object by name in the scene.
+ * The lookup goes through the scene index and takes constant time.
  *
  * @param name the name of the object to find
  * @return a shared pointer to the found object, or nullptr if not found
  */
-std::shared_ptr<Object> ENG_API Engine::find_obj_by_name(const std::string name) {
-	const auto obj = Engine::find_obj_by_name(name, Engine::scene);
+std::shared_ptr<Object> ENG_API Engine::find_obj_by_name(const std::string_view name) {
+	const auto obj = Engine::scene_index->find_by_name(name);
+    if (obj == nullptr) {
+        WARN("object %.*s not found", (int)name.size(), name.data());
+	}
+	return obj;
+}
+
+/**
+ * Finds an object by hierarchical path in the scene (e.g. "Root/Tower1/Disk3").
+ * Paths start below the scene root. The lookup goes through the scene index and takes constant time.
+ *
+ * @param path the path of the object to find
+ * @return a shared pointer to the found object, or nullptr if not found
+ */
+std::shared_ptr<Object> ENG_API Engine::find_obj_by_path(const std::string_view path) {
+	const auto obj = Engine::scene_index->find_by_path(path);
+    if (obj == nullptr) {
+        WARN("object at path %.*s not found", (int)path.size(), path.data());
+	}
+	return obj;
+}
+
+/**
+ * Finds an object by id in the scene.
+ * The lookup goes through the scene index and takes constant time.
+ *
+ * @param id the id of the object to find
+ * @return a shared pointer to the found object, or nullptr if not found
+ */
+std::shared_ptr<Object> ENG_API Engine::find_obj_by_id(const int id) {
+	const auto obj = Engine::scene_index->find_by_id(id);
     if (obj == nullptr) {
-        WARN("object %s not found", name.c_str());
+        WARN("object with id %d not found", id);
 	}
 	return obj;
 }
 
+/**
+ * Finds an object in the scene by its node handle.
+ * Stale handles, and handles to nodes outside the scene, resolve to nullptr.
+ *
+ * @param handle the handle of the node to find
+ * @return a shared pointer to the found object, or nullptr if not found
+ */
+std::shared_ptr<Object> ENG_API Engine::find_obj_by_handle(const NodeHandle handle) {
+	Node *node = NodePool::get_shared().get(handle);
+	if (node == nullptr || node->get_scene_index() != Engine::scene_index.get()) {
+        WARN("object with handle %08x not found", handle.value);
+        return nullptr;
+	}
+	return node->shared_from_this();
+}
+
+/**
+ * Defragments the scene storage: the render list is put back into traversal order and
+ * the node pool chunks left empty by removed nodes are released.
+ * Meant to be called after large scene edits, such as unloading a level.
+ *
+ * @return the amount of memory released, in bytes
+ */
+size_t ENG_API Engine::defragment_scene() {
+    Engine::scene_index->defragment();
+    return NodePool::get_shared().trim();
+}
+
+/**
+ * Finds the nearest mesh under a screen position.
+ * A ray is cast from the active camera through the given window coordinates (as received by the
+ * keyboard callback, origin at the top-left corner). Mesh bounds are tested first, nearest first,
+ * then the triangles of the candidate meshes through their bounding volume hierarchy.
+ *
+ * @param x the horizontal window coordinate
+ * @param y the vertical window coordinate
+ * @return the picked mesh with the world-space hit point, face index and distance; the mesh is nullptr if nothing was hit
+ */
+PickResult ENG_API Engine::pick(const int x, const int y) {
+    PickResult result{ nullptr, glm::vec3(0.0f), 0, 0.0f };
+    if (UNLIKELY(Engine::scene == nullptr || Engine::active_camera == nullptr)) {
+        ERROR("scene or active camera not set");
+        return result;
+    }
+    if (UNLIKELY(Engine::window_width <= 0 || Engine::window_height <= 0)) return result;
+    // Cursor positions are in screen coordinates, which differ from framebuffer pixels on high-DPI displays
+    float scale_x = 1.0f;
+    float scale_y = 1.0f;
+    if (LIKELY(s_window)) {
+        int window_w, window_h;
+        glfwGetWindowSize(s_window, &window_w, &window_h);
+        if (window_w > 0 && window_h > 0) {
+            scale_x = (float)Engine::window_width / (float)window_w;
+            scale_y = (float)Engine::window_height / (float)window_h;
+        }
+    }
+    const float ndc_x = 2.0f * ((float)x * scale_x + 0.5f) / (float)Engine::window_width - 1.0f;
+    const float ndc_y = 1.0f - 2.0f * ((float)y * scale_y + 0.5f) / (float)Engine::window_height;
+    Engine::active_camera->set_window_size(Engine::window_width, Engine::window_height);
+    const glm::mat4 view_matrix = glm::inverse(Engine::active_camera->get_local_matrix());
+    const glm::mat4 inv_view_projection = glm::inverse(Engine::active_camera->get_projection_matrix() * view_matrix);
+    const glm::vec4 near_point = inv_view_projection * glm::vec4(ndc_x, ndc_y, -1.0f, 1.0f);
+    const glm::vec4 far_point = inv_view_projection * glm::vec4(ndc_x, ndc_y, 1.0f, 1.0f);
+    // The ray spans [0, 1] from the near to the far plane; affine transforms preserve that parametrization
+    Ray world_ray;
+    world_ray.origin = glm::vec3(near_point) / near_point.w;
+    world_ray.direction = glm::vec3(far_point) / far_point.w - world_ray.origin;
+    struct Candidate {
+        float t_entry;
+        Mesh *mesh;
+        Ray local_ray;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto &node : Engine::build_render_list()) {
+        Mesh *mesh = dynamic_cast<Mesh *>(node.first);
+        if (mesh == nullptr || mesh->get_faces().empty()) continue;
+        const glm::mat4 inv_world = glm::inverse(node.second);
+        Ray local_ray;
+        local_ray.origin = glm::vec3(inv_world * glm::vec4(world_ray.origin, 1.0f));
+        local_ray.direction = glm::vec3(inv_world * glm::vec4(world_ray.direction, 0.0f));
+        float t_entry;
+        if (!MeshBVH::intersect_bounds(local_ray, 1.0f / local_ray.direction, mesh->get_bounds_min(), mesh->get_bounds_max(), 1.0f, t_entry)) continue;
+        candidates.push_back(Candidate{ t_entry, mesh, local_ray });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        return a.t_entry < b.t_entry;
+    });
+    float t_best = 1.0f;
+    Mesh *best = nullptr;
+    for (const auto &candidate : candidates) {
+        if (candidate.t_entry > t_best) break;
+        RayHit hit;
+        if (!candidate.mesh->get_bvh()->intersect(candidate.local_ray, t_best, hit)) continue;
+        t_best = hit.t;
+        best = candidate.mesh;
+        result.face = hit.face;
+    }
+    if (best != nullptr) {
+        result.mesh = std::static_pointer_cast<Mesh>(best->shared_from_this());
+        result.point = world_ray.origin + t_best * world_ray.direction;
+        result.distance = t_best * glm::length(world_ray.direction);
+    }
+    return result;
+}
+
 /**
  * Draws text overlay on the screen.
  *
@@ -457,31 +682,77 @@ void ENG_API Engine::draw_text_overlay(int fb_width, int fb_height, const char *
     glEnable(GL_TEXTURE_2D);
 }
 
-std::vector<std::pair<std::shared_ptr<Node>, glm::mat4>> Engine::build_render_list(
-        const std::shared_ptr<Node> scene_root, 
-        const glm::mat4 parent_world_matrix
-        ) {
-    std::vector<std::pair<std::shared_ptr<Node>, glm::mat4>> render_list;
-    render_list.push_back(std::make_pair(scene_root, parent_world_matrix * scene_root->get_local_matrix()));
-    for (const auto& child : scene_root->get_children()) {
-		std::vector<std::pair<std::shared_ptr<Node>, glm::mat4>> child_render_list = 
-            Engine::build_render_list(child, parent_world_matrix * scene_root->get_local_matrix());
-		render_list.insert(render_list.end(), child_render_list.begin(), child_render_list.end());
+/**
+ * Builds the render list from the scene index, pairing every node with its world matrix.
+ * World matrices are cached by the nodes and only recomputed for subtrees that changed.
+ * Entries hold plain pointers, which stay valid for the frame since the scene owns the nodes.
+ *
+ * @return the render list
+ */
+std::vector<std::pair<Node *, glm::mat4>> Engine::build_render_list() {
+    const std::vector<Node *> &nodes = Engine::scene_index->get_nodes();
+    std::vector<std::pair<Node *, glm::mat4>> render_list;
+    render_list.reserve(nodes.size());
+    for (Node *node : nodes) {
+        render_list.emplace_back(node, node->get_world_matrix());
     }
     return render_list;
 }
 
-std::shared_ptr<Object> Engine::find_obj_by_name(const std::string name, const std::shared_ptr<Node> root) {
-    for (const auto& child : root->get_children()) {
-        if (child->get_name() == name) {
-            return child;
+/**
+ * Runs the CPU occlusion culling stage over a render list.
+ * Occluders are the meshes flagged with `Mesh::set_occluder`; if none is flagged, up to
+ * `OcclusionCuller::get_max_auto_occluders` opaque meshes are picked by their approximate size on screen.
+ *
+ * @param render_list the render list, paired with world matrices
+ * @param view_matrix the view matrix of the active camera
+ * @return one flag per render list entry, false for meshes certainly hidden
+ */
+std::vector<bool> Engine::cull_occluded(
+        const std::vector<std::pair<Node *, glm::mat4>> &render_list,
+        const glm::mat4 view_matrix
+        ) {
+    // Automatically selected occluders are capped in size, so that rasterization stays cheap
+    constexpr size_t max_auto_occluder_faces = 16384;
+    std::vector<bool> visible(render_list.size(), true);
+    const auto culler = Engine::occlusion_culler;
+    culler->begin_frame(Engine::active_camera->get_projection_matrix() * view_matrix);
+    std::vector<std::pair<size_t, Mesh *>> meshes;
+    bool has_flagged_occluders = false;
+    for (size_t i = 0; i < render_list.size(); i++) {
+        Mesh *mesh = dynamic_cast<Mesh *>(render_list[i].first);
+        if (mesh == nullptr) continue;
+        meshes.emplace_back(i, mesh);
+        if (mesh->get_occluder()) {
+            culler->add_occluder(*mesh, render_list[i].second);
+            has_flagged_occluders = true;
+        }
+    }
+    if (!has_flagged_occluders && culler->get_max_auto_occluders() > 0) {
+        std::vector<std::pair<float, size_t>> candidates;
+        for (size_t m = 0; m < meshes.size(); m++) {
+            const auto &mesh = meshes[m].second;
+            if (mesh->get_faces().empty() || mesh->get_faces().size() > max_auto_occluder_faces) continue;
+            if (mesh->get_material()->is_blended()) continue;
+            const glm::mat4 model_view = view_matrix * render_list[meshes[m].first].second;
+            const glm::vec3 center = glm::vec3(model_view * glm::vec4(0.5f * (mesh->get_bounds_min() + mesh->get_bounds_max()), 1.0f));
+            const glm::vec3 extent = glm::vec3(model_view * glm::vec4(mesh->get_bounds_max() - mesh->get_bounds_min(), 0.0f));
+            const float distance = std::max(-center.z, 1e-3f);
+            candidates.emplace_back(glm::length(extent) / distance, m);
         }
-		const auto found = Engine::find_obj_by_name(name, child);
-        if (found != nullptr) {
-            return found;
-		}
+        const size_t count = std::min(candidates.size(), (size_t)culler->get_max_auto_occluders());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), std::greater<>());
+        for (size_t c = 0; c < count; c++) {
+            const auto &entry = meshes[candidates[c].second];
+            culler->add_occluder(*entry.second, render_list[entry.first].second);
+        }
+    }
+    culler->rasterize();
+    for (const auto &entry : meshes) {
+        const auto &mesh = entry.second;
+        visible[entry.first] = culler->is_visible(mesh->get_bounds_min(), mesh->get_bounds_max(), render_list[entry.first].second);
     }
-	return nullptr;
+    return visible;
 }
 
 static void glfw_framebuffer_size_callback(GLFWwindow* /*window*/, int width, int height) {
@@ -11,6 +11,7 @@
 
 #include <memory> 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -19,10 +20,27 @@
 #include "object.h"
 #include "node.h"
 #include "camera.h"
+#include "lod_selector.h"
 #include "material.h"
+#include "mesh.h"
+#include "meshlet_culler.h"
+#include "node_pool.h"
+#include "occlusion_culler.h"
+#include "render_queue.h"
+#include "scene_index.h"
 
 namespace lrvg {
 
+/**
+ * @brief Result of a picking query: the nearest mesh under a screen position.
+ */
+struct ENG_API PickResult {
+    std::shared_ptr<Mesh> mesh;
+    glm::vec3 point;
+    uint32_t face;
+    float distance;
+};
+
 /**
  * @brief Base engine main class. This class is a singleton.
  */
@@ -39,31 +57,46 @@ public:
     static void set_scene(const std::shared_ptr<Node> scene);
 	static void set_sky_color(const float red, const float green, const float blue);
     static void set_screen_text(const std::string text);
+    static void set_occlusion_culling(const bool enabled);
     static void set_keyboard_callback(void(*keyboard_callback)(const unsigned char key, const int mouse_x, const int mouse_y));
     static bool is_running();
     static void vsync_enable();
     static std::shared_ptr<Node> get_scene();
+    static std::shared_ptr<OcclusionCuller> get_occlusion_culler();
+    static std::shared_ptr<LODSelector> get_lod_selector();
+    static std::shared_ptr<MeshletCuller> get_meshlet_culler();
     static void get_window_size(int& width, int& height);
     static void update();
     static void clear_screen();
     static void render();
 	static void swap_buffers();
-	static std::shared_ptr<Object> find_obj_by_name(const std::string name);
+	static std::shared_ptr<Object> find_obj_by_name(const std::string_view name);
+	static std::shared_ptr<Object> find_obj_by_path(const std::string_view path);
+	static std::shared_ptr<Object> find_obj_by_id(const int id);
+	static std::shared_ptr<Object> find_obj_by_handle(const NodeHandle handle);
+	static size_t defragment_scene();
+    static PickResult pick(const int x, const int y);
     static void draw_text_overlay(int fb_width, int fb_height, const char* text, float x, float y, float r, float g, float b);
 private: 
-	static std::vector<std::pair<std::shared_ptr<Node>, glm::mat4>> build_render_list(const std::shared_ptr<Node>, const glm::mat4 par_world_matrix);
-	static std::shared_ptr<Object> find_obj_by_name(const std::string name, const std::shared_ptr<Node> root);
+	static std::vector<std::pair<Node *, glm::mat4>> build_render_list();
+	static std::vector<bool> cull_occluded(const std::vector<std::pair<Node *, glm::mat4>> &render_list, const glm::mat4 view_matrix);
 	static int window_id;
 	static int window_width;
 	static int window_height;
+	static std::shared_ptr<SceneIndex> scene_index;
 	static std::shared_ptr<Node> scene;
 	static std::shared_ptr<Camera> active_camera;
     static std::shared_ptr<Material> shadow_material;
+    static std::shared_ptr<OcclusionCuller> occlusion_culler;
+    static std::shared_ptr<RenderQueue> render_queue;
+    static std::shared_ptr<LODSelector> lod_selector;
+    static std::shared_ptr<MeshletCuller> meshlet_culler;
 	static std::string screen_text;
 	static int frames;
 	static float fps;
 	static bool is_initialized_f;
 	static bool is_running_f;
+	static bool occlusion_culling_f;
 	Engine();
 };
 
@@ -0,0 +1,118 @@
+/**
+ * @file	geometry_cache.cpp
+ * @brief	Geometry cache class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "geometry_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "common.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+// Generators split their rows across the thread pool from this many vertices
+static constexpr size_t PARALLEL_VERTEX_COUNT = 64 * 1024;
+
+/**
+ * Retrieves the geometry of a primitive, generating it if no mesh currently uses it.
+ * Generation runs outside the cache lock, so that primitives of other kinds or sizes are not
+ * held up; when two threads generate the same geometry at once, the first one stored wins.
+ *
+ * @param type The kind of primitive.
+ * @param a The first generation parameter, such as a segment count.
+ * @param b The second generation parameter, or 0 if unused.
+ * @param generator The function generating the full-resolution level of the primitive.
+ * @return A shared pointer to the geometry.
+ */
+std::shared_ptr<const MeshGeometry> ENG_API GeometryCache::get(const PrimitiveType type, const uint32_t a, const uint32_t b, const std::function<MeshLOD()> &generator) {
+	const uint64_t key = GeometryCache::make_key(type, a, b);
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		const auto it = this->entries.find(key);
+		if (it != this->entries.end()) {
+			std::shared_ptr<const MeshGeometry> geometry = it->second.lock();
+			if (geometry != nullptr) return geometry;
+		}
+	}
+	std::shared_ptr<const MeshGeometry> geometry = std::make_shared<const MeshGeometry>(generator());
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::weak_ptr<const MeshGeometry> &entry = this->entries[key];
+	std::shared_ptr<const MeshGeometry> existing = entry.lock();
+	if (existing != nullptr) return existing;
+	entry = geometry;
+	return geometry;
+}
+
+/**
+ * Retrieves the number of geometries currently used by at least one mesh.
+ *
+ * @return The number of live entries.
+ */
+size_t ENG_API GeometryCache::get_entry_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	size_t count = 0;
+	for (const auto &entry : this->entries) {
+		if (!entry.second.expired()) count++;
+	}
+	return count;
+}
+
+/**
+ * Removes the entries of geometries no longer used by any mesh.
+ *
+ * @return The number of entries removed.
+ */
+size_t ENG_API GeometryCache::purge() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return std::erase_if(this->entries, [](const auto &entry) {
+		return entry.second.expired();
+	});
+}
+
+/**
+ * Retrieves the process-wide geometry cache, used by the Cube, Sphere and Plane constructors.
+ *
+ * @return A reference to the shared geometry cache.
+ */
+GeometryCache ENG_API &GeometryCache::get_shared() {
+	static GeometryCache cache;
+	return cache;
+}
+
+/**
+ * Runs a generator over rows of vertices or faces, on the shared thread pool for large meshes.
+ *
+ * @param row_count The number of rows.
+ * @param row_size The number of vertices per row, to decide whether to go parallel.
+ * @param fn The function generating the rows in [begin, end).
+ */
+void ENG_API GeometryCache::parallel_rows(const size_t row_count, const size_t row_size, const std::function<void(const size_t begin, const size_t end)> &fn) {
+	if (row_count * row_size < PARALLEL_VERTEX_COUNT) {
+		fn(0, row_count);
+		return;
+	}
+	ThreadPool::get_shared().parallel_for(row_count, fn);
+}
+
+/**
+ * Packs the kind and parameters of a primitive into a cache key.
+ *
+ * @param type The kind of primitive.
+ * @param a The first generation parameter.
+ * @param b The second generation parameter.
+ * @return The cache key.
+ */
+uint64_t GeometryCache::make_key(const PrimitiveType type, const uint32_t a, const uint32_t b) {
+	// 28 bits per parameter: primitives that large could never be generated anyway
+	constexpr uint64_t mask = (1ull << 28) - 1;
+	return ((uint64_t)type << 56) | (((uint64_t)a & mask) << 28) | ((uint64_t)b & mask);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file	geometry_cache.h
+ * @brief	Geometry cache class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Kinds of procedural geometry stored in the geometry cache.
+ */
+enum class PrimitiveType : uint8_t {
+	Cube,
+	Sphere,
+	Plane
+};
+
+/**
+ * @brief Cache of procedural geometry, shared by every mesh generated with the same parameters.
+ * Entries are weak: a geometry lives as long as one mesh uses it, and is generated again
+ * the next time it is requested after that.
+ */
+class ENG_API GeometryCache final {
+public:
+	GeometryCache() = default;
+	GeometryCache(GeometryCache const &) = delete;
+	void operator=(GeometryCache const &) = delete;
+	std::shared_ptr<const MeshGeometry> get(const PrimitiveType type, const uint32_t a, const uint32_t b, const std::function<MeshLOD()> &generator);
+	size_t get_entry_count() const;
+	size_t purge();
+	static GeometryCache &get_shared();
+	static void parallel_rows(const size_t row_count, const size_t row_size, const std::function<void(const size_t begin, const size_t end)> &fn);
+private:
+	static uint64_t make_key(const PrimitiveType type, const uint32_t a, const uint32_t b);
+	mutable std::mutex mutex;
+	std::unordered_map<uint64_t, std::weak_ptr<const MeshGeometry>> entries;
+};
+
+}
@@ -0,0 +1,151 @@
+/**
+ * @file	index_buffer.cpp
+ * @brief	Index buffer class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "index_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "common.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new, empty index buffer.
+ */
+ENG_API IndexBuffer::IndexBuffer() : max_index{ 0 } {}
+
+/**
+ * Fills the buffer with the indices of a list of faces, replacing its contents.
+ * The buffer narrows to 16-bit indices when the mesh has at most 65536 vertices.
+ *
+ * @param faces The triangular faces to store, three indices each.
+ * @param vertex_count The number of vertices of the mesh.
+ */
+void ENG_API IndexBuffer::assign(const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const size_t vertex_count) {
+	this->clear();
+	if (vertex_count <= (size_t)std::numeric_limits<uint16_t>::max() + 1) {
+		this->narrow.reserve(faces.size() * 3);
+		for (const auto &[a, b, c] : faces) {
+			this->narrow.push_back((uint16_t)a);
+			this->narrow.push_back((uint16_t)b);
+			this->narrow.push_back((uint16_t)c);
+			this->max_index = std::max({ this->max_index, a, b, c });
+		}
+	} else {
+		this->wide.reserve(faces.size() * 3);
+		for (const auto &[a, b, c] : faces) {
+			this->wide.push_back(a);
+			this->wide.push_back(b);
+			this->wide.push_back(c);
+			this->max_index = std::max({ this->max_index, a, b, c });
+		}
+	}
+}
+
+/**
+ * Fills the buffer with ready-made 16-bit indices, such as those of a baked scene.
+ *
+ * @param indices The indices, three per face.
+ * @param max_index The largest of the indices.
+ */
+void ENG_API IndexBuffer::assign(const std::span<const uint16_t> indices, const uint32_t max_index) {
+	this->clear();
+	this->narrow.assign(indices.begin(), indices.end());
+	this->max_index = max_index;
+}
+
+/**
+ * Fills the buffer with ready-made 32-bit indices, such as those of a baked scene.
+ *
+ * @param indices The indices, three per face.
+ * @param max_index The largest of the indices.
+ */
+void ENG_API IndexBuffer::assign(const std::span<const uint32_t> indices, const uint32_t max_index) {
+	this->clear();
+	this->wide.assign(indices.begin(), indices.end());
+	this->max_index = max_index;
+}
+
+/**
+ * Removes every index from the buffer and releases its memory.
+ */
+void ENG_API IndexBuffer::clear() {
+	std::vector<uint16_t>().swap(this->narrow);
+	std::vector<uint32_t>().swap(this->wide);
+	this->max_index = 0;
+}
+
+/**
+ * Checks whether the indices are stored on 16 bits.
+ *
+ * @return True for 16-bit indices, false for 32-bit indices.
+ */
+bool ENG_API IndexBuffer::is_narrow() const {
+	return this->wide.empty();
+}
+
+/**
+ * Checks whether the buffer holds no index.
+ *
+ * @return True if the buffer is empty.
+ */
+bool ENG_API IndexBuffer::empty() const {
+	return this->narrow.empty() && this->wide.empty();
+}
+
+/**
+ * Retrieves the number of indices, three per face.
+ *
+ * @return The number of indices.
+ */
+size_t ENG_API IndexBuffer::size() const {
+	return this->narrow.size() + this->wide.size();
+}
+
+/**
+ * Retrieves the memory taken by the indices.
+ *
+ * @return The size of the index data, in bytes.
+ */
+size_t ENG_API IndexBuffer::get_size_bytes() const {
+	return this->narrow.size() * sizeof(uint16_t) + this->wide.size() * sizeof(uint32_t);
+}
+
+/**
+ * Retrieves the largest index stored in the buffer, as needed by ranged draw calls.
+ *
+ * @return The largest index, or 0 for an empty buffer.
+ */
+uint32_t ENG_API IndexBuffer::get_max_index() const {
+	return this->max_index;
+}
+
+/**
+ * Retrieves an index, whatever its storage size.
+ *
+ * @param i The position of the index, from 0 to `size() - 1`.
+ * @return The index.
+ */
+uint32_t ENG_API IndexBuffer::get(const size_t i) const {
+	return this->is_narrow() ? this->narrow[i] : this->wide[i];
+}
+
+/**
+ * Retrieves the raw index data, to be passed to the draw call with the type given by `is_narrow`.
+ *
+ * @return A pointer to the first index.
+ */
+const void ENG_API *IndexBuffer::data() const {
+	return this->is_narrow() ? static_cast<const void *>(this->narrow.data()) : static_cast<const void *>(this->wide.data());
+}
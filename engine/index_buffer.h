@@ -0,0 +1,46 @@
+/**
+ * @file	index_buffer.h
+ * @brief	Index buffer class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Compact triangle index buffer, ready to be drawn.
+ * Indices are stored on 16 bits when every vertex can be addressed that way, and on 32 bits otherwise.
+ */
+class ENG_API IndexBuffer final {
+public:
+	IndexBuffer();
+	void assign(const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const size_t vertex_count);
+	void assign(const std::span<const uint16_t> indices, const uint32_t max_index);
+	void assign(const std::span<const uint32_t> indices, const uint32_t max_index);
+	void clear();
+	bool is_narrow() const;
+	bool empty() const;
+	size_t size() const;
+	size_t get_size_bytes() const;
+	uint32_t get_max_index() const;
+	uint32_t get(const size_t i) const;
+	const void *data() const;
+private:
+	std::vector<uint16_t> narrow;
+	std::vector<uint32_t> wide;
+	uint32_t max_index;
+};
+
+}
@@ -0,0 +1,202 @@
+/**
+ * @file	lazy_mesh_loader.cpp
+ * @brief	Deferred mesh geometry loader class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "lazy_mesh_loader.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "common.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+/**
+ * Checks whether a box may intersect the view frustum, given the matrix to clip space.
+ * The box is only rejected when all of its corners lie outside the same clipping plane.
+ *
+ * @param bounds_min The minimum corner of the box.
+ * @param bounds_max The maximum corner of the box.
+ * @param model_view_projection The matrix from the space of the box to clip space.
+ * @return Whether the box may be visible.
+ */
+static bool intersects_frustum(const glm::vec3 bounds_min, const glm::vec3 bounds_max, const glm::mat4 &model_view_projection) {
+	glm::vec4 corners[8];
+	for (int i = 0; i < 8; i++) {
+		const glm::vec3 corner((i & 1) ? bounds_max.x : bounds_min.x, (i & 2) ? bounds_max.y : bounds_min.y, (i & 4) ? bounds_max.z : bounds_min.z);
+		corners[i] = model_view_projection * glm::vec4(corner, 1.0f);
+	}
+	for (int axis = 0; axis < 3; axis++) {
+		int below = 0;
+		int above = 0;
+		for (const glm::vec4 &corner : corners) {
+			if (corner[axis] < -corner.w) below++;
+			if (corner[axis] > corner.w) above++;
+		}
+		if (below == 8 || above == 8) return false;
+	}
+	return true;
+}
+
+/**
+ * Destroys the loader, once the geometries being decoded on the thread pool are done.
+ * Meshes still pending are detached from it and keep their placeholder geometry.
+ */
+ENG_API LazyMeshLoader::~LazyMeshLoader() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	// Decoded geometries wait in `results` until `update`, so the others are still in flight
+	this->decoded.wait(lock, [this]() { return this->results.size() == this->loading_count; });
+	for (const auto &entry : this->entries) {
+		if (const std::shared_ptr<Mesh> mesh = entry.second.mesh.lock()) {
+			mesh->lazy_loader = nullptr;
+		}
+	}
+}
+
+/**
+ * Defers the loading of the geometry of a mesh until it is requested.
+ * The mesh gets a placeholder geometry with the given bounds and no faces; the decoder later fills
+ * a staging mesh on a worker thread, so it must only read data that stays valid and unchanged,
+ * and must not hold the mesh itself. It is released once the geometry is loaded or the mesh is destroyed.
+ *
+ * @param mesh The mesh to load lazily.
+ * @param bounds_min The minimum corner of the bounds of the mesh, in model space.
+ * @param bounds_max The maximum corner of the bounds of the mesh, in model space.
+ * @param decoder The function loading the geometry into a staging mesh.
+ */
+void ENG_API LazyMeshLoader::add(const std::shared_ptr<Mesh> &mesh, const glm::vec3 bounds_min, const glm::vec3 bounds_max, Decoder decoder) {
+	std::shared_ptr<MeshGeometry> placeholder = std::make_shared<MeshGeometry>();
+	placeholder->bounds_min = bounds_min;
+	placeholder->bounds_max = bounds_max;
+	mesh->set_geometry(placeholder);
+	if (mesh->lazy_loader != nullptr && mesh->lazy_loader != this) {
+		mesh->lazy_loader->remove(*mesh);
+	}
+	mesh->lazy_loader = this;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries[mesh.get()] = Entry{ mesh, std::move(decoder), false };
+}
+
+/**
+ * Starts loading the geometry of a mesh, if it is pending.
+ * This must be called from the thread that creates scene objects, which also creates the staging mesh.
+ *
+ * @param mesh The mesh.
+ * @return Whether the mesh was pending and its loading started.
+ */
+bool ENG_API LazyMeshLoader::request(Mesh &mesh) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->entries.empty()) return false;
+	const auto it = this->entries.find(&mesh);
+	if (it == this->entries.end() || it->second.loading) return false;
+	it->second.loading = true;
+	this->loading_count++;
+	const std::shared_ptr<Mesh> staging = std::make_shared<Mesh>();
+	ThreadPool::get_shared().enqueue([this, staging, decoder = it->second.decoder, key = &mesh, owner = it->second.mesh]() {
+		decoder(staging);
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->results.push_back(Result{ key, owner, staging->get_geometry() });
+		this->decoded.notify_all();
+	});
+	return true;
+}
+
+/**
+ * Starts loading the geometry of a mesh if it is pending and its bounds intersect the view frustum.
+ * This is what the engine calls for every mesh that passes culling.
+ *
+ * @param mesh The mesh.
+ * @param model_view_projection The matrix from the model space of the mesh to clip space.
+ * @return Whether the mesh was pending and its loading started.
+ */
+bool ENG_API LazyMeshLoader::request(Mesh &mesh, const glm::mat4 &model_view_projection) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->entries.empty()) return false;
+	}
+	if (mesh.get_lod(0).faces.size() > 0) return false;
+	if (!intersects_frustum(mesh.get_bounds_min(), mesh.get_bounds_max(), model_view_projection)) return false;
+	return this->request(mesh);
+}
+
+/**
+ * Hands the geometries loaded since the last call over to their meshes.
+ * This must be called from the thread that renders, typically once per frame.
+ *
+ * @return The number of meshes whose geometry was loaded.
+ */
+size_t ENG_API LazyMeshLoader::update() {
+	std::vector<Result> loaded;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->results.empty()) return 0;
+		loaded.swap(this->results);
+		this->loading_count -= loaded.size();
+		for (const Result &result : loaded) {
+			// The entry may belong to a newer mesh allocated at the same address
+			const auto it = this->entries.find(result.key);
+			if (it != this->entries.end() && !it->second.mesh.owner_before(result.mesh) && !result.mesh.owner_before(it->second.mesh)) {
+				this->entries.erase(it);
+			}
+		}
+	}
+	size_t count = 0;
+	for (const Result &result : loaded) {
+		const std::shared_ptr<Mesh> mesh = result.mesh.lock();
+		if (mesh == nullptr) continue;
+		mesh->set_geometry(result.geometry);
+		mesh->lazy_loader = nullptr;
+		count++;
+	}
+	return count;
+}
+
+/**
+ * Retrieves the number of meshes whose geometry is not loaded yet, including those being loaded.
+ *
+ * @return The number of pending meshes.
+ */
+size_t ENG_API LazyMeshLoader::get_pending_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->entries.size();
+}
+
+/**
+ * Retrieves the number of meshes whose geometry is being loaded.
+ *
+ * @return The number of meshes being loaded.
+ */
+size_t ENG_API LazyMeshLoader::get_loading_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->loading_count;
+}
+
+/**
+ * Retrieves the process-wide lazy mesh loader, used by the OVO parser and the engine.
+ * The shared thread pool is created first, so that it is destroyed after the loader.
+ *
+ * @return A reference to the shared lazy mesh loader.
+ */
+LazyMeshLoader ENG_API &LazyMeshLoader::get_shared() {
+	UNREF ThreadPool &pool = ThreadPool::get_shared();
+	static LazyMeshLoader loader;
+	return loader;
+}
+
+/**
+ * Removes a mesh destroyed before its geometry was loaded, releasing its decoder.
+ * A load already in progress completes, and its result is discarded by `update`.
+ *
+ * @param mesh The mesh being destroyed.
+ */
+void LazyMeshLoader::remove(const Mesh &mesh) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries.erase(&mesh);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file	lazy_mesh_loader.h
+ * @brief	Deferred mesh geometry loader class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Loads the geometry of meshes only once they are first found visible.
+ * Pending meshes hold a placeholder geometry with their bounds and no faces, so they can be
+ * culled as usual. Once requested, their geometry is decoded on the shared thread pool and
+ * swapped in by `update`, on the thread that renders. Meshes destroyed while pending remove
+ * themselves from the loader, so that their decoders never outlive them.
+ */
+class ENG_API LazyMeshLoader final {
+public:
+	using Decoder = std::function<void(const std::shared_ptr<Mesh> &mesh)>;
+	LazyMeshLoader() = default;
+	LazyMeshLoader(LazyMeshLoader const &) = delete;
+	void operator=(LazyMeshLoader const &) = delete;
+	~LazyMeshLoader();
+	void add(const std::shared_ptr<Mesh> &mesh, const glm::vec3 bounds_min, const glm::vec3 bounds_max, Decoder decoder);
+	bool request(Mesh &mesh);
+	bool request(Mesh &mesh, const glm::mat4 &model_view_projection);
+	size_t update();
+	size_t get_pending_count() const;
+	size_t get_loading_count() const;
+	static LazyMeshLoader &get_shared();
+private:
+	friend class Mesh;
+	struct Entry {
+		std::weak_ptr<Mesh> mesh;
+		Decoder decoder;
+		bool loading;
+	};
+	struct Result {
+		const Mesh *key;
+		std::weak_ptr<Mesh> mesh;
+		std::shared_ptr<const MeshGeometry> geometry;
+	};
+	void remove(const Mesh &mesh);
+	mutable std::mutex mutex;
+	std::condition_variable decoded;
+	std::unordered_map<const Mesh *, Entry> entries;
+	std::vector<Result> results;
+	size_t loading_count = 0;
+};
+
+}
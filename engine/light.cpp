@@ -9,17 +9,24 @@
 
 #include "light.h"
 
+#include <atomic>
+
 #include <glad/gl.h>
 
 #include "common.h"
 
 using namespace lrvg;
 
-int Light::next_light_id = 0;
+std::atomic<int> Light::next_light_id{ 0 };
+
+/**
+ * Maximum number of lights supported by OpenGL, or 0 until set by the engine.
+ */
+std::atomic<int> Light::max_lights{ 0 };
 
 /**
  * Creates a new instance of Light with default color values and assigns it a unique light ID.
- * The light is enabled in OpenGL if the maximum number of lights has not been reached.
+ * The light is enabled in OpenGL when rendered, so lights can be created on any thread.
  * 
  * IDs are autogenerated starting from 0 up to the maximum number of lights supported by OpenGL.
  * 
@@ -29,20 +36,39 @@ int Light::next_light_id = 0;
  * * Specular Color: (1.0, 1.0, 1.0) [White]
  */
 ENG_API Light::Light() {
-	int max_num_lights;
-	glGetIntegerv(GL_MAX_LIGHTS, &max_num_lights);
-	Light::next_light_id++;
-	this->light_id = Light::next_light_id % max_num_lights;
+	const int max_num_lights = Light::get_max_lights();
+	this->light_id = (Light::next_light_id.fetch_add(1, std::memory_order_relaxed) + 1) % max_num_lights;
 	DEBUG("Light %d/%d created", this->light_id, max_num_lights);
 	if (UNLIKELY(this->light_id >= max_num_lights)) {
 		WARN("Maximum number of lights reached (%d)", max_num_lights);
 		return;
 	}
-	const int cur_light = get_current_light(this->light_id);
 	this->set_ambient_color(glm::vec3(1.0f, 1.0f, 1.0f));
 	this->set_diffuse_color(glm::vec3(1.0f, 1.0f, 1.0f));
 	this->set_specular_color(glm::vec3(1.0f, 1.0f, 1.0f));
-	glEnable(cur_light);
+}
+
+/**
+ * Retrieves the maximum number of lights supported by OpenGL.
+ * OpenGL is never queried here, so that lights can be created on any thread and before the
+ * engine is initialized; until the engine sets the value, the minimum guaranteed by OpenGL (8)
+ * is assumed.
+ *
+ * @return The maximum number of lights.
+ */
+int ENG_API Light::get_max_lights() {
+	const int max_num_lights = Light::max_lights.load(std::memory_order_relaxed);
+	return max_num_lights > 0 ? max_num_lights : 8;
+}
+
+/**
+ * Sets the maximum number of lights supported by OpenGL.
+ * This method is called by the engine when initialized, with the value queried from the context.
+ *
+ * @param max_num_lights The maximum number of lights; values below 1 restore the default of 8.
+ */
+void ENG_API Light::set_max_lights(const int max_num_lights) {
+	Light::max_lights.store(max_num_lights, std::memory_order_relaxed);
 }
 
 /**
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "common.h"
 #include "node.h"
 
@@ -20,6 +22,8 @@ namespace lrvg {
 class ENG_API Light : public Node {
 public:
 	Light();
+	static int get_max_lights();
+	static void set_max_lights(const int max_num_lights);
     virtual ~Light() = default;
 	int get_priority() const override;
 	void set_ambient_color(const glm::vec3 color);
@@ -32,7 +36,8 @@ protected:
 	glm::vec3 diffuse_color;
 	glm::vec3 specular_color;
 	int get_current_light(const int light_id) const;
-	static int next_light_id;
+	static std::atomic<int> next_light_id;
+	static std::atomic<int> max_lights;
 };
 
 }
@@ -0,0 +1,195 @@
+/**
+ * @file	lod_selector.cpp
+ * @brief	Level of detail selector class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "lod_selector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "common.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new level of detail selector.
+ * Default values:
+ * * Enabled: true
+ * * Bias: 1.0
+ * * Hysteresis: 0.1
+ */
+ENG_API LODSelector::LODSelector() : enabled{ true }, bias{ 1.0f }, hysteresis{ 0.1f }, projection{ 1.0f } {
+	this->begin_frame(glm::mat4(1.0f));
+}
+
+/**
+ * Enables or disables the selection. When disabled, every mesh is drawn at full resolution.
+ *
+ * @param enabled Whether levels of detail are selected.
+ */
+void ENG_API LODSelector::set_enabled(const bool enabled) {
+	this->enabled = enabled;
+}
+
+/**
+ * Sets the bias applied to projected sizes before selecting a level.
+ * Values above 1 keep finer levels for longer, values below 1 switch to coarser levels sooner.
+ *
+ * @param bias The multiplier applied to projected sizes.
+ */
+void ENG_API LODSelector::set_bias(const float bias) {
+	this->bias = std::max(bias, 0.0f);
+}
+
+/**
+ * Sets the hysteresis margin around the level thresholds.
+ * A mesh goes coarser below `threshold * (1 - hysteresis)` and finer above `threshold * (1 + hysteresis)`.
+ *
+ * @param hysteresis The relative margin, clamped to [0, 0.9].
+ */
+void ENG_API LODSelector::set_hysteresis(const float hysteresis) {
+	this->hysteresis = std::clamp(hysteresis, 0.0f, 0.9f);
+}
+
+/**
+ * Checks whether levels of detail are selected.
+ *
+ * @return True if the selection is enabled, false otherwise.
+ */
+bool ENG_API LODSelector::is_enabled() const {
+	return this->enabled;
+}
+
+/**
+ * Retrieves the bias applied to projected sizes.
+ *
+ * @return The multiplier applied to projected sizes.
+ */
+float ENG_API LODSelector::get_bias() const {
+	return this->bias;
+}
+
+/**
+ * Retrieves the hysteresis margin around the level thresholds.
+ *
+ * @return The relative margin.
+ */
+float ENG_API LODSelector::get_hysteresis() const {
+	return this->hysteresis;
+}
+
+/**
+ * Retrieves the number of meshes processed during the last frame.
+ *
+ * @return The number of meshes.
+ */
+int ENG_API LODSelector::get_mesh_count() const {
+	return this->mesh_count;
+}
+
+/**
+ * Retrieves the number of meshes drawn at a given level during the last frame.
+ * Levels past `MAX_TRACKED_LEVELS - 1` are counted with the last tracked level.
+ *
+ * @param level The level of detail.
+ * @return The number of meshes drawn at that level.
+ */
+int ENG_API LODSelector::get_level_count(const size_t level) const {
+	if (UNLIKELY(level >= MAX_TRACKED_LEVELS)) return 0;
+	return this->level_counts[level];
+}
+
+/**
+ * Retrieves the number of triangles selected during the last frame.
+ *
+ * @return The number of triangles at the selected levels.
+ */
+size_t ENG_API LODSelector::get_face_count() const {
+	return this->face_count;
+}
+
+/**
+ * Retrieves the number of triangles the last frame would have drawn at full resolution.
+ *
+ * @return The number of triangles at level 0.
+ */
+size_t ENG_API LODSelector::get_full_face_count() const {
+	return this->full_face_count;
+}
+
+/**
+ * Starts a new frame: statistics are reset.
+ * This method is called automatically by the engine.
+ *
+ * @param projection The projection matrix of the active camera.
+ */
+void ENG_API LODSelector::begin_frame(const glm::mat4 projection) {
+	this->projection = projection;
+	this->mesh_count = 0;
+	std::fill(std::begin(this->level_counts), std::end(this->level_counts), 0);
+	this->face_count = 0;
+	this->full_face_count = 0;
+}
+
+/**
+ * Selects and applies the level of detail of a mesh for the current frame.
+ * This method is called automatically by the engine.
+ *
+ * @param mesh The mesh to update.
+ * @param model_view The model-view matrix of the mesh.
+ * @return The selected level.
+ */
+size_t ENG_API LODSelector::select(Mesh &mesh, const glm::mat4 &model_view) {
+	const size_t count = mesh.get_lod_count();
+	size_t level = 0;
+	if (this->enabled && count > 1) {
+		const float size = LODSelector::get_screen_size(mesh, model_view, this->projection) * this->bias;
+		level = std::min(mesh.get_lod_level(), count - 1);
+		while (level + 1 < count && size < mesh.get_lod(level + 1).screen_size * (1.0f - this->hysteresis)) {
+			level++;
+		}
+		while (level > 0 && size > mesh.get_lod(level).screen_size * (1.0f + this->hysteresis)) {
+			level--;
+		}
+	}
+	mesh.set_lod_level(level);
+	this->mesh_count++;
+	this->level_counts[std::min(level, MAX_TRACKED_LEVELS - 1)]++;
+	this->face_count += mesh.get_lod(level).faces.size();
+	this->full_face_count += mesh.get_lod(0).faces.size();
+	return level;
+}
+
+/**
+ * Computes the projected size of a mesh, as the fraction of the viewport height covered by its bounding sphere.
+ * Meshes crossing the camera plane report an infinite size.
+ *
+ * @param mesh The mesh to measure.
+ * @param model_view The model-view matrix of the mesh.
+ * @param projection The projection matrix.
+ * @return The projected size of the mesh.
+ */
+float ENG_API LODSelector::get_screen_size(const Mesh &mesh, const glm::mat4 &model_view, const glm::mat4 &projection) {
+	const glm::vec3 center = glm::vec3(model_view * glm::vec4(0.5f * (mesh.get_bounds_min() + mesh.get_bounds_max()), 1.0f));
+	const float scale = std::max({
+		glm::length(glm::vec3(model_view[0])),
+		glm::length(glm::vec3(model_view[1])),
+		glm::length(glm::vec3(model_view[2]))
+	});
+	const float radius = 0.5f * glm::length(mesh.get_bounds_max() - mesh.get_bounds_min()) * scale;
+	// Orthographic projections have no perspective divide
+	if (projection[2][3] == 0.0f) {
+		return radius * projection[1][1];
+	}
+	const float depth = -center.z;
+	if (depth <= radius) {
+		return std::numeric_limits<float>::infinity();
+	}
+	return radius * projection[1][1] / depth;
+}
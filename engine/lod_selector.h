@@ -0,0 +1,55 @@
+/**
+ * @file	lod_selector.h
+ * @brief	Level of detail selector class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Selects the level of detail of meshes from their projected size on screen.
+ * A mesh switches to a coarser level when its bounding sphere covers less than the level's
+ * screen size, and back to a finer one only once it grows past the threshold by the hysteresis
+ * margin, so that meshes near a threshold do not flicker between levels.
+ */
+class ENG_API LODSelector final {
+public:
+	static constexpr size_t MAX_TRACKED_LEVELS = 8;
+	LODSelector();
+	void set_enabled(const bool enabled);
+	void set_bias(const float bias);
+	void set_hysteresis(const float hysteresis);
+	bool is_enabled() const;
+	float get_bias() const;
+	float get_hysteresis() const;
+	int get_mesh_count() const;
+	int get_level_count(const size_t level) const;
+	size_t get_face_count() const;
+	size_t get_full_face_count() const;
+	void begin_frame(const glm::mat4 projection);
+	size_t select(Mesh &mesh, const glm::mat4 &model_view);
+	static float get_screen_size(const Mesh &mesh, const glm::mat4 &model_view, const glm::mat4 &projection);
+private:
+	bool enabled;
+	float bias;
+	float hysteresis;
+	glm::mat4 projection;
+	int mesh_count;
+	int level_counts[MAX_TRACKED_LEVELS];
+	size_t face_count;
+	size_t full_face_count;
+};
+
+}
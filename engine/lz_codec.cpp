@@ -0,0 +1,206 @@
+/**
+ * @file	lz_codec.cpp
+ * @brief	LZ77 block codec class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "lz_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common.h"
+
+using namespace lrvg;
+
+/**
+ * Number of bits of the hash of four bytes, indexing the table of previous positions.
+ */
+static constexpr uint32_t HASH_BITS = 16;
+
+/**
+ * Largest length stored in the four bits of a token; longer lengths continue in extra bytes.
+ */
+static constexpr size_t TOKEN_LENGTH_MAX = 15;
+
+/**
+ * Reads four bytes, in any alignment.
+ *
+ * @param data Pointer to the bytes.
+ * @return The bytes, as an integer.
+ */
+static INLINE uint32_t read32(const uint8_t *data) {
+	uint32_t value;
+	memcpy(&value, data, sizeof(uint32_t));
+	return value;
+}
+
+/**
+ * Hashes four bytes into an index of the table of previous positions.
+ *
+ * @param sequence The bytes.
+ * @return The index.
+ */
+static INLINE uint32_t hash(const uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * Writes the part of a length that does not fit in its token, as a run of bytes ending below 255.
+ *
+ * @param dst The compressed block.
+ * @param op The current offset in the block, advanced past the length.
+ * @param length The length, minus the part stored in the token.
+ */
+static INLINE void write_length(uint8_t *dst, size_t &op, size_t length) {
+	while (length >= 255) {
+		dst[op++] = 255;
+		length -= 255;
+	}
+	dst[op++] = (uint8_t)length;
+}
+
+/**
+ * Reads the part of a length that did not fit in its token.
+ *
+ * @param src The compressed block.
+ * @param src_size The size of the block.
+ * @param ip The current offset in the block, advanced past the length.
+ * @param length The length, to which the extra bytes are added.
+ * @return Whether the length was complete.
+ */
+static INLINE bool read_length(const uint8_t *src, const size_t src_size, size_t &ip, size_t &length) {
+	uint8_t byte;
+	do {
+		if (UNLIKELY(ip >= src_size)) return false;
+		byte = src[ip++];
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+/**
+ * Writes a token: a run of literals, then a match unless this is the last token.
+ *
+ * @param dst The compressed block.
+ * @param op The current offset in the block, advanced past the token.
+ * @param literals Pointer to the literals.
+ * @param literal_count The number of literals.
+ * @param offset How far back the match starts, or 0 for the last token.
+ * @param match_length The length of the match.
+ */
+static void write_token(uint8_t *dst, size_t &op, const uint8_t *literals, const size_t literal_count, const size_t offset, const size_t match_length) {
+	const size_t match_code = offset > 0 ? match_length - LZCodec::MIN_MATCH : 0;
+	uint8_t &token = dst[op++];
+	token = (uint8_t)((std::min(literal_count, TOKEN_LENGTH_MAX) << 4) | std::min(match_code, TOKEN_LENGTH_MAX));
+	if (literal_count >= TOKEN_LENGTH_MAX) write_length(dst, op, literal_count - TOKEN_LENGTH_MAX);
+	if (literal_count > 0) memcpy(dst + op, literals, literal_count);
+	op += literal_count;
+	if (offset == 0) return;
+	dst[op++] = (uint8_t)(offset & 0xff);
+	dst[op++] = (uint8_t)(offset >> 8);
+	if (match_code >= TOKEN_LENGTH_MAX) write_length(dst, op, match_code - TOKEN_LENGTH_MAX);
+}
+
+/**
+ * Gets the largest size a block can be compressed to, for sizing the output buffer.
+ *
+ * @param size The size of the uncompressed data.
+ * @return The largest compressed size.
+ */
+size_t ENG_API LZCodec::get_max_compressed_size(const size_t size) {
+	return size + size / 255 + 16;
+}
+
+/**
+ * Compresses a block of data.
+ * Positions are looked up by the hash of their next four bytes; on a miss, the search skips ahead
+ * faster the longer no match is found, so that incompressible data goes through quickly.
+ *
+ * @param src Pointer to the data.
+ * @param size Size of the data, in bytes.
+ * @param dst Pointer to the output, of at least `get_max_compressed_size(size)` bytes.
+ * @return The size of the compressed block.
+ */
+size_t ENG_API LZCodec::compress(const uint8_t *src, const size_t size, uint8_t *dst) {
+	// Positions are stored plus one, so that zero marks an empty slot
+	std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0);
+	size_t ip = 0;
+	size_t anchor = 0;
+	size_t op = 0;
+	while (size >= MIN_MATCH && ip <= size - MIN_MATCH) {
+		const uint32_t sequence = read32(src + ip);
+		uint32_t &slot = table[hash(sequence)];
+		const size_t candidate = slot;
+		slot = (uint32_t)(ip + 1);
+		if (candidate == 0 || ip + 1 - candidate > MAX_OFFSET || read32(src + candidate - 1) != sequence) {
+			ip += 1 + ((ip - anchor) >> 6);
+			continue;
+		}
+		size_t match = candidate - 1;
+		size_t length = MIN_MATCH;
+		while (ip + length < size && src[match + length] == src[ip + length]) {
+			length++;
+		}
+		while (ip > anchor && match > 0 && src[ip - 1] == src[match - 1]) {
+			ip--;
+			match--;
+			length++;
+		}
+		write_token(dst, op, src + anchor, ip - anchor, ip - match, length);
+		ip += length;
+		anchor = ip;
+		if (ip >= 2 && ip <= size - MIN_MATCH) {
+			table[hash(read32(src + ip - 2))] = (uint32_t)(ip - 1);
+		}
+	}
+	write_token(dst, op, src + anchor, size - anchor, 0, 0);
+	return op;
+}
+
+/**
+ * Decompresses a block of data, whose uncompressed size is known.
+ *
+ * @param src Pointer to the compressed block.
+ * @param src_size Size of the compressed block.
+ * @param dst Pointer to the output.
+ * @param dst_size Size of the uncompressed data.
+ * @return Whether the block was valid and filled the output exactly.
+ */
+bool ENG_API LZCodec::decompress(const uint8_t *src, const size_t src_size, uint8_t *dst, const size_t dst_size) {
+	size_t ip = 0;
+	size_t op = 0;
+	while (ip < src_size) {
+		const uint8_t token = src[ip++];
+		size_t literal_count = token >> 4;
+		if (literal_count == TOKEN_LENGTH_MAX && !read_length(src, src_size, ip, literal_count)) return false;
+		if (UNLIKELY(literal_count > src_size - ip || literal_count > dst_size - op)) return false;
+		memcpy(dst + op, src + ip, literal_count);
+		ip += literal_count;
+		op += literal_count;
+		if (ip == src_size) break;
+		if (UNLIKELY(src_size - ip < 2)) return false;
+		const size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+		ip += 2;
+		size_t length = token & TOKEN_LENGTH_MAX;
+		if (length == TOKEN_LENGTH_MAX && !read_length(src, src_size, ip, length)) return false;
+		length += MIN_MATCH;
+		if (UNLIKELY(offset == 0 || offset > op || length > dst_size - op)) return false;
+		uint8_t *out = dst + op;
+		const uint8_t *match = out - offset;
+		if (offset >= length) {
+			memcpy(out, match, length);
+		} else {
+			// The match overlaps its own output, repeating its last `offset` bytes
+			for (size_t i = 0; i < length; i++) {
+				out[i] = match[i];
+			}
+		}
+		op += length;
+	}
+	return op == dst_size;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file	lz_codec.h
+ * @brief	LZ77 block codec class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Fast byte-oriented LZ77 codec for independent blocks, in the spirit of LZ4.
+ * A block is a sequence of tokens, each holding a run of literals followed by a match of at least
+ * four bytes at most 64 KiB back; the last token only holds literals. Compression is greedy, with a
+ * single hash table lookup per position, and decompression checks every length and offset, so that
+ * corrupted blocks are rejected rather than read or written out of bounds.
+ */
+class ENG_API LZCodec final {
+public:
+	static constexpr size_t MIN_MATCH = 4;
+	static constexpr size_t MAX_OFFSET = 65535;
+	static size_t get_max_compressed_size(const size_t size);
+	static size_t compress(const uint8_t *src, const size_t size, uint8_t *dst);
+	static bool decompress(const uint8_t *src, const size_t src_size, uint8_t *dst, const size_t dst_size);
+};
+
+}
@@ -0,0 +1,190 @@
+/**
+ * @file	mapped_file.cpp
+ * @brief	Read-only memory-mapped file class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new mapped file, with no file open.
+ */
+ENG_API MappedFile::MappedFile() : mapping{ nullptr }, length{ 0 }
+#ifdef _WIN32
+	, file_handle{ INVALID_HANDLE_VALUE }, mapping_handle{ nullptr }
+#endif
+{}
+
+/**
+ * Creates a new mapped file and maps the file at the given path.
+ *
+ * @param path The path of the file to map.
+ */
+ENG_API MappedFile::MappedFile(const std::string &path) : MappedFile() {
+	this->open(path);
+}
+
+/**
+ * Takes over the mapping of another mapped file, which is left closed.
+ *
+ * @param other The mapped file to move from.
+ */
+ENG_API MappedFile::MappedFile(MappedFile &&other) noexcept : MappedFile() {
+	*this = std::move(other);
+}
+
+/**
+ * Unmaps the file, if any.
+ */
+ENG_API MappedFile::~MappedFile() {
+	this->close();
+}
+
+/**
+ * Unmaps the current file, if any, and takes over the mapping of another mapped file.
+ *
+ * @param other The mapped file to move from.
+ * @return This mapped file.
+ */
+MappedFile ENG_API &MappedFile::operator=(MappedFile &&other) noexcept {
+	if (this != &other) {
+		this->close();
+		std::swap(this->mapping, other.mapping);
+		std::swap(this->length, other.length);
+#ifdef _WIN32
+		std::swap(this->file_handle, other.file_handle);
+		std::swap(this->mapping_handle, other.mapping_handle);
+#endif
+	}
+	return *this;
+}
+
+/**
+ * Maps a whole file in memory for reading, replacing the current mapping.
+ * The operating system is told that the file will be read sequentially, so that pages are read ahead.
+ *
+ * @param path The path of the file to map.
+ * @return Whether the file was mapped. Empty files are open but have no data.
+ */
+bool ENG_API MappedFile::open(const std::string &path) {
+	this->close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size)) {
+		CloseHandle(file);
+		return false;
+	}
+	this->file_handle = file;
+	this->length = (size_t)file_size.QuadPart;
+	if (this->length == 0) return true;
+	HANDLE mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_handle == nullptr) {
+		this->close();
+		return false;
+	}
+	this->mapping_handle = mapping_handle;
+	this->mapping = (const uint8_t *)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if (this->mapping == nullptr) {
+		this->close();
+		return false;
+	}
+#else
+	const int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) return false;
+	struct stat file_stat;
+	if (fstat(file, &file_stat) != 0) {
+		::close(file);
+		return false;
+	}
+	this->length = (size_t)file_stat.st_size;
+	if (this->length > 0) {
+		void *mapping = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping == MAP_FAILED) {
+			::close(file);
+			this->length = 0;
+			return false;
+		}
+		madvise(mapping, this->length, MADV_SEQUENTIAL);
+		this->mapping = (const uint8_t *)mapping;
+	} else {
+		// Remember that an empty file is open, without mapping it
+		this->mapping = (const uint8_t *)"";
+	}
+	// The mapping stays valid once the descriptor is closed
+	::close(file);
+#endif
+	return true;
+}
+
+/**
+ * Unmaps the current file, if any.
+ */
+void ENG_API MappedFile::close() {
+#ifdef _WIN32
+	if (this->mapping != nullptr) UnmapViewOfFile(this->mapping);
+	if (this->mapping_handle != nullptr) CloseHandle(this->mapping_handle);
+	if (this->file_handle != INVALID_HANDLE_VALUE) CloseHandle(this->file_handle);
+	this->file_handle = INVALID_HANDLE_VALUE;
+	this->mapping_handle = nullptr;
+#else
+	if (this->length > 0) munmap((void *)this->mapping, this->length);
+#endif
+	this->mapping = nullptr;
+	this->length = 0;
+}
+
+/**
+ * Checks whether a file is mapped.
+ *
+ * @return Whether a file is open.
+ */
+bool ENG_API MappedFile::is_open() const {
+#ifdef _WIN32
+	return this->file_handle != INVALID_HANDLE_VALUE;
+#else
+	return this->mapping != nullptr;
+#endif
+}
+
+/**
+ * Gets the contents of the mapped file.
+ *
+ * @return A pointer to the first byte of the file, valid until the file is closed.
+ */
+const uint8_t ENG_API *MappedFile::data() const {
+	return this->mapping;
+}
+
+/**
+ * Gets the size of the mapped file.
+ *
+ * @return The size of the file, in bytes.
+ */
+size_t ENG_API MappedFile::size() const {
+	return this->length;
+}
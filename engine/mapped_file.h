@@ -0,0 +1,48 @@
+/**
+ * @file	mapped_file.h
+ * @brief	Read-only memory-mapped file class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Read-only view of a whole file mapped in memory.
+ * Pages are loaded by the operating system when first touched, so the contents can be parsed
+ * in place without reading them into intermediate buffers.
+ */
+class ENG_API MappedFile final {
+public:
+	MappedFile();
+	explicit MappedFile(const std::string &path);
+	MappedFile(const MappedFile &) = delete;
+	MappedFile(MappedFile &&other) noexcept;
+	~MappedFile();
+	MappedFile &operator=(const MappedFile &) = delete;
+	MappedFile &operator=(MappedFile &&other) noexcept;
+	bool open(const std::string &path);
+	void close();
+	bool is_open() const;
+	const uint8_t *data() const;
+	size_t size() const;
+private:
+	const uint8_t *mapping;
+	size_t length;
+#ifdef _WIN32
+	void *file_handle;
+	void *mapping_handle;
+#endif
+};
+
+}
@@ -26,6 +26,8 @@ using namespace lrvg;
  * * Diffuse Color: (0.75, 0.75, 0.75)
  * * Specular Color: (0.75, 0.75, 0.75)
  * * Shininess: 64.0
+ * * Transparency: 1.0 (opaque)
+ * * Blend mode: opaque
  * * Texture: nullptr (no texture)
  */
 ENG_API Material::Material() : Object() {
@@ -34,6 +36,8 @@ ENG_API Material::Material() : Object() {
 	this->set_diffuse_color(glm::vec3(0.8f, 0.8f, 0.8f));
 	this->set_specular_color(glm::vec3(0.5f, 0.5f, 0.5f));
 	this->set_shininess(128.0f);
+	this->set_transparency(1.0f);
+	this->set_blend_mode(BlendMode::Opaque);
 	this->set_texture(nullptr);
 }
 
@@ -82,6 +86,54 @@ void ENG_API Material::set_shininess(const float shininess) {
 	this->shininess = shininess;
 }
 
+/**
+ * Sets the transparency of the material, used as alpha when blending.
+ * As in OVO files, 1.0 is fully opaque and 0.0 fully transparent.
+ * The value only has an effect with a blend mode other than `BlendMode::Opaque`.
+ * 
+ * @param transparency A float in [0, 1] representing the transparency value.
+ */
+void ENG_API Material::set_transparency(const float transparency) {
+	this->transparency = glm::clamp(transparency, 0.0f, 1.0f);
+}
+
+/**
+ * Sets the blend mode of the material.
+ * Blended materials are drawn after the opaque ones, back to front and without depth writes.
+ * 
+ * @param blend_mode The blend mode to use.
+ */
+void ENG_API Material::set_blend_mode(const BlendMode blend_mode) {
+	this->blend_mode = blend_mode;
+}
+
+/**
+ * Retrieves the transparency of the material.
+ * 
+ * @return The transparency value, 1.0 being fully opaque.
+ */
+float ENG_API Material::get_transparency() const {
+	return this->transparency;
+}
+
+/**
+ * Retrieves the blend mode of the material.
+ * 
+ * @return The blend mode of the material.
+ */
+BlendMode ENG_API Material::get_blend_mode() const {
+	return this->blend_mode;
+}
+
+/**
+ * Checks whether the material is drawn in the blended pass.
+ * 
+ * @return True if the material blends with the scene behind it, false otherwise.
+ */
+bool ENG_API Material::is_blended() const {
+	return this->blend_mode != BlendMode::Opaque;
+}
+
 /**
  * Sets the texture of the material.
  * 
@@ -91,6 +143,15 @@ void ENG_API Material::set_texture(const std::shared_ptr<Texture> texture) {
 	this->texture = texture;
 }
 
+/**
+ * Retrieves the texture of the material.
+ * 
+ * @return A shared pointer to the texture, or nullptr if the material is not textured.
+ */
+const std::shared_ptr<Texture> ENG_API &Material::get_texture() const {
+	return this->texture;
+}
+
 /**
  * Renders the material using the provided world transformation matrix.
  * This method sets the OpenGL material properties and binds the texture if available.
@@ -101,10 +162,17 @@ void ENG_API Material::set_texture(const std::shared_ptr<Texture> texture) {
  */
 void ENG_API Material::render(const glm::mat4 world_matrix) const {
     glDisable(GL_TEXTURE_2D);
+	// The lit vertex alpha comes from the diffuse alpha
+	const float alpha = this->is_blended() ? this->transparency : 1.0f;
 	glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION,  glm::value_ptr(glm::vec4(this->emission_color, 1.0f)));
 	glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT,   glm::value_ptr(glm::vec4(this->ambient_color, 1.0f)));
-	glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,   glm::value_ptr(glm::vec4(this->diffuse_color, 1.0f)));
+	glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,   glm::value_ptr(glm::vec4(this->diffuse_color, alpha)));
 	glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,  glm::value_ptr(glm::vec4(this->specular_color, 1.0f)));
+	if (this->blend_mode == BlendMode::Alpha) {
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	} else if (this->blend_mode == BlendMode::Additive) {
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	}
 	glMaterialf (GL_FRONT_AND_BACK, GL_SHININESS, this->shininess);
 	if (this->texture != nullptr) {
 		this->texture->render(world_matrix);
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 #include <glm/glm.hpp>
@@ -19,6 +20,15 @@
 
 namespace lrvg {
 
+/**
+ * @brief Blending of a material with what is already on screen.
+ */
+enum class BlendMode : uint8_t {
+	Opaque,
+	Alpha,
+	Additive
+};
+
 /**
  * @brief Material object class.
  */
@@ -30,7 +40,13 @@ public:
 	void set_diffuse_color(const glm::vec3 color);
 	void set_specular_color(const glm::vec3 color);
 	void set_shininess(const float shininess);
+	void set_transparency(const float transparency);
+	void set_blend_mode(const BlendMode blend_mode);
+	float get_transparency() const;
+	BlendMode get_blend_mode() const;
+	bool is_blended() const;
 	void set_texture(const std::shared_ptr<Texture> texture);
+	const std::shared_ptr<Texture> &get_texture() const;
     void render(const glm::mat4 world_matrix) const override;
 private:
 	glm::vec3 emission_color;
@@ -38,6 +54,8 @@ private:
 	glm::vec3 diffuse_color;
 	glm::vec3 specular_color;
 	float shininess;
+	float transparency;
+	BlendMode blend_mode;
 	std::shared_ptr<Texture> texture;
 };
 
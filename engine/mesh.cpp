@@ -9,8 +9,12 @@
 
 #include "mesh.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <span>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <glad/gl.h>
@@ -18,15 +22,98 @@
 
 #include "common.h"
 #include "glm/gtc/type_ptr.hpp"
+#include "lazy_mesh_loader.h"
 
 using namespace lrvg;
 
+/**
+ * Creates a new, empty geometry with a single level of detail.
+ */
+ENG_API MeshGeometry::MeshGeometry() : lods(1), bounds_min{ 0.0f }, bounds_max{ 0.0f } {
+	this->lods[0].screen_size = std::numeric_limits<float>::infinity();
+}
+
+/**
+ * Creates a new geometry from its full-resolution level of detail.
+ *
+ * @param lod The level of detail 0.
+ */
+ENG_API MeshGeometry::MeshGeometry(MeshLOD &&lod) : MeshGeometry() {
+	this->lods[0] = std::move(lod);
+	this->lods[0].screen_size = std::numeric_limits<float>::infinity();
+	this->update_lod(0);
+}
+
+/**
+ * Refreshes the data derived from a level of detail after its geometry changed: the index
+ * buffer, and for level 0 the bounds and the BVH.
+ * 
+ * @param level The level of detail that changed.
+ */
+void ENG_API MeshGeometry::update_lod(const size_t level) {
+	MeshLOD &lod = this->lods[level];
+	lod.indices.assign(lod.faces, lod.vertices.size());
+	if (level > 0) return;
+	this->bvh = nullptr;
+	if (lod.vertices.empty()) {
+		this->bounds_min = glm::vec3(0.0f);
+		this->bounds_max = glm::vec3(0.0f);
+		return;
+	}
+	this->bounds_min = lod.vertices[0];
+	this->bounds_max = lod.vertices[0];
+	for (const auto &vertex : lod.vertices) {
+		this->bounds_min = glm::min(this->bounds_min, vertex);
+		this->bounds_max = glm::max(this->bounds_max, vertex);
+	}
+}
+
 /**
  * Creates a new instance of Mesh with default values.
+ * The mesh starts with the shared empty geometry, so that meshes whose geometry is set right
+ * away never allocate one of their own.
  */
-ENG_API Mesh::Mesh() {
+ENG_API Mesh::Mesh() : lod_level{ 0 }, cluster_culling{ false }, geometry_owned{ false }, lazy_loader{ nullptr } {
+	static const std::shared_ptr<const MeshGeometry> empty = std::make_shared<const MeshGeometry>();
+	this->geometry = empty;
 	this->set_material(std::make_shared<Material>());
 	this->set_cast_shadows(true);
+	this->set_occluder(false);
+}
+
+/**
+ * Destroys the mesh.
+ * A mesh whose geometry was still pending is removed from its lazy loader, releasing its decoder.
+ */
+ENG_API Mesh::~Mesh() {
+	if (this->lazy_loader != nullptr) {
+		this->lazy_loader->remove(*this);
+	}
+}
+
+/**
+ * Makes the mesh use a geometry, possibly shared with other meshes.
+ * The geometry is never modified through the mesh: setting mesh data or levels of detail
+ * afterwards gives the mesh a copy of its own first.
+ *
+ * NOTE: A value of `nullptr` causes undefined behavior.
+ * 
+ * @param geometry A shared pointer to the geometry.
+ */
+void ENG_API Mesh::set_geometry(const std::shared_ptr<const MeshGeometry> geometry) {
+	this->geometry = geometry;
+	this->geometry_owned = false;
+	this->lod_level = std::min(this->lod_level, geometry->lods.size() - 1);
+	this->cluster_culling = false;
+}
+
+/**
+ * Retrieves the geometry of the mesh, to share it with other meshes.
+ * 
+ * @return A shared pointer to the geometry.
+ */
+std::shared_ptr<const MeshGeometry> ENG_API Mesh::get_geometry() const {
+	return this->geometry;
 }
 
 /**
@@ -45,12 +132,14 @@ void ENG_API Mesh::set_material(const std::shared_ptr<Material> material) {
  * 
  * @return A shared pointer to the current Material.
  */
-std::shared_ptr<Material> ENG_API Mesh::get_material() const {
+const std::shared_ptr<Material> ENG_API &Mesh::get_material() const {
 	return this->material;
 }
 
 /**
  * Sets the mesh data including vertices, faces, normals, and texture coordinates (UVs).
+ * The data becomes level of detail 0; coarser levels previously added are discarded.
+ * The vectors are copied once into the mesh; pass them as rvalues to move them in instead.
  *
  * NOTE: Incorrectly sized vectors cause undefined behavior.
  * 
@@ -60,15 +149,290 @@ std::shared_ptr<Material> ENG_API Mesh::get_material() const {
  * @param uvs A vector of glm::vec2 representing the texture coordinates for each vertex.
  */
 void ENG_API Mesh::set_mesh_data(
-	const std::vector<glm::vec3> vertices,
-	const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces,
-	const std::vector<glm::vec3> normals,
-	const std::vector<glm::vec2> uvs
+	const std::vector<glm::vec3> &vertices,
+	const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces,
+	const std::vector<glm::vec3> &normals,
+	const std::vector<glm::vec2> &uvs
+) {
+	this->set_mesh_data(
+		std::span<const glm::vec3>(vertices),
+		std::span<const std::tuple<uint32_t, uint32_t, uint32_t>>(faces),
+		std::span<const glm::vec3>(normals),
+		std::span<const glm::vec2>(uvs)
+	);
+}
+
+/**
+ * Sets the mesh data including vertices, faces, normals, and texture coordinates (UVs), taking
+ * ownership of the vectors without copying them.
+ * The data becomes level of detail 0; coarser levels previously added are discarded.
+ *
+ * NOTE: Incorrectly sized vectors cause undefined behavior.
+ * 
+ * @param vertices A vector of glm::vec3 representing the vertex positions.
+ * @param faces A vector of tuples, each containing three uint32_t indices defining a triangular face.
+ * @param normals A vector of glm::vec3 representing the normal vectors for each vertex.
+ * @param uvs A vector of glm::vec2 representing the texture coordinates for each vertex.
+ */
+void ENG_API Mesh::set_mesh_data(
+	std::vector<glm::vec3> &&vertices,
+	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &&faces,
+	std::vector<glm::vec3> &&normals,
+	std::vector<glm::vec2> &&uvs
+) {
+	MeshGeometry &geometry = this->reset_geometry();
+	MeshLOD &lod = geometry.lods[0];
+	lod.vertices = std::move(vertices);
+	lod.faces = std::move(faces);
+	lod.normals = std::move(normals);
+	lod.uvs = std::move(uvs);
+	geometry.update_lod(0);
+}
+
+/**
+ * Sets the mesh data including vertices, faces, normals, and texture coordinates (UVs), copying
+ * them straight from memory owned by the caller, such as a file mapping.
+ * The data becomes level of detail 0; coarser levels previously added are discarded.
+ *
+ * NOTE: Incorrectly sized spans cause undefined behavior.
+ * 
+ * @param vertices The vertex positions.
+ * @param faces The triangular faces, each made of three vertex indices.
+ * @param normals The normal vectors for each vertex.
+ * @param uvs The texture coordinates for each vertex.
+ */
+void ENG_API Mesh::set_mesh_data(
+	const std::span<const glm::vec3> vertices,
+	const std::span<const std::tuple<uint32_t, uint32_t, uint32_t>> faces,
+	const std::span<const glm::vec3> normals,
+	const std::span<const glm::vec2> uvs
+) {
+	MeshGeometry &geometry = this->reset_geometry();
+	MeshLOD &lod = geometry.lods[0];
+	lod.vertices.assign(vertices.begin(), vertices.end());
+	lod.faces.assign(faces.begin(), faces.end());
+	lod.normals.assign(normals.begin(), normals.end());
+	lod.uvs.assign(uvs.begin(), uvs.end());
+	geometry.update_lod(0);
+}
+
+/**
+ * Appends a coarser level of detail to the mesh.
+ * The level is drawn when the mesh covers less than `screen_size` of the viewport height;
+ * a `screen_size` of 0 picks a default that halves at every level (0.25, 0.125, ...).
+ * The vectors are copied once into the mesh; pass them as rvalues to move them in instead.
+ *
+ * NOTE: Incorrectly sized vectors cause undefined behavior.
+ * 
+ * @param vertices A vector of glm::vec3 representing the vertex positions.
+ * @param faces A vector of tuples, each containing three uint32_t indices defining a triangular face.
+ * @param normals A vector of glm::vec3 representing the normal vectors for each vertex.
+ * @param uvs A vector of glm::vec2 representing the texture coordinates for each vertex.
+ * @param screen_size The fraction of the viewport height below which the level is used.
+ */
+void ENG_API Mesh::add_lod(
+	const std::vector<glm::vec3> &vertices,
+	const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces,
+	const std::vector<glm::vec3> &normals,
+	const std::vector<glm::vec2> &uvs,
+	const float screen_size
+) {
+	this->add_lod(
+		std::vector<glm::vec3>(vertices),
+		std::vector<std::tuple<uint32_t, uint32_t, uint32_t>>(faces),
+		std::vector<glm::vec3>(normals),
+		std::vector<glm::vec2>(uvs),
+		screen_size
+	);
+}
+
+/**
+ * Appends a coarser level of detail to the mesh, taking ownership of the vectors without copying them.
+ * The level is drawn when the mesh covers less than `screen_size` of the viewport height;
+ * a `screen_size` of 0 picks a default that halves at every level (0.25, 0.125, ...).
+ *
+ * NOTE: Incorrectly sized vectors cause undefined behavior.
+ * 
+ * @param vertices A vector of glm::vec3 representing the vertex positions.
+ * @param faces A vector of tuples, each containing three uint32_t indices defining a triangular face.
+ * @param normals A vector of glm::vec3 representing the normal vectors for each vertex.
+ * @param uvs A vector of glm::vec2 representing the texture coordinates for each vertex.
+ * @param screen_size The fraction of the viewport height below which the level is used.
+ */
+void ENG_API Mesh::add_lod(
+	std::vector<glm::vec3> &&vertices,
+	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &&faces,
+	std::vector<glm::vec3> &&normals,
+	std::vector<glm::vec2> &&uvs,
+	const float screen_size
 ) {
-	this->vertices = vertices;
-	this->faces = faces;
-	this->normals = normals;
-	this->uvs = uvs;
+	MeshGeometry &geometry = this->edit_geometry();
+	MeshLOD lod;
+	lod.vertices = std::move(vertices);
+	lod.faces = std::move(faces);
+	lod.normals = std::move(normals);
+	lod.uvs = std::move(uvs);
+	lod.screen_size = screen_size > 0.0f ? screen_size : 0.5f / (float)(1u << std::min<size_t>(geometry.lods.size(), 31));
+	geometry.lods.push_back(std::move(lod));
+	geometry.update_lod(geometry.lods.size() - 1);
+}
+
+/**
+ * Replaces the geometry of an existing level of detail, keeping its screen size threshold.
+ * Meant for processing stages that rewrite a level in place, such as the mesh optimizer.
+ * The meshlets of `lod` are kept as they are, so they must match its faces.
+ *
+ * NOTE: Incorrectly sized vectors cause undefined behavior.
+ * 
+ * @param level The level of detail to replace, from 0 to `get_lod_count() - 1`.
+ * @param lod The new geometry of the level.
+ */
+void ENG_API Mesh::set_lod(const size_t level, MeshLOD lod) {
+	if (UNLIKELY(level >= this->geometry->lods.size())) {
+		WARN("invalid level of detail %zu", level);
+		return;
+	}
+	MeshGeometry &geometry = this->edit_geometry();
+	lod.screen_size = geometry.lods[level].screen_size;
+	geometry.lods[level] = std::move(lod);
+	geometry.update_lod(level);
+	if (level == this->lod_level) this->cluster_culling = false;
+}
+
+/**
+ * Moves the geometry of a level of detail out of the mesh, leaving the level empty until it is
+ * set again with `set_lod`. Lets processing stages rewrite a level without copying it.
+ * A level of a shared geometry is copied instead, leaving the other meshes unaffected.
+ * 
+ * @param level The level of detail to take, from 0 to `get_lod_count() - 1`.
+ * @return The geometry of the level.
+ */
+MeshLOD ENG_API Mesh::take_lod(const size_t level) {
+	if (UNLIKELY(level >= this->geometry->lods.size())) {
+		WARN("invalid level of detail %zu", level);
+		return MeshLOD();
+	}
+	// A shared geometry is left untouched, so the level is copied out of it instead
+	if (!this->geometry_owned || this->geometry.use_count() > 1) {
+		return this->geometry->lods[level];
+	}
+	MeshGeometry &geometry = this->edit_geometry();
+	MeshLOD lod = std::move(geometry.lods[level]);
+	geometry.lods[level] = MeshLOD();
+	geometry.lods[level].screen_size = lod.screen_size;
+	geometry.update_lod(level);
+	if (level == this->lod_level) this->cluster_culling = false;
+	return lod;
+}
+
+/**
+ * Sets the meshlets of a level of detail, as built by MeshletBuilder.
+ * An empty list removes the meshlets, so that the level is always drawn whole.
+ * 
+ * @param level The level of detail, from 0 to `get_lod_count() - 1`.
+ * @param meshlets The meshlets, covering the faces of the level.
+ */
+void ENG_API Mesh::set_meshlets(const size_t level, std::vector<Meshlet> meshlets) {
+	if (UNLIKELY(level >= this->geometry->lods.size())) {
+		WARN("invalid level of detail %zu", level);
+		return;
+	}
+	this->edit_geometry().lods[level].meshlets = std::move(meshlets);
+	if (level == this->lod_level) this->cluster_culling = false;
+}
+
+/**
+ * Restricts the drawing of the current level of detail to the given face ranges, and enables cluster culling.
+ * This method is called automatically by the engine's meshlet culler, every frame.
+ * 
+ * @param ranges The ranges of faces of the current level to draw.
+ */
+void ENG_API Mesh::set_visible_ranges(const std::vector<FaceRange> &ranges) {
+	this->visible_ranges = ranges;
+	this->cluster_culling = true;
+}
+
+/**
+ * Enables or disables cluster culling. When disabled, the current level of detail is drawn whole;
+ * enabling it again draws the ranges last set, which must still match the current level.
+ * 
+ * @param cluster_culling Whether only the visible ranges are drawn.
+ */
+void ENG_API Mesh::set_cluster_culling(const bool cluster_culling) {
+	this->cluster_culling = cluster_culling;
+}
+
+/**
+ * Checks whether only the visible face ranges of the current level of detail are drawn.
+ * 
+ * @return True if cluster culling is applied, false if the level is drawn whole.
+ */
+bool ENG_API Mesh::get_cluster_culling() const {
+	return this->cluster_culling;
+}
+
+/**
+ * Retrieves the face ranges drawn when cluster culling is applied.
+ * 
+ * @return A constant reference to the visible ranges of the current level of detail.
+ */
+const std::vector<FaceRange> ENG_API &Mesh::get_visible_ranges() const {
+	return this->visible_ranges;
+}
+
+/**
+ * Sets the fraction of the viewport height below which a level of detail is used.
+ * Thresholds should decrease along the chain; level 0 has no threshold.
+ * 
+ * @param level The level of detail to tune, from 1 to `get_lod_count() - 1`.
+ * @param screen_size The fraction of the viewport height below which the level is used.
+ */
+void ENG_API Mesh::set_lod_screen_size(const size_t level, const float screen_size) {
+	if (UNLIKELY(level == 0 || level >= this->geometry->lods.size())) {
+		WARN("invalid level of detail %zu", level);
+		return;
+	}
+	this->edit_geometry().lods[level].screen_size = screen_size;
+}
+
+/**
+ * Selects the level of detail drawn by the next renders.
+ * This method is called automatically by the engine, from the screen size of the mesh.
+ * 
+ * @param level The level of detail to draw, clamped to the available levels.
+ */
+void ENG_API Mesh::set_lod_level(const size_t level) {
+	const size_t clamped = std::min(level, this->geometry->lods.size() - 1);
+	if (clamped != this->lod_level) this->cluster_culling = false;
+	this->lod_level = clamped;
+}
+
+/**
+ * Retrieves the number of levels of detail of the mesh, including the full-resolution one.
+ * 
+ * @return The number of levels of detail.
+ */
+size_t ENG_API Mesh::get_lod_count() const {
+	return this->geometry->lods.size();
+}
+
+/**
+ * Retrieves a level of detail of the mesh.
+ * 
+ * @param level The level of detail, 0 being the full-resolution one.
+ * @return A constant reference to the level of detail.
+ */
+const MeshLOD ENG_API &Mesh::get_lod(const size_t level) const {
+	return this->geometry->lods[level];
+}
+
+/**
+ * Retrieves the level of detail currently drawn.
+ * 
+ * @return The current level of detail.
+ */
+size_t ENG_API Mesh::get_lod_level() const {
+	return this->lod_level;
 }
 
 /**
@@ -89,10 +453,112 @@ bool ENG_API Mesh::get_cast_shadows() const {
 	return this->cast_shadows;
 }
 
+/**
+ * Sets whether the mesh is used as an occluder by the CPU occlusion culling stage.
+ * Occluders should be large, mostly closed meshes (walls, floors, big props) with a modest triangle count.
+ * 
+ * @param occluder A boolean indicating if the mesh should be rasterized as an occluder.
+ */
+void ENG_API Mesh::set_occluder(const bool occluder) {
+	this->occluder = occluder;
+}
+
+/**
+ * Checks if the mesh is used as an occluder by the CPU occlusion culling stage.
+ * 
+ * @return A boolean indicating if the mesh is an occluder.
+ */
+bool ENG_API Mesh::get_occluder() const {
+	return this->occluder;
+}
+
+/**
+ * Retrieves the minimum corner of the mesh's local-space axis-aligned bounding box.
+ * The bounding box is recomputed every time the mesh data is set.
+ * 
+ * @return A glm::vec3 representing the minimum corner of the bounding box.
+ */
+glm::vec3 ENG_API Mesh::get_bounds_min() const {
+	return this->geometry->bounds_min;
+}
+
+/**
+ * Retrieves the maximum corner of the mesh's local-space axis-aligned bounding box.
+ * The bounding box is recomputed every time the mesh data is set.
+ * 
+ * @return A glm::vec3 representing the maximum corner of the bounding box.
+ */
+glm::vec3 ENG_API Mesh::get_bounds_max() const {
+	return this->geometry->bounds_max;
+}
+
+/**
+ * Retrieves the vertex positions of the mesh, at full resolution.
+ * 
+ * @return A constant reference to the vertex positions.
+ */
+const std::vector<glm::vec3> ENG_API &Mesh::get_vertices() const {
+	return this->geometry->lods[0].vertices;
+}
+
+/**
+ * Retrieves the triangular faces of the mesh, at full resolution.
+ * 
+ * @return A constant reference to the faces, each made of three vertex indices.
+ */
+const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> ENG_API &Mesh::get_faces() const {
+	return this->geometry->lods[0].faces;
+}
+
+/**
+ * Retrieves the bounding volume hierarchy of the mesh, used for ray queries.
+ * The hierarchy is built on first use and discarded whenever the mesh data changes.
+ * 
+ * @return A shared pointer to the bounding volume hierarchy.
+ */
+std::shared_ptr<const MeshBVH> ENG_API Mesh::get_bvh() const {
+	const MeshGeometry &geometry = *this->geometry;
+	if (geometry.bvh == nullptr) {
+		geometry.bvh = std::make_shared<const MeshBVH>(geometry.lods[0].vertices, geometry.lods[0].faces);
+	}
+	return geometry.bvh;
+}
+
+/**
+ * Retrieves the geometry of the mesh for modification, copying it first if it is shared.
+ * 
+ * @return A reference to the geometry, owned by this mesh only.
+ */
+MeshGeometry &Mesh::edit_geometry() {
+	if (!this->geometry_owned || this->geometry.use_count() > 1) {
+		std::shared_ptr<MeshGeometry> copy = std::make_shared<MeshGeometry>(*this->geometry);
+		this->geometry = copy;
+		this->geometry_owned = true;
+		return *copy;
+	}
+	// Owned geometries are always created non-const, by this method or by reset_geometry
+	return const_cast<MeshGeometry &>(*this->geometry);
+}
+
+/**
+ * Replaces the geometry of the mesh with a new, empty one owned by this mesh only.
+ * 
+ * @return A reference to the new geometry.
+ */
+MeshGeometry &Mesh::reset_geometry() {
+	std::shared_ptr<MeshGeometry> geometry = std::make_shared<MeshGeometry>();
+	this->geometry = geometry;
+	this->geometry_owned = true;
+	this->lod_level = 0;
+	this->cluster_culling = false;
+	return *geometry;
+}
+
 /**
  * Renders the mesh using OpenGL.
- * This method applies the material and iterates over each face to draw the triangles.
- * It uses the vertex positions, normals, and texture coordinates defined in the mesh data.
+ * This method applies the material and draws the index buffer of the current level of detail
+ * from its vertex positions, normals, and texture coordinates, in a single call, or in one call
+ * per visible range when cluster culling is applied.
  *
  * This method is called automatically during the rendering process.
  * 
@@ -101,26 +567,31 @@ bool ENG_API Mesh::get_cast_shadows() const {
 void ENG_API Mesh::render(const glm::mat4 world_matrix) const {
     Node::render(world_matrix);
     this->material->render(world_matrix);
-    for (const auto& face : this->faces) {
-        glBegin(GL_TRIANGLES);
-        const glm::vec3 vertex_0 = this->vertices[std::get<0>(face)];
-        const glm::vec3 vertex_1 = this->vertices[std::get<1>(face)];
-        const glm::vec3 vertex_2 = this->vertices[std::get<2>(face)];
-        const glm::vec3 normal_0 = this->normals[std::get<0>(face)];
-        const glm::vec3 normal_1 = this->normals[std::get<1>(face)];
-        const glm::vec3 normal_2 = this->normals[std::get<2>(face)];
-        const glm::vec2 uv_0 = this->uvs[std::get<0>(face)];
-        const glm::vec2 uv_1 = this->uvs[std::get<1>(face)];
-        const glm::vec2 uv_2 = this->uvs[std::get<2>(face)];
-        glTexCoord2f(uv_0.x, uv_0.y);
-        glNormal3f(normal_0.x, normal_0.y, normal_0.z);
-        glVertex3f(vertex_0.x, vertex_0.y, vertex_0.z);
-        glTexCoord2f(uv_1.x, uv_1.y);
-        glNormal3f(normal_1.x, normal_1.y, normal_1.z);
-        glVertex3f(vertex_1.x, vertex_1.y, vertex_1.z);
-        glTexCoord2f(uv_2.x, uv_2.y);
-        glNormal3f(normal_2.x, normal_2.y, normal_2.z);
-        glVertex3f(vertex_2.x, vertex_2.y, vertex_2.z);
-        glEnd();
+    const MeshLOD &lod = this->geometry->lods[this->lod_level];
+    if (lod.indices.empty()) return;
+    const bool has_normals = lod.normals.size() == lod.vertices.size();
+    const bool has_uvs = lod.uvs.size() == lod.vertices.size();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, lod.vertices.data());
+    if (has_normals) {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, 0, lod.normals.data());
+    }
+    if (has_uvs) {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, 0, lod.uvs.data());
+    }
+    const GLenum type = lod.indices.is_narrow() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    if (this->cluster_culling) {
+        const size_t face_bytes = 3 * (lod.indices.is_narrow() ? sizeof(uint16_t) : sizeof(uint32_t));
+        for (const FaceRange &range : this->visible_ranges) {
+            const char *first = static_cast<const char *>(lod.indices.data()) + range.offset * face_bytes;
+            glDrawRangeElements(GL_TRIANGLES, 0, lod.indices.get_max_index(), (GLsizei)(3 * range.count), type, first);
+        }
+    } else {
+        glDrawRangeElements(GL_TRIANGLES, 0, lod.indices.get_max_index(), (GLsizei)lod.indices.size(), type, lod.indices.data());
     }
+    if (has_uvs) glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    if (has_normals) glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -10,38 +10,133 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <tuple>
+#include <vector>
 
+#include <glm/glm.hpp>
+
+#include "bvh.h"
 #include "common.h"
+#include "index_buffer.h"
 #include "material.h"
+#include "meshlet.h"
 #include "node.h"
 
 namespace lrvg {
 
+class LazyMeshLoader;
+
+/**
+ * @brief One level of detail of a mesh.
+ * Faces are kept for processing and queries, while the mesh draws from `indices`, which it
+ * rebuilds whenever the level is set. Large levels may also be split into meshlets, each
+ * covering a contiguous range of faces.
+ */
+struct ENG_API MeshLOD {
+	std::vector<glm::vec3> vertices;
+	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> uvs;
+	IndexBuffer indices;
+	std::vector<Meshlet> meshlets;
+	float screen_size;
+};
+
+/**
+ * @brief Geometry of a mesh: its chain of levels of detail, and the data derived from level 0.
+ * A geometry may be shared by several meshes, such as instances of the same primitive; meshes
+ * copy a shared geometry before modifying it.
+ */
+struct ENG_API MeshGeometry {
+	std::vector<MeshLOD> lods;
+	glm::vec3 bounds_min;
+	glm::vec3 bounds_max;
+	mutable std::shared_ptr<const MeshBVH> bvh;
+	MeshGeometry();
+	explicit MeshGeometry(MeshLOD &&lod);
+	void update_lod(const size_t level);
+};
+
 /**
  * @brief A mesh represents a shape renderable in the scene.
+ * A mesh holds a chain of levels of detail, from the full-resolution level 0 to the coarsest one.
  */
 class ENG_API Mesh : public Node {
 public:
 	Mesh();
-    std::shared_ptr<Material> get_material() const;
+	~Mesh();
+    const std::shared_ptr<Material> &get_material() const;
     bool get_cast_shadows() const;
+	bool get_occluder() const;
+	glm::vec3 get_bounds_min() const;
+	glm::vec3 get_bounds_max() const;
+	const std::vector<glm::vec3> &get_vertices() const;
+	const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &get_faces() const;
+	std::shared_ptr<const MeshBVH> get_bvh() const;
+	std::shared_ptr<const MeshGeometry> get_geometry() const;
+	size_t get_lod_count() const;
+	const MeshLOD &get_lod(const size_t level) const;
+	size_t get_lod_level() const;
+	bool get_cluster_culling() const;
+	const std::vector<FaceRange> &get_visible_ranges() const;
 	void set_material(const std::shared_ptr<Material> material);
+	void set_geometry(const std::shared_ptr<const MeshGeometry> geometry);
 	void set_cast_shadows(const bool cast_shadows);
+	void set_occluder(const bool occluder);
+	void set_lod_level(const size_t level);
+	void set_lod_screen_size(const size_t level, const float screen_size);
+	void set_lod(const size_t level, MeshLOD lod);
+	MeshLOD take_lod(const size_t level);
+	void set_meshlets(const size_t level, std::vector<Meshlet> meshlets);
+	void set_visible_ranges(const std::vector<FaceRange> &ranges);
+	void set_cluster_culling(const bool cluster_culling);
+	void set_mesh_data(
+		const std::vector<glm::vec3> &vertices,
+		const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces,
+		const std::vector<glm::vec3> &normals,
+		const std::vector<glm::vec2> &uvs
+	);
+	void set_mesh_data(
+		std::vector<glm::vec3> &&vertices,
+		std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &&faces,
+		std::vector<glm::vec3> &&normals,
+		std::vector<glm::vec2> &&uvs
+	);
 	void set_mesh_data(
-		const std::vector<glm::vec3> vertices,
-		const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces,
-		const std::vector<glm::vec3> normals,
-		const std::vector<glm::vec2> uvs
+		const std::span<const glm::vec3> vertices,
+		const std::span<const std::tuple<uint32_t, uint32_t, uint32_t>> faces,
+		const std::span<const glm::vec3> normals,
+		const std::span<const glm::vec2> uvs
+	);
+	void add_lod(
+		const std::vector<glm::vec3> &vertices,
+		const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces,
+		const std::vector<glm::vec3> &normals,
+		const std::vector<glm::vec2> &uvs,
+		const float screen_size = 0.0f
+	);
+	void add_lod(
+		std::vector<glm::vec3> &&vertices,
+		std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &&faces,
+		std::vector<glm::vec3> &&normals,
+		std::vector<glm::vec2> &&uvs,
+		const float screen_size = 0.0f
 	);
     void render(const glm::mat4 world_matrix) const override;
 private:
+	friend class LazyMeshLoader;
+	MeshGeometry &edit_geometry();
+	MeshGeometry &reset_geometry();
 	std::shared_ptr<Material> material;
-	std::vector<glm::vec3> vertices;
-	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
-	std::vector<glm::vec3> normals;
-	std::vector<glm::vec2> uvs;
+	std::shared_ptr<const MeshGeometry> geometry;
+	size_t lod_level;
+	std::vector<FaceRange> visible_ranges;
+	bool cluster_culling;
+	bool geometry_owned;
 	bool cast_shadows;
+	bool occluder;
+	LazyMeshLoader *lazy_loader;
 };
 
 }
@@ -0,0 +1,175 @@
+/**
+ * @file	mesh_builder.cpp
+ * @brief	Mesh builder class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "mesh_builder.h"
+
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new mesh builder with room for the given number of vertices and faces.
+ *
+ * @param vertex_count The expected number of vertices.
+ * @param face_count The expected number of faces.
+ */
+ENG_API MeshBuilder::MeshBuilder(const size_t vertex_count, const size_t face_count) {
+	this->reserve(vertex_count, face_count);
+}
+
+/**
+ * Reserves room for vertices and faces appended with `add_vertex` and `add_face`.
+ *
+ * @param vertex_count The expected number of vertices.
+ * @param face_count The expected number of faces.
+ */
+void ENG_API MeshBuilder::reserve(const size_t vertex_count, const size_t face_count) {
+	this->vertices.reserve(vertex_count);
+	this->normals.reserve(vertex_count);
+	this->uvs.reserve(vertex_count);
+	this->faces.reserve(face_count);
+}
+
+/**
+ * Sets the number of vertices and faces, to be written through the spans returned by the getters.
+ *
+ * @param vertex_count The number of vertices.
+ * @param face_count The number of faces.
+ */
+void ENG_API MeshBuilder::resize(const size_t vertex_count, const size_t face_count) {
+	this->vertices.resize(vertex_count);
+	this->normals.resize(vertex_count);
+	this->uvs.resize(vertex_count);
+	this->faces.resize(face_count);
+}
+
+/**
+ * Appends a vertex.
+ *
+ * @param position The position of the vertex.
+ * @param normal The normal vector of the vertex.
+ * @param uv The texture coordinates of the vertex.
+ * @return The index of the new vertex.
+ */
+uint32_t ENG_API MeshBuilder::add_vertex(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &uv) {
+	this->vertices.push_back(position);
+	this->normals.push_back(normal);
+	this->uvs.push_back(uv);
+	return (uint32_t)(this->vertices.size() - 1);
+}
+
+/**
+ * Appends a triangular face.
+ *
+ * @param a The index of the first vertex.
+ * @param b The index of the second vertex.
+ * @param c The index of the third vertex.
+ */
+void ENG_API MeshBuilder::add_face(const uint32_t a, const uint32_t b, const uint32_t c) {
+	this->faces.emplace_back(a, b, c);
+}
+
+/**
+ * Retrieves the number of vertices written so far.
+ *
+ * @return The number of vertices.
+ */
+size_t ENG_API MeshBuilder::get_vertex_count() const {
+	return this->vertices.size();
+}
+
+/**
+ * Retrieves the number of faces written so far.
+ *
+ * @return The number of faces.
+ */
+size_t ENG_API MeshBuilder::get_face_count() const {
+	return this->faces.size();
+}
+
+/**
+ * Retrieves the vertex positions, to be written in place.
+ *
+ * @return A span over the vertex positions.
+ */
+std::span<glm::vec3> ENG_API MeshBuilder::get_vertices() {
+	return this->vertices;
+}
+
+/**
+ * Retrieves the vertex normals, to be written in place.
+ *
+ * @return A span over the vertex normals.
+ */
+std::span<glm::vec3> ENG_API MeshBuilder::get_normals() {
+	return this->normals;
+}
+
+/**
+ * Retrieves the vertex texture coordinates, to be written in place.
+ *
+ * @return A span over the texture coordinates.
+ */
+std::span<glm::vec2> ENG_API MeshBuilder::get_uvs() {
+	return this->uvs;
+}
+
+/**
+ * Retrieves the faces, to be written in place.
+ *
+ * @return A span over the faces.
+ */
+std::span<std::tuple<uint32_t, uint32_t, uint32_t>> ENG_API MeshBuilder::get_faces() {
+	return this->faces;
+}
+
+/**
+ * Moves the data into a mesh as its level of detail 0, discarding its other levels.
+ * The builder is left empty and can be reused.
+ *
+ * @param mesh The mesh receiving the data.
+ */
+void ENG_API MeshBuilder::build(Mesh &mesh) {
+	mesh.set_mesh_data(std::move(this->vertices), std::move(this->faces), std::move(this->normals), std::move(this->uvs));
+	*this = MeshBuilder();
+}
+
+/**
+ * Moves the data into a standalone level of detail, for instance to build a shared geometry.
+ * The builder is left empty and can be reused.
+ *
+ * @return The level of detail holding the data.
+ */
+MeshLOD ENG_API MeshBuilder::build() {
+	MeshLOD lod;
+	lod.vertices = std::move(this->vertices);
+	lod.faces = std::move(this->faces);
+	lod.normals = std::move(this->normals);
+	lod.uvs = std::move(this->uvs);
+	lod.screen_size = 0.0f;
+	*this = MeshBuilder();
+	return lod;
+}
+
+/**
+ * Moves the data into a mesh as a new, coarser level of detail.
+ * The builder is left empty and can be reused.
+ *
+ * @param mesh The mesh receiving the data.
+ * @param screen_size The fraction of the viewport height below which the level is used, or 0 for the default.
+ */
+void ENG_API MeshBuilder::build_lod(Mesh &mesh, const float screen_size) {
+	mesh.add_lod(std::move(this->vertices), std::move(this->faces), std::move(this->normals), std::move(this->uvs), screen_size);
+	*this = MeshBuilder();
+}
@@ -0,0 +1,54 @@
+/**
+ * @file	mesh_builder.h
+ * @brief	Mesh builder class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Writes mesh data in place, then hands it over to a mesh without copying it.
+ * Vertices and faces are either appended one by one, or written through the spans returned
+ * after a `resize`, which is how decoders fill the arrays from a file.
+ */
+class ENG_API MeshBuilder final {
+public:
+	MeshBuilder() = default;
+	MeshBuilder(const size_t vertex_count, const size_t face_count);
+	void reserve(const size_t vertex_count, const size_t face_count);
+	void resize(const size_t vertex_count, const size_t face_count);
+	uint32_t add_vertex(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &uv);
+	void add_face(const uint32_t a, const uint32_t b, const uint32_t c);
+	size_t get_vertex_count() const;
+	size_t get_face_count() const;
+	std::span<glm::vec3> get_vertices();
+	std::span<glm::vec3> get_normals();
+	std::span<glm::vec2> get_uvs();
+	std::span<std::tuple<uint32_t, uint32_t, uint32_t>> get_faces();
+	void build(Mesh &mesh);
+	MeshLOD build();
+	void build_lod(Mesh &mesh, const float screen_size = 0.0f);
+private:
+	std::vector<glm::vec3> vertices;
+	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> uvs;
+};
+
+}
@@ -0,0 +1,451 @@
+/**
+ * @file	mesh_optimizer.cpp
+ * @brief	Mesh optimizer class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+// Clusters are never split into parts smaller than this
+static constexpr size_t MIN_CLUSTER_FACE_COUNT = 8;
+
+namespace {
+
+using Face = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+/**
+ * Position, normal and texture coordinates of a vertex, either as float bits or snapped to a grid.
+ */
+using VertexKey = std::array<uint32_t, 8>;
+
+struct VertexKeyHash {
+	size_t operator()(const VertexKey &key) const {
+		// FNV-1a over the eight words
+		uint64_t hash = 14695981039346656037ull;
+		for (const uint32_t word : key) {
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		return (size_t)(hash ^ (hash >> 32));
+	}
+};
+
+/**
+ * Vertex to face adjacency, stored as one flat array with per-vertex offsets.
+ */
+struct Adjacency {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> faces;
+	Adjacency(const std::vector<Face> &faces, const size_t vertex_count) : offsets(vertex_count + 1, 0), faces(faces.size() * 3) {
+		for (const auto &[a, b, c] : faces) {
+			this->offsets[a + 1]++;
+			this->offsets[b + 1]++;
+			this->offsets[c + 1]++;
+		}
+		for (size_t v = 0; v < vertex_count; v++) {
+			this->offsets[v + 1] += this->offsets[v];
+		}
+		std::vector<uint32_t> cursor(this->offsets.begin(), this->offsets.end() - 1);
+		for (uint32_t f = 0; f < (uint32_t)faces.size(); f++) {
+			const auto &[a, b, c] = faces[f];
+			this->faces[cursor[a]++] = f;
+			this->faces[cursor[b]++] = f;
+			this->faces[cursor[c]++] = f;
+		}
+	}
+};
+
+/**
+ * Picks the vertex to fan around next, preferring vertices that will still be in the cache
+ * once all their remaining faces have been emitted.
+ */
+int64_t get_next_vertex(
+	const std::vector<uint32_t> &candidates, const std::vector<uint32_t> &live, const std::vector<uint32_t> &cache_time,
+	const uint32_t time, const uint32_t cache_size, std::vector<uint32_t> &dead_end, size_t &cursor, bool &skipped
+) {
+	int64_t best = -1;
+	int64_t best_priority = -1;
+	for (const uint32_t v : candidates) {
+		if (live[v] == 0) continue;
+		int64_t priority = 0;
+		if (time - cache_time[v] + 2 * live[v] <= cache_size) priority = time - cache_time[v];
+		if (priority > best_priority) {
+			best = v;
+			best_priority = priority;
+		}
+	}
+	if (best >= 0) return best;
+	// Dead end: resume from a recently emitted vertex, or from the next vertex in input order
+	skipped = true;
+	while (!dead_end.empty()) {
+		const uint32_t v = dead_end.back();
+		dead_end.pop_back();
+		if (live[v] > 0) return v;
+	}
+	while (cursor < live.size()) {
+		if (live[cursor] > 0) return (int64_t)cursor;
+		cursor++;
+	}
+	return -1;
+}
+
+}
+
+/**
+ * Merges the vertices of a level of detail whose position, normal and texture coordinates are
+ * equal, and remaps the faces accordingly. Exporters often split vertices along seams and hard
+ * edges even where both sides end up with the same attributes.
+ * With a non-zero `epsilon`, attributes are snapped to a grid of that spacing before comparison,
+ * so vertices closer than `epsilon` are merged unless they straddle a grid cell boundary.
+ *
+ * @param lod The level of detail to weld, in place.
+ * @param epsilon The spacing of the comparison grid, or 0 to merge bit-identical vertices only.
+ * @return The number of vertices removed.
+ */
+size_t ENG_API MeshOptimizer::weld_vertices(MeshLOD &lod, const float epsilon) {
+	const size_t vertex_count = lod.vertices.size();
+	const bool has_normals = lod.normals.size() == vertex_count;
+	const bool has_uvs = lod.uvs.size() == vertex_count;
+	const auto to_word = [epsilon](const float value) {
+		if (epsilon > 0.0f) return (uint32_t)(int32_t)std::floor(value / epsilon + 0.5f);
+		// +0 and -0 compare equal, so they must hash equal
+		const float canonical = value == 0.0f ? 0.0f : value;
+		uint32_t bits;
+		memcpy(&bits, &canonical, sizeof(bits));
+		return bits;
+	};
+	std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique;
+	unique.reserve(vertex_count);
+	std::vector<uint32_t> remap(vertex_count);
+	uint32_t next = 0;
+	for (size_t v = 0; v < vertex_count; v++) {
+		VertexKey key{};
+		key[0] = to_word(lod.vertices[v].x);
+		key[1] = to_word(lod.vertices[v].y);
+		key[2] = to_word(lod.vertices[v].z);
+		if (has_normals) {
+			key[3] = to_word(lod.normals[v].x);
+			key[4] = to_word(lod.normals[v].y);
+			key[5] = to_word(lod.normals[v].z);
+		}
+		if (has_uvs) {
+			key[6] = to_word(lod.uvs[v].x);
+			key[7] = to_word(lod.uvs[v].y);
+		}
+		const auto [item, inserted] = unique.try_emplace(key, next);
+		remap[v] = item->second;
+		if (!inserted) continue;
+		// Kept vertices only move towards the front, so they can be compacted in place
+		lod.vertices[next] = lod.vertices[v];
+		if (has_normals) lod.normals[next] = lod.normals[v];
+		if (has_uvs) lod.uvs[next] = lod.uvs[v];
+		next++;
+	}
+	if (next == vertex_count) return 0;
+	lod.vertices.resize(next);
+	if (has_normals) lod.normals.resize(next);
+	if (has_uvs) lod.uvs.resize(next);
+	for (auto &[a, b, c] : lod.faces) {
+		a = remap[a];
+		b = remap[b];
+		c = remap[c];
+	}
+	return vertex_count - next;
+}
+
+/**
+ * Computes the average cache miss ratio of a face order, simulating a FIFO post-transform cache.
+ * The ratio is the number of vertices transformed per face: 3 means no reuse at all, while
+ * regular grids approach 0.5 with an optimal order.
+ *
+ * @param faces The faces to draw, in order.
+ * @param vertex_count The number of vertices referenced by the faces.
+ * @param cache_size The number of entries of the simulated cache.
+ * @return The average cache miss ratio, or 0 for an empty mesh.
+ */
+float ENG_API MeshOptimizer::compute_acmr(const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const size_t vertex_count, const uint32_t cache_size) {
+	if (faces.empty()) return 0.0f;
+	// A vertex is in the FIFO cache if fewer than `cache_size` vertices were loaded since its own load
+	std::vector<uint32_t> cache_time(vertex_count, 0);
+	uint32_t time = cache_size + 1;
+	size_t misses = 0;
+	for (const auto &[a, b, c] : faces) {
+		for (const uint32_t v : { a, b, c }) {
+			if (time - cache_time[v] > cache_size) {
+				cache_time[v] = time++;
+				misses++;
+			}
+		}
+	}
+	return (float)misses / (float)faces.size();
+}
+
+/**
+ * Reorders faces for the post-transform vertex cache, using Tipsify (Sander et al., 2007).
+ * Faces are emitted as fans around a vertex, moving to the neighbouring vertex that is most
+ * likely to still be cached; the order is computed in linear time.
+ *
+ * @param faces The faces to reorder, in place.
+ * @param vertex_count The number of vertices referenced by the faces.
+ * @param cache_size The number of entries of the targeted cache.
+ * @return The index of the first face of each cluster, i.e. each run of faces started after a cache flush.
+ */
+std::vector<uint32_t> ENG_API MeshOptimizer::optimize_vertex_cache(std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const size_t vertex_count, const uint32_t cache_size) {
+	std::vector<uint32_t> clusters;
+	if (faces.empty() || vertex_count == 0) return clusters;
+	const Adjacency adjacency(faces, vertex_count);
+	std::vector<uint32_t> live(vertex_count);
+	for (size_t v = 0; v < vertex_count; v++) {
+		live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+	std::vector<uint32_t> cache_time(vertex_count, 0);
+	std::vector<bool> emitted(faces.size(), false);
+	std::vector<uint32_t> dead_end;
+	std::vector<uint32_t> candidates;
+	std::vector<Face> result;
+	result.reserve(faces.size());
+	uint32_t time = cache_size + 1;
+	size_t cursor = 0;
+	bool skipped = true;
+	int64_t fan = get_next_vertex(candidates, live, cache_time, time, cache_size, dead_end, cursor, skipped);
+	while (fan >= 0) {
+		if (skipped) clusters.push_back((uint32_t)result.size());
+		skipped = false;
+		candidates.clear();
+		for (uint32_t i = adjacency.offsets[fan]; i < adjacency.offsets[fan + 1]; i++) {
+			const uint32_t f = adjacency.faces[i];
+			if (emitted[f]) continue;
+			emitted[f] = true;
+			result.push_back(faces[f]);
+			const auto &[a, b, c] = faces[f];
+			for (const uint32_t v : { a, b, c }) {
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cache_time[v] > cache_size) cache_time[v] = time++;
+			}
+		}
+		fan = get_next_vertex(candidates, live, cache_time, time, cache_size, dead_end, cursor, skipped);
+	}
+	// A cluster may have been opened right before the walk ran out of vertices
+	if (!clusters.empty() && clusters.back() == result.size()) clusters.pop_back();
+	faces = std::move(result);
+	return clusters;
+}
+
+/**
+ * Sorts the clusters of a cache-optimized face order to reduce overdraw.
+ * Clusters are first split further wherever this keeps the cache miss ratio of each part within
+ * `threshold` of the whole cluster, then drawn from the most outward-facing to the most
+ * inward-facing, so that the faces likely to occlude others are rasterized first.
+ *
+ * @param faces The faces to reorder, in place, as returned by `optimize_vertex_cache`.
+ * @param vertices The vertex positions.
+ * @param clusters The index of the first face of each cluster, as returned by `optimize_vertex_cache`.
+ * @param threshold The cache miss ratio increase allowed to split clusters, at least 1.
+ */
+void ENG_API MeshOptimizer::optimize_overdraw(std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const std::vector<glm::vec3> &vertices, const std::vector<uint32_t> &clusters, const float threshold) {
+	if (faces.empty() || clusters.empty()) return;
+	// Soft boundaries: split each cluster where the miss ratio so far is already low enough
+	std::vector<uint32_t> starts;
+	std::vector<uint32_t> cache_time(vertices.size(), 0);
+	uint32_t time = CACHE_SIZE + 1;
+	const auto count_miss = [&](const uint32_t v) {
+		if (time - cache_time[v] <= CACHE_SIZE) return 0;
+		cache_time[v] = time++;
+		return 1;
+	};
+	for (size_t k = 0; k < clusters.size(); k++) {
+		const size_t begin = clusters[k];
+		const size_t end = k + 1 < clusters.size() ? clusters[k + 1] : faces.size();
+		// Advancing the time past the cache size is the same as flushing the cache
+		time += CACHE_SIZE + 1;
+		size_t cluster_misses = 0;
+		for (size_t f = begin; f < end; f++) {
+			const auto &[a, b, c] = faces[f];
+			cluster_misses += count_miss(a) + count_miss(b) + count_miss(c);
+		}
+		const float limit = (float)cluster_misses / (float)(end - begin) * std::max(threshold, 1.0f);
+		starts.push_back((uint32_t)begin);
+		time += CACHE_SIZE + 1;
+		size_t misses = 0;
+		size_t start = begin;
+		for (size_t f = begin; f < end; f++) {
+			const auto &[a, b, c] = faces[f];
+			misses += count_miss(a) + count_miss(b) + count_miss(c);
+			if (f + 1 < end && f + 1 - start >= MIN_CLUSTER_FACE_COUNT && (float)misses <= limit * (float)(f + 1 - start)) {
+				starts.push_back((uint32_t)(f + 1));
+				start = f + 1;
+				misses = 0;
+				time += CACHE_SIZE + 1;
+			}
+		}
+	}
+	// Sort clusters by how much they face away from the center of the mesh
+	glm::vec3 mesh_centroid(0.0f);
+	float mesh_area = 0.0f;
+	struct Cluster {
+		uint32_t begin;
+		uint32_t end;
+		float sort_key;
+	};
+	std::vector<Cluster> sorted;
+	std::vector<glm::vec3> centroids;
+	std::vector<glm::vec3> normals;
+	sorted.reserve(starts.size());
+	for (size_t s = 0; s < starts.size(); s++) {
+		const uint32_t begin = starts[s];
+		const uint32_t end = s + 1 < starts.size() ? starts[s + 1] : (uint32_t)faces.size();
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+		for (uint32_t f = begin; f < end; f++) {
+			const auto &[a, b, c] = faces[f];
+			const glm::vec3 cross = glm::cross(vertices[b] - vertices[a], vertices[c] - vertices[a]);
+			const float face_area = glm::length(cross);
+			centroid += (vertices[a] + vertices[b] + vertices[c]) * (face_area / 3.0f);
+			normal += cross;
+			area += face_area;
+		}
+		mesh_centroid += centroid;
+		mesh_area += area;
+		centroids.push_back(area > 0.0f ? centroid / area : vertices[std::get<0>(faces[begin])]);
+		const float length = glm::length(normal);
+		normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f));
+		sorted.push_back(Cluster{ begin, end, 0.0f });
+	}
+	if (mesh_area > 0.0f) mesh_centroid /= mesh_area;
+	for (size_t s = 0; s < sorted.size(); s++) {
+		sorted[s].sort_key = glm::dot(centroids[s] - mesh_centroid, normals[s]);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster &a, const Cluster &b) {
+		return a.sort_key > b.sort_key;
+	});
+	std::vector<Face> result;
+	result.reserve(faces.size());
+	for (const Cluster &cluster : sorted) {
+		result.insert(result.end(), faces.begin() + cluster.begin, faces.begin() + cluster.end);
+	}
+	faces = std::move(result);
+}
+
+/**
+ * Stores vertices in the order they are first referenced by the faces, so that vertex fetches
+ * walk memory linearly. Vertices not referenced by any face are moved to the end.
+ * Normals and texture coordinates follow their vertex.
+ *
+ * @param lod The level of detail to reorder, in place.
+ */
+void ENG_API MeshOptimizer::optimize_vertex_fetch(MeshLOD &lod) {
+	constexpr uint32_t UNUSED = UINT32_MAX;
+	const size_t vertex_count = lod.vertices.size();
+	std::vector<uint32_t> remap(vertex_count, UNUSED);
+	uint32_t next = 0;
+	for (auto &[a, b, c] : lod.faces) {
+		for (uint32_t *v : { &a, &b, &c }) {
+			if (remap[*v] == UNUSED) remap[*v] = next++;
+			*v = remap[*v];
+		}
+	}
+	for (uint32_t &index : remap) {
+		if (index == UNUSED) index = next++;
+	}
+	const auto reorder = [&](auto &attribute) {
+		if (attribute.size() != vertex_count) return;
+		std::remove_reference_t<decltype(attribute)> result(vertex_count);
+		for (size_t v = 0; v < vertex_count; v++) {
+			result[remap[v]] = attribute[v];
+		}
+		attribute = std::move(result);
+	};
+	reorder(lod.vertices);
+	reorder(lod.normals);
+	reorder(lod.uvs);
+}
+
+/**
+ * Runs the full optimization pipeline on a level of detail: exact vertex welding, vertex cache,
+ * overdraw, then vertex fetch.
+ *
+ * @param lod The level of detail to optimize, in place.
+ * @return The average cache miss ratio before and after the optimization, and the number of vertices welded.
+ */
+MeshOptimizationStats ENG_API MeshOptimizer::optimize(MeshLOD &lod) {
+	MeshOptimizationStats stats;
+	stats.acmr_before = MeshOptimizer::compute_acmr(lod.faces, lod.vertices.size());
+	// Faces move, so meshlets built earlier no longer apply
+	lod.meshlets.clear();
+	stats.welded_count = MeshOptimizer::weld_vertices(lod);
+	const std::vector<uint32_t> clusters = MeshOptimizer::optimize_vertex_cache(lod.faces, lod.vertices.size());
+	MeshOptimizer::optimize_overdraw(lod.faces, lod.vertices, clusters);
+	MeshOptimizer::optimize_vertex_fetch(lod);
+	stats.acmr_after = MeshOptimizer::compute_acmr(lod.faces, lod.vertices.size());
+	return stats;
+}
+
+/**
+ * Optimizes every level of detail of a mesh.
+ *
+ * @param mesh The mesh to optimize.
+ * @return The average cache miss ratio before and after the optimization over all levels, and the number of vertices welded.
+ */
+MeshOptimizationStats ENG_API MeshOptimizer::optimize(Mesh &mesh) {
+	double misses_before = 0.0;
+	double misses_after = 0.0;
+	size_t face_count = 0;
+	size_t welded_count = 0;
+	for (size_t level = 0; level < mesh.get_lod_count(); level++) {
+		MeshLOD lod = mesh.take_lod(level);
+		const MeshOptimizationStats stats = MeshOptimizer::optimize(lod);
+		misses_before += (double)stats.acmr_before * (double)lod.faces.size();
+		misses_after += (double)stats.acmr_after * (double)lod.faces.size();
+		face_count += lod.faces.size();
+		welded_count += stats.welded_count;
+		mesh.set_lod(level, std::move(lod));
+	}
+	MeshOptimizationStats stats{ 0.0f, 0.0f, welded_count };
+	if (face_count > 0) {
+		stats.acmr_before = (float)(misses_before / (double)face_count);
+		stats.acmr_after = (float)(misses_after / (double)face_count);
+	}
+	DEBUG("Mesh %s optimized, ACMR %.3f -> %.3f, %zu vertices welded", mesh.get_name().c_str(), stats.acmr_before, stats.acmr_after, welded_count);
+	return stats;
+}
+
+/**
+ * Optimizes several meshes in parallel, on the shared thread pool.
+ *
+ * @param meshes The meshes to optimize.
+ */
+void ENG_API MeshOptimizer::optimize(const std::vector<std::shared_ptr<Mesh>> &meshes) {
+	std::vector<Mesh *> order;
+	order.reserve(meshes.size());
+	for (const auto &mesh : meshes) {
+		if (mesh != nullptr) order.push_back(mesh.get());
+	}
+	std::sort(order.begin(), order.end(), [](const Mesh *a, const Mesh *b) {
+		return a->get_faces().size() > b->get_faces().size();
+	});
+	ThreadPool::get_shared().parallel_for_each(order.size(), [&](const size_t i) {
+		MeshOptimizer::optimize(*order[i]);
+	});
+}
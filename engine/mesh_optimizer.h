@@ -0,0 +1,54 @@
+/**
+ * @file	mesh_optimizer.h
+ * @brief	Mesh optimizer class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Average cache miss ratio (transformed vertices per triangle) before and after an optimization,
+ * and number of duplicate vertices merged.
+ */
+struct ENG_API MeshOptimizationStats {
+	float acmr_before;
+	float acmr_after;
+	size_t welded_count;
+};
+
+/**
+ * @brief Reorders the faces and vertices of meshes for the GPU.
+ * Duplicate vertices are merged first, then faces are reordered for the post-transform vertex
+ * cache with Tipsify, the resulting clusters are sorted to reduce overdraw, and vertices are
+ * finally stored in the order they are first fetched.
+ */
+class ENG_API MeshOptimizer final {
+public:
+	static constexpr uint32_t CACHE_SIZE = 16;
+	static size_t weld_vertices(MeshLOD &lod, const float epsilon = 0.0f);
+	static float compute_acmr(const std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const size_t vertex_count, const uint32_t cache_size = CACHE_SIZE);
+	static std::vector<uint32_t> optimize_vertex_cache(std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const size_t vertex_count, const uint32_t cache_size = CACHE_SIZE);
+	static void optimize_overdraw(std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> &faces, const std::vector<glm::vec3> &vertices, const std::vector<uint32_t> &clusters, const float threshold = 1.05f);
+	static void optimize_vertex_fetch(MeshLOD &lod);
+	static MeshOptimizationStats optimize(MeshLOD &lod);
+	static MeshOptimizationStats optimize(Mesh &mesh);
+	static void optimize(const std::vector<std::shared_ptr<Mesh>> &meshes);
+};
+
+}
@@ -0,0 +1,431 @@
+/**
+ * @file	mesh_simplifier.cpp
+ * @brief	Mesh simplifier class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+// Weight of the planes keeping borders and seams in place, relative to the surface planes
+static constexpr double CONSTRAINT_WEIGHT = 16.0;
+// Levels are no longer generated below this number of faces
+static constexpr size_t MIN_LOD_FACE_COUNT = 32;
+
+namespace {
+
+/**
+ * Symmetric 4x4 quadric, accumulating squared distances to a set of planes.
+ */
+struct Quadric {
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+	double b2 = 0.0, bc = 0.0, bd = 0.0;
+	double c2 = 0.0, cd = 0.0;
+	double d2 = 0.0;
+	void add_plane(const glm::dvec3 &n, const double d, const double weight) {
+		this->a2 += weight * n.x * n.x; this->ab += weight * n.x * n.y; this->ac += weight * n.x * n.z; this->ad += weight * n.x * d;
+		this->b2 += weight * n.y * n.y; this->bc += weight * n.y * n.z; this->bd += weight * n.y * d;
+		this->c2 += weight * n.z * n.z; this->cd += weight * n.z * d;
+		this->d2 += weight * d * d;
+	}
+	void add(const Quadric &other) {
+		this->a2 += other.a2; this->ab += other.ab; this->ac += other.ac; this->ad += other.ad;
+		this->b2 += other.b2; this->bc += other.bc; this->bd += other.bd;
+		this->c2 += other.c2; this->cd += other.cd;
+		this->d2 += other.d2;
+	}
+	double evaluate(const glm::dvec3 &p) const {
+		return this->a2 * p.x * p.x + this->b2 * p.y * p.y + this->c2 * p.z * p.z
+			+ 2.0 * (this->ab * p.x * p.y + this->ac * p.x * p.z + this->bc * p.y * p.z)
+			+ 2.0 * (this->ad * p.x + this->bd * p.y + this->cd * p.z)
+			+ this->d2;
+	}
+};
+
+/**
+ * Candidate collapse of the position `from` onto the position `to`.
+ * Candidates are invalidated lazily, by comparing the versions of both positions.
+ */
+struct Collapse {
+	double cost;
+	uint32_t from;
+	uint32_t to;
+	uint32_t from_version;
+	uint32_t to_version;
+	bool operator>(const Collapse &other) const {
+		return this->cost > other.cost;
+	}
+};
+
+struct PositionKey {
+	uint32_t bits[3];
+	bool operator==(const PositionKey &other) const {
+		return this->bits[0] == other.bits[0] && this->bits[1] == other.bits[1] && this->bits[2] == other.bits[2];
+	}
+};
+
+struct PositionKeyHash {
+	size_t operator()(const PositionKey &key) const {
+		uint64_t h = key.bits[0] * 0x9E3779B97F4A7C15ull;
+		h ^= (h >> 29) ^ (key.bits[1] * 0xBF58476D1CE4E5B9ull);
+		h ^= (h >> 31) ^ (key.bits[2] * 0x94D049BB133111EBull);
+		return (size_t)(h ^ (h >> 32));
+	}
+};
+
+struct EdgeInfo {
+	uint32_t count;
+	uint32_t face;
+	uint32_t wedges[2];
+	bool seam;
+};
+
+glm::dvec3 face_normal(const glm::dvec3 &p0, const glm::dvec3 &p1, const glm::dvec3 &p2) {
+	return glm::cross(p1 - p0, p2 - p0);
+}
+
+}
+
+/**
+ * Simplifies a level of detail down to a target number of faces.
+ * Collapses are performed in order of increasing quadric error, until the target is met,
+ * the next collapse would exceed `max_error`, or no valid collapse is left.
+ *
+ * @param source The level of detail to simplify.
+ * @param target_face_count The number of faces to reach.
+ * @param max_error The maximum geometric error allowed, in model units.
+ * @param result_error If not null, receives the largest error of the collapses performed.
+ * @return The simplified level of detail, with the screen size of the source.
+ */
+MeshLOD ENG_API MeshSimplifier::simplify(const MeshLOD &source, const size_t target_face_count, const float max_error, float *result_error) {
+	if (result_error != nullptr) *result_error = 0.0f;
+	const size_t face_count = source.faces.size();
+	if (face_count <= target_face_count || source.vertices.empty()) return source;
+
+	// Vertices sharing a position are wedges of the same position
+	std::vector<uint32_t> position_of(source.vertices.size());
+	std::vector<glm::dvec3> positions;
+	{
+		std::unordered_map<PositionKey, uint32_t, PositionKeyHash> by_bits;
+		by_bits.reserve(source.vertices.size());
+		for (size_t v = 0; v < source.vertices.size(); v++) {
+			PositionKey key;
+			for (int axis = 0; axis < 3; axis++) {
+				// Adding zero folds -0 into +0
+				const float coordinate = source.vertices[v][axis] + 0.0f;
+				std::memcpy(&key.bits[axis], &coordinate, sizeof(float));
+			}
+			const auto it = by_bits.emplace(key, (uint32_t)positions.size());
+			if (it.second) positions.push_back(glm::dvec3(source.vertices[v]));
+			position_of[v] = it.first->second;
+		}
+	}
+	const size_t position_count = positions.size();
+	std::vector<uint32_t> corners(face_count * 3);
+	for (size_t f = 0; f < face_count; f++) {
+		corners[f * 3 + 0] = std::get<0>(source.faces[f]);
+		corners[f * 3 + 1] = std::get<1>(source.faces[f]);
+		corners[f * 3 + 2] = std::get<2>(source.faces[f]);
+	}
+	std::vector<uint8_t> face_alive(face_count, 1);
+	std::vector<std::vector<uint32_t>> incident(position_count);
+	std::vector<Quadric> quadrics(position_count);
+	for (size_t f = 0; f < face_count; f++) {
+		const uint32_t p0 = position_of[corners[f * 3 + 0]];
+		const uint32_t p1 = position_of[corners[f * 3 + 1]];
+		const uint32_t p2 = position_of[corners[f * 3 + 2]];
+		incident[p0].push_back((uint32_t)f);
+		if (p1 != p0) incident[p1].push_back((uint32_t)f);
+		if (p2 != p0 && p2 != p1) incident[p2].push_back((uint32_t)f);
+		const glm::dvec3 n = face_normal(positions[p0], positions[p1], positions[p2]);
+		const double length = glm::length(n);
+		if (length <= 0.0) continue;
+		const glm::dvec3 unit = n / length;
+		const double d = -glm::dot(unit, positions[p0]);
+		quadrics[p0].add_plane(unit, d, 0.5 * length);
+		quadrics[p1].add_plane(unit, d, 0.5 * length);
+		quadrics[p2].add_plane(unit, d, 0.5 * length);
+	}
+
+	// Borders and seams are held in place by planes orthogonal to their faces
+	std::vector<uint8_t> border(position_count, 0);
+	std::vector<uint8_t> locked(position_count, 0);
+	std::unordered_map<uint64_t, EdgeInfo> edges;
+	edges.reserve(face_count * 2);
+	for (size_t f = 0; f < face_count; f++) {
+		for (int c = 0; c < 3; c++) {
+			uint32_t wa = corners[f * 3 + c];
+			uint32_t wb = corners[f * 3 + (c + 1) % 3];
+			uint32_t pa = position_of[wa];
+			uint32_t pb = position_of[wb];
+			if (pa == pb) continue;
+			if (pa > pb) {
+				std::swap(pa, pb);
+				std::swap(wa, wb);
+			}
+			const uint64_t key = ((uint64_t)pa << 32) | pb;
+			const auto it = edges.emplace(key, EdgeInfo{ 0, (uint32_t)f, { wa, wb }, false });
+			EdgeInfo &edge = it.first->second;
+			edge.count++;
+			if (edge.wedges[0] != wa || edge.wedges[1] != wb) edge.seam = true;
+		}
+	}
+	for (const auto &item : edges) {
+		const EdgeInfo &edge = item.second;
+		const uint32_t pa = (uint32_t)(item.first >> 32);
+		const uint32_t pb = (uint32_t)(item.first & 0xFFFFFFFFu);
+		if (edge.count > 2) {
+			locked[pa] = locked[pb] = 1;
+			continue;
+		}
+		if (edge.count == 2 && !edge.seam) continue;
+		if (edge.count == 1) border[pa] = border[pb] = 1;
+		const uint32_t f = edge.face;
+		const glm::dvec3 n = face_normal(positions[position_of[corners[f * 3 + 0]]], positions[position_of[corners[f * 3 + 1]]], positions[position_of[corners[f * 3 + 2]]]);
+		const glm::dvec3 direction = positions[pb] - positions[pa];
+		const glm::dvec3 m = glm::cross(direction, n);
+		const double length = glm::length(m);
+		if (length <= 0.0) continue;
+		const glm::dvec3 unit = m / length;
+		const double d = -glm::dot(unit, positions[pa]);
+		const double weight = CONSTRAINT_WEIGHT * glm::dot(direction, direction);
+		quadrics[pa].add_plane(unit, d, weight);
+		quadrics[pb].add_plane(unit, d, weight);
+	}
+
+	std::vector<uint32_t> versions(position_count, 0);
+	std::vector<uint8_t> removed(position_count, 0);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+	const auto push = [&](const uint32_t from, const uint32_t to) {
+		if (locked[from]) return;
+		Quadric q = quadrics[from];
+		q.add(quadrics[to]);
+		heap.push(Collapse{ std::max(q.evaluate(positions[to]), 0.0), from, to, versions[from], versions[to] });
+	};
+	for (const auto &item : edges) {
+		const uint32_t pa = (uint32_t)(item.first >> 32);
+		const uint32_t pb = (uint32_t)(item.first & 0xFFFFFFFFu);
+		push(pa, pb);
+		push(pb, pa);
+	}
+	edges.clear();
+
+	std::vector<uint32_t> marks(position_count, 0);
+	uint32_t mark = 0;
+	std::vector<uint32_t> shared_faces;
+	std::vector<uint32_t> other_faces;
+	std::vector<std::pair<uint32_t, uint32_t>> wedge_map;
+	std::vector<uint32_t> neighbors;
+	const double max_cost = (double)max_error * (double)max_error;
+	double worst_cost = 0.0;
+	size_t alive_count = face_count;
+	while (alive_count > target_face_count && !heap.empty()) {
+		const Collapse collapse = heap.top();
+		heap.pop();
+		const uint32_t from = collapse.from;
+		const uint32_t to = collapse.to;
+		if (removed[from] || removed[to] || versions[from] != collapse.from_version || versions[to] != collapse.to_version) continue;
+		if (collapse.cost > max_cost) break;
+		shared_faces.clear();
+		other_faces.clear();
+		for (const uint32_t f : incident[from]) {
+			if (!face_alive[f]) continue;
+			const uint32_t *c = &corners[f * 3];
+			if (position_of[c[0]] == to || position_of[c[1]] == to || position_of[c[2]] == to) shared_faces.push_back(f);
+			else other_faces.push_back(f);
+		}
+		if (shared_faces.empty()) continue;
+		// Border positions only slide along their border
+		if (border[from] && shared_faces.size() != 1) continue;
+		// Link condition: the endpoints may only share the neighbors opposite the collapsed edge
+		mark++;
+		for (const uint32_t f : incident[to]) {
+			if (!face_alive[f]) continue;
+			for (int k = 0; k < 3; k++) marks[position_of[corners[f * 3 + k]]] = mark;
+		}
+		size_t common = 0;
+		for (const uint32_t f : incident[from]) {
+			if (!face_alive[f]) continue;
+			for (int k = 0; k < 3; k++) {
+				const uint32_t p = position_of[corners[f * 3 + k]];
+				if (p != from && p != to && marks[p] == mark) {
+					common++;
+					marks[p] = 0;
+				}
+			}
+		}
+		if (common > shared_faces.size()) continue;
+		// Every wedge of `from` must map to the wedge of `to` on the same side of any seam
+		bool valid = true;
+		wedge_map.clear();
+		for (const uint32_t f : shared_faces) {
+			uint32_t wedge_from = 0;
+			uint32_t wedge_to = 0;
+			for (int k = 0; k < 3; k++) {
+				const uint32_t w = corners[f * 3 + k];
+				if (position_of[w] == from) wedge_from = w;
+				else if (position_of[w] == to) wedge_to = w;
+			}
+			const auto it = std::find_if(wedge_map.begin(), wedge_map.end(), [wedge_from](const std::pair<uint32_t, uint32_t> &item) {
+				return item.first == wedge_from;
+			});
+			if (it == wedge_map.end()) wedge_map.emplace_back(wedge_from, wedge_to);
+			else if (it->second != wedge_to) valid = false;
+		}
+		// Faces moved by the collapse must keep their orientation
+		for (size_t i = 0; valid && i < other_faces.size(); i++) {
+			const uint32_t *c = &corners[other_faces[i] * 3];
+			glm::dvec3 before[3];
+			glm::dvec3 after[3];
+			for (int k = 0; k < 3; k++) {
+				const uint32_t p = position_of[c[k]];
+				before[k] = positions[p];
+				after[k] = p == from ? positions[to] : positions[p];
+				if (p == from && std::none_of(wedge_map.begin(), wedge_map.end(), [&](const std::pair<uint32_t, uint32_t> &item) {
+					return item.first == c[k];
+				})) {
+					valid = false;
+				}
+			}
+			const glm::dvec3 n_before = face_normal(before[0], before[1], before[2]);
+			const glm::dvec3 n_after = face_normal(after[0], after[1], after[2]);
+			if (glm::dot(n_before, n_after) <= 0.0) valid = false;
+		}
+		if (!valid) continue;
+
+		for (const uint32_t f : shared_faces) {
+			face_alive[f] = 0;
+			alive_count--;
+		}
+		for (const uint32_t f : other_faces) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t &w = corners[f * 3 + k];
+				if (position_of[w] != from) continue;
+				for (const auto &item : wedge_map) {
+					if (item.first == w) {
+						w = item.second;
+						break;
+					}
+				}
+			}
+			incident[to].push_back(f);
+		}
+		quadrics[to].add(quadrics[from]);
+		border[to] = border[to] || border[from];
+		removed[from] = 1;
+		versions[from]++;
+		versions[to]++;
+		incident[from].clear();
+		incident[from].shrink_to_fit();
+		worst_cost = std::max(worst_cost, collapse.cost);
+
+		// Refresh the candidates around the surviving position
+		auto &to_faces = incident[to];
+		to_faces.erase(std::remove_if(to_faces.begin(), to_faces.end(), [&face_alive](const uint32_t f) {
+			return !face_alive[f];
+		}), to_faces.end());
+		mark++;
+		neighbors.clear();
+		for (const uint32_t f : to_faces) {
+			for (int k = 0; k < 3; k++) {
+				const uint32_t p = position_of[corners[f * 3 + k]];
+				if (p == to || marks[p] == mark) continue;
+				marks[p] = mark;
+				neighbors.push_back(p);
+			}
+		}
+		for (const uint32_t p : neighbors) {
+			push(to, p);
+			push(p, to);
+		}
+	}
+
+	// Compact the surviving wedges
+	MeshLOD result;
+	result.screen_size = source.screen_size;
+	std::vector<uint32_t> remap(source.vertices.size(), UINT32_MAX);
+	const bool has_normals = source.normals.size() == source.vertices.size();
+	const bool has_uvs = source.uvs.size() == source.vertices.size();
+	result.faces.reserve(alive_count);
+	for (size_t f = 0; f < face_count; f++) {
+		if (!face_alive[f]) continue;
+		uint32_t indices[3];
+		for (int k = 0; k < 3; k++) {
+			const uint32_t w = corners[f * 3 + k];
+			if (remap[w] == UINT32_MAX) {
+				remap[w] = (uint32_t)result.vertices.size();
+				result.vertices.push_back(source.vertices[w]);
+				if (has_normals) result.normals.push_back(source.normals[w]);
+				if (has_uvs) result.uvs.push_back(source.uvs[w]);
+			}
+			indices[k] = remap[w];
+		}
+		result.faces.emplace_back(indices[0], indices[1], indices[2]);
+	}
+	if (result_error != nullptr) *result_error = (float)std::sqrt(worst_cost);
+	return result;
+}
+
+/**
+ * Generates a chain of coarser levels of detail for a mesh that only has its full-resolution level.
+ * Every level targets `ratio` times the faces of the previous one; generation stops early once
+ * a level gets too small or the simplifier can no longer make progress.
+ * Meshes that already have several levels, such as OVO meshes exported with LODs, are left untouched.
+ *
+ * @param mesh The mesh to process.
+ * @param level_count The maximum number of levels to add.
+ * @param ratio The fraction of faces kept from one level to the next, in (0, 1).
+ */
+void ENG_API MeshSimplifier::generate_lods(Mesh &mesh, const size_t level_count, const float ratio) {
+	if (mesh.get_lod_count() > 1 || ratio <= 0.0f || ratio >= 1.0f) return;
+	for (size_t level = 0; level < level_count; level++) {
+		const MeshLOD &previous = mesh.get_lod(level);
+		const size_t target = (size_t)((float)previous.faces.size() * ratio);
+		if (target < MIN_LOD_FACE_COUNT) break;
+		MeshLOD lod = MeshSimplifier::simplify(previous, target);
+		// Stop once locked borders and seams prevent any meaningful reduction
+		if ((float)lod.faces.size() > (float)previous.faces.size() * (0.5f + 0.5f * ratio)) break;
+		mesh.add_lod(std::move(lod.vertices), std::move(lod.faces), std::move(lod.normals), std::move(lod.uvs));
+	}
+}
+
+/**
+ * Generates level of detail chains for several meshes in parallel, on the shared thread pool.
+ *
+ * @param meshes The meshes to process.
+ * @param level_count The maximum number of levels to add to each mesh.
+ * @param ratio The fraction of faces kept from one level to the next, in (0, 1).
+ */
+void ENG_API MeshSimplifier::generate_lods(const std::vector<std::shared_ptr<Mesh>> &meshes, const size_t level_count, const float ratio) {
+	// Largest meshes first, handed out one at a time, so that a big mesh does not end up last on a busy worker
+	std::vector<Mesh *> order;
+	order.reserve(meshes.size());
+	for (const auto &mesh : meshes) {
+		if (mesh != nullptr && mesh->get_lod_count() == 1) order.push_back(mesh.get());
+	}
+	std::sort(order.begin(), order.end(), [](const Mesh *a, const Mesh *b) {
+		return a->get_faces().size() > b->get_faces().size();
+	});
+	ThreadPool::get_shared().parallel_for_each(order.size(), [&](const size_t i) {
+		MeshSimplifier::generate_lods(*order[i], level_count, ratio);
+	});
+}
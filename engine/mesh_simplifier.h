@@ -0,0 +1,34 @@
+/**
+ * @file	mesh_simplifier.h
+ * @brief	Mesh simplifier class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Mesh simplifier based on quadric error metrics.
+ * Edges are collapsed onto one of their endpoints, so vertex attributes are never interpolated.
+ * Vertices sharing a position with different attributes (UV seams, hard normal edges) can only
+ * slide along their seam, mesh borders are kept in place, and collapses flipping a face are rejected.
+ */
+class ENG_API MeshSimplifier final {
+public:
+	static MeshLOD simplify(const MeshLOD &source, const size_t target_face_count, const float max_error = 1e30f, float *result_error = nullptr);
+	static void generate_lods(Mesh &mesh, const size_t level_count = 3, const float ratio = 0.5f);
+	static void generate_lods(const std::vector<std::shared_ptr<Mesh>> &meshes, const size_t level_count = 3, const float ratio = 0.5f);
+};
+
+}
@@ -0,0 +1,157 @@
+/**
+ * @file	meshlet.cpp
+ * @brief	Meshlet builder class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+// Normal cones whose faces deviate more than this from the axis (cosine) are not worth testing
+static constexpr float MIN_CONE_SPREAD = 0.1f;
+
+namespace {
+
+/**
+ * Computes the bounding sphere and normal cone of a range of faces.
+ */
+Meshlet compute_bounds(const MeshLOD &lod, const FaceRange range) {
+	Meshlet meshlet;
+	meshlet.faces = range;
+	glm::vec3 min(std::numeric_limits<float>::max());
+	glm::vec3 max(-std::numeric_limits<float>::max());
+	glm::vec3 axis(0.0f);
+	for (uint32_t f = range.offset; f < range.offset + range.count; f++) {
+		const auto &[a, b, c] = lod.faces[f];
+		for (const uint32_t v : { a, b, c }) {
+			min = glm::min(min, lod.vertices[v]);
+			max = glm::max(max, lod.vertices[v]);
+		}
+		const glm::vec3 normal = glm::cross(lod.vertices[b] - lod.vertices[a], lod.vertices[c] - lod.vertices[a]);
+		const float length = glm::length(normal);
+		if (length > 0.0f) axis += normal / length;
+	}
+	meshlet.center = 0.5f * (min + max);
+	meshlet.radius = 0.0f;
+	for (uint32_t f = range.offset; f < range.offset + range.count; f++) {
+		const auto &[a, b, c] = lod.faces[f];
+		for (const uint32_t v : { a, b, c }) {
+			meshlet.radius = std::max(meshlet.radius, glm::length(lod.vertices[v] - meshlet.center));
+		}
+	}
+	// Default to a cone that is never culled
+	meshlet.cone_apex = meshlet.center;
+	meshlet.cone_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.cone_cutoff = 1.0f;
+	const float axis_length = glm::length(axis);
+	if (axis_length == 0.0f) return meshlet;
+	axis /= axis_length;
+	float min_dot = 1.0f;
+	float max_t = 0.0f;
+	for (uint32_t f = range.offset; f < range.offset + range.count; f++) {
+		const auto &[a, b, c] = lod.faces[f];
+		const glm::vec3 normal = glm::cross(lod.vertices[b] - lod.vertices[a], lod.vertices[c] - lod.vertices[a]);
+		const float length = glm::length(normal);
+		if (length == 0.0f) continue;
+		const float dot = glm::dot(axis, normal / length);
+		min_dot = std::min(min_dot, dot);
+		if (dot <= MIN_CONE_SPREAD) return meshlet;
+		// Move the apex back along the axis until it lies behind every face plane
+		max_t = std::max(max_t, glm::dot(meshlet.center - lod.vertices[a], normal / length) / dot);
+	}
+	meshlet.cone_apex = meshlet.center - axis * max_t;
+	meshlet.cone_axis = axis;
+	meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+	return meshlet;
+}
+
+}
+
+/**
+ * Splits a level of detail into meshlets of contiguous faces.
+ * A meshlet is closed as soon as the next face would exceed either limit.
+ *
+ * @param lod The level of detail to split.
+ * @param max_vertices The maximum number of distinct vertices per meshlet.
+ * @param max_faces The maximum number of faces per meshlet.
+ * @return The meshlets, covering every face in order.
+ */
+std::vector<Meshlet> ENG_API MeshletBuilder::build(const MeshLOD &lod, const size_t max_vertices, const size_t max_faces) {
+	std::vector<Meshlet> meshlets;
+	if (lod.faces.empty() || max_vertices < 3 || max_faces == 0) return meshlets;
+	meshlets.reserve(lod.faces.size() / max_faces + 1);
+	// Meshlet each vertex was last counted in
+	std::vector<uint32_t> owner(lod.vertices.size(), UINT32_MAX);
+	uint32_t current = 0;
+	FaceRange range{ 0, 0 };
+	size_t vertex_count = 0;
+	for (uint32_t f = 0; f < (uint32_t)lod.faces.size(); f++) {
+		const auto &[a, b, c] = lod.faces[f];
+		const size_t added = (owner[a] != current) + (owner[b] != current && b != a) + (owner[c] != current && c != a && c != b);
+		if (range.count == max_faces || vertex_count + added > max_vertices) {
+			meshlets.push_back(compute_bounds(lod, range));
+			range = FaceRange{ f, 0 };
+			vertex_count = 0;
+			current++;
+		}
+		for (const uint32_t v : { a, b, c }) {
+			if (owner[v] != current) {
+				owner[v] = current;
+				vertex_count++;
+			}
+		}
+		range.count++;
+	}
+	meshlets.push_back(compute_bounds(lod, range));
+	return meshlets;
+}
+
+/**
+ * Builds the meshlets of every level of detail of a mesh with at least `min_face_count` faces.
+ * Smaller levels are left without meshlets, since object-level culling is enough for them.
+ *
+ * @param mesh The mesh to process.
+ * @param min_face_count The minimum number of faces of a level to split it.
+ */
+void ENG_API MeshletBuilder::build(Mesh &mesh, const size_t min_face_count) {
+	for (size_t level = 0; level < mesh.get_lod_count(); level++) {
+		const MeshLOD &lod = mesh.get_lod(level);
+		mesh.set_meshlets(level, lod.faces.size() >= min_face_count ? MeshletBuilder::build(lod) : std::vector<Meshlet>());
+	}
+}
+
+/**
+ * Builds the meshlets of several meshes in parallel, on the shared thread pool.
+ *
+ * @param meshes The meshes to process.
+ * @param min_face_count The minimum number of faces of a level to split it.
+ */
+void ENG_API MeshletBuilder::build(const std::vector<std::shared_ptr<Mesh>> &meshes, const size_t min_face_count) {
+	std::vector<Mesh *> order;
+	order.reserve(meshes.size());
+	for (const auto &mesh : meshes) {
+		if (mesh != nullptr && mesh->get_faces().size() >= min_face_count) order.push_back(mesh.get());
+	}
+	std::sort(order.begin(), order.end(), [](const Mesh *a, const Mesh *b) {
+		return a->get_faces().size() > b->get_faces().size();
+	});
+	ThreadPool::get_shared().parallel_for_each(order.size(), [&](const size_t i) {
+		MeshletBuilder::build(*order[i], min_face_count);
+	});
+}
@@ -0,0 +1,64 @@
+/**
+ * @file	meshlet.h
+ * @brief	Meshlet builder class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+
+namespace lrvg {
+
+class Mesh;
+struct MeshLOD;
+
+/**
+ * @brief Contiguous range of faces of a mesh level of detail.
+ */
+struct ENG_API FaceRange {
+	uint32_t offset;
+	uint32_t count;
+};
+
+/**
+ * @brief Small cluster of contiguous faces, with the bounds used to cull it as a whole.
+ * The cluster is entirely back-facing when seen from any point `eye` for which
+ * `dot(normalize(cone_apex - eye), cone_axis) >= cone_cutoff`; a cutoff of 1 disables the test.
+ */
+struct ENG_API Meshlet {
+	FaceRange faces;
+	glm::vec3 center;
+	float radius;
+	glm::vec3 cone_apex;
+	glm::vec3 cone_axis;
+	float cone_cutoff;
+};
+
+/**
+ * @brief Splits mesh levels of detail into meshlets.
+ * Faces are grouped in their current order, which after mesh optimization keeps neighbouring
+ * faces together, so that each meshlet stays a contiguous range of the index buffer.
+ */
+class ENG_API MeshletBuilder final {
+public:
+	static constexpr size_t MAX_VERTICES = 64;
+	static constexpr size_t MAX_FACES = 124;
+	static constexpr size_t MIN_FACE_COUNT = 4096;
+	static std::vector<Meshlet> build(const MeshLOD &lod, const size_t max_vertices = MAX_VERTICES, const size_t max_faces = MAX_FACES);
+	static void build(Mesh &mesh, const size_t min_face_count = MIN_FACE_COUNT);
+	static void build(const std::vector<std::shared_ptr<Mesh>> &meshes, const size_t min_face_count = MIN_FACE_COUNT);
+};
+
+}
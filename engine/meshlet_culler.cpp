@@ -0,0 +1,192 @@
+/**
+ * @file	meshlet_culler.cpp
+ * @brief	Meshlet culler class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "meshlet_culler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new meshlet culler, enabled by default.
+ */
+ENG_API MeshletCuller::MeshletCuller() : enabled{ true }, projection{ 1.0f } {
+	this->begin_frame(glm::mat4(1.0f));
+}
+
+/**
+ * Enables or disables the culling. When disabled, meshes are always drawn whole.
+ *
+ * @param enabled Whether meshlets are culled.
+ */
+void ENG_API MeshletCuller::set_enabled(const bool enabled) {
+	this->enabled = enabled;
+}
+
+/**
+ * Checks whether meshlets are culled.
+ *
+ * @return True if the culling is enabled, false otherwise.
+ */
+bool ENG_API MeshletCuller::is_enabled() const {
+	return this->enabled;
+}
+
+/**
+ * Retrieves the number of meshes whose meshlets were tested during the last frame.
+ *
+ * @return The number of meshes.
+ */
+int ENG_API MeshletCuller::get_mesh_count() const {
+	return this->mesh_count;
+}
+
+/**
+ * Retrieves the number of meshlets tested during the last frame.
+ *
+ * @return The number of meshlets.
+ */
+size_t ENG_API MeshletCuller::get_meshlet_count() const {
+	return this->meshlet_count;
+}
+
+/**
+ * Retrieves the number of meshlets rejected during the last frame for lying outside the view frustum.
+ *
+ * @return The number of meshlets outside the frustum.
+ */
+size_t ENG_API MeshletCuller::get_frustum_culled_count() const {
+	return this->frustum_culled_count;
+}
+
+/**
+ * Retrieves the number of meshlets rejected during the last frame for facing away from the camera.
+ *
+ * @return The number of back-facing meshlets.
+ */
+size_t ENG_API MeshletCuller::get_backface_culled_count() const {
+	return this->backface_culled_count;
+}
+
+/**
+ * Retrieves the number of face ranges submitted during the last frame, i.e. the number of draw calls.
+ *
+ * @return The number of face ranges.
+ */
+size_t ENG_API MeshletCuller::get_range_count() const {
+	return this->range_count;
+}
+
+/**
+ * Starts a new frame: statistics are reset.
+ * This method is called automatically by the engine.
+ *
+ * @param projection The projection matrix of the active camera.
+ */
+void ENG_API MeshletCuller::begin_frame(const glm::mat4 projection) {
+	this->projection = projection;
+	this->mesh_count = 0;
+	this->meshlet_count = 0;
+	this->frustum_culled_count = 0;
+	this->backface_culled_count = 0;
+	this->range_count = 0;
+}
+
+/**
+ * Culls the meshlets of the current level of detail of a mesh, and restricts its drawing to the visible ones.
+ * Meshes whose current level has no meshlets are drawn whole.
+ * This method is called automatically by the engine, after the level of detail is selected.
+ *
+ * @param mesh The mesh to update.
+ * @param model_view The model-view matrix of the mesh.
+ * @return The number of faces left to draw.
+ */
+size_t ENG_API MeshletCuller::cull(Mesh &mesh, const glm::mat4 &model_view) {
+	const MeshLOD &lod = mesh.get_lod(mesh.get_lod_level());
+	if (!this->enabled || lod.meshlets.empty()) {
+		mesh.set_cluster_culling(false);
+		return lod.faces.size();
+	}
+	// Frustum planes and camera in model space, so that meshlet bounds are used as they are
+	const glm::mat4 clip = this->projection * model_view;
+	glm::vec4 planes[6];
+	for (int i = 0; i < 3; i++) {
+		const glm::vec4 row(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+		const glm::vec4 w(clip[0][3], clip[1][3], clip[2][3], clip[3][3]);
+		planes[2 * i] = w + row;
+		planes[2 * i + 1] = w - row;
+	}
+	for (glm::vec4 &plane : planes) {
+		const float length = glm::length(glm::vec3(plane));
+		if (length > 0.0f) plane /= length;
+	}
+	const glm::mat4 inverse = glm::inverse(model_view);
+	const bool orthographic = this->projection[2][3] == 0.0f;
+	const glm::vec3 eye = glm::vec3(inverse[3]);
+	const glm::vec3 view_direction = glm::normalize(glm::vec3(inverse * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
+	// Mirroring transforms swap front and back faces
+	const bool test_cones = glm::determinant(glm::mat3(model_view)) > 0.0f;
+
+	const std::vector<Meshlet> &meshlets = lod.meshlets;
+	this->visibility.resize(meshlets.size());
+	const auto test = [&](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const Meshlet &meshlet = meshlets[i];
+			uint8_t result = VISIBLE;
+			for (const glm::vec4 &plane : planes) {
+				if (glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius) {
+					result = OUTSIDE_FRUSTUM;
+					break;
+				}
+			}
+			if (result == VISIBLE && test_cones && meshlet.cone_cutoff < 1.0f) {
+				const glm::vec3 direction = orthographic ? view_direction : meshlet.cone_apex - eye;
+				const float length = glm::length(direction);
+				if (length > 0.0f && glm::dot(direction / length, meshlet.cone_axis) >= meshlet.cone_cutoff) {
+					result = BACK_FACING;
+				}
+			}
+			this->visibility[i] = result;
+		}
+	};
+	if (meshlets.size() >= PARALLEL_MESHLET_COUNT) {
+		ThreadPool::get_shared().parallel_for(meshlets.size(), test);
+	} else {
+		test(0, meshlets.size());
+	}
+	// Compact the visible meshlets into ranges, merging neighbours
+	this->ranges.clear();
+	size_t face_count = 0;
+	for (size_t i = 0; i < meshlets.size(); i++) {
+		if (this->visibility[i] != VISIBLE) {
+			if (this->visibility[i] == OUTSIDE_FRUSTUM) this->frustum_culled_count++;
+			else this->backface_culled_count++;
+			continue;
+		}
+		const FaceRange &faces = meshlets[i].faces;
+		face_count += faces.count;
+		if (!this->ranges.empty() && this->ranges.back().offset + this->ranges.back().count == faces.offset) {
+			this->ranges.back().count += faces.count;
+		} else {
+			this->ranges.push_back(faces);
+		}
+	}
+	mesh.set_visible_ranges(this->ranges);
+	this->mesh_count++;
+	this->meshlet_count += meshlets.size();
+	this->range_count += this->ranges.size();
+	return face_count;
+}
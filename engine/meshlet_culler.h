@@ -0,0 +1,59 @@
+/**
+ * @file	meshlet_culler.h
+ * @brief	Meshlet culler class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+#include "meshlet.h"
+
+namespace lrvg {
+
+/**
+ * @brief Culls the meshlets of large meshes against the view frustum and by their normal cone.
+ * Meshlets are tested in model space, in parallel for meshes with many meshlets, and the visible
+ * ones are merged into as few contiguous face ranges as possible before being handed to the mesh.
+ */
+class ENG_API MeshletCuller final {
+public:
+	static constexpr size_t PARALLEL_MESHLET_COUNT = 1024;
+	MeshletCuller();
+	void set_enabled(const bool enabled);
+	bool is_enabled() const;
+	int get_mesh_count() const;
+	size_t get_meshlet_count() const;
+	size_t get_frustum_culled_count() const;
+	size_t get_backface_culled_count() const;
+	size_t get_range_count() const;
+	void begin_frame(const glm::mat4 projection);
+	size_t cull(Mesh &mesh, const glm::mat4 &model_view);
+private:
+	enum Visibility : uint8_t {
+		VISIBLE,
+		OUTSIDE_FRUSTUM,
+		BACK_FACING
+	};
+	bool enabled;
+	glm::mat4 projection;
+	std::vector<uint8_t> visibility;
+	std::vector<FaceRange> ranges;
+	int mesh_count;
+	size_t meshlet_count;
+	size_t frustum_culled_count;
+	size_t backface_culled_count;
+	size_t range_count;
+};
+
+}
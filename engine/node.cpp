@@ -1,6 +1,8 @@
 #include "node.h"
 #include "common.h"
 
+#include <algorithm>
+
 #include <glad/gl.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -17,13 +19,49 @@ using namespace lrvg;
  * * Rotation: (0, 0, 0)
  * * Scale: (1, 1, 1)
  */
-ENG_API Node::Node() {
+ENG_API Node::Node() : handle{ NodePool::get_shared().acquire(*this) }, parent{ nullptr }, index{ nullptr }, local_dirty{ true }, world_dirty{ true } {
 	this->set_base_matrix(glm::mat4(1.0f));
 	this->set_position(glm::vec3(0.0f, 0.0f, 0.0f));
 	this->set_rotation(glm::vec3(0.0f, 0.0f, 0.0f));
 	this->set_scale(glm::vec3(1.0f, 1.0f, 1.0f));
 }
 
+/**
+ * Destroys the node.
+ * The node and its subtree are removed from the scene index they are registered in, if any, and
+ * children that outlive the node become roots.
+ */
+ENG_API Node::~Node() {
+	if (this->index != nullptr) {
+		this->index->remove(*this);
+	}
+	for (const auto &child : this->children) {
+		if (child->parent == this) {
+			child->parent = nullptr;
+			// Children kept alive elsewhere lose this node's transform from their world matrix
+			if (child.use_count() > 1) {
+				child->invalidate_transform();
+			}
+		}
+	}
+	NodePool::get_shared().release(this->handle);
+}
+
+/**
+ * Sets the name of the node, keeping the scene index up to date.
+ * 
+ * @param name The new name to assign to the node.
+ */
+void ENG_API Node::set_name(const std::string name) {
+	if (this->index == nullptr) {
+		Object::set_name(name);
+		return;
+	}
+	const Atom old_name = this->get_name_atom();
+	Object::set_name(name);
+	this->index->rename(*this, old_name);
+}
+
 /**
  * Sets the base transformation matrix for the node.
  * 
@@ -31,6 +69,8 @@ ENG_API Node::Node() {
  */
 void ENG_API Node::set_base_matrix(const glm::mat4 base_matrix) {
 	this->base_matrix = base_matrix;
+	this->local_dirty = true;
+	this->invalidate_transform();
 }
 
 /**
@@ -40,6 +80,8 @@ void ENG_API Node::set_base_matrix(const glm::mat4 base_matrix) {
  */
 void ENG_API Node::set_position(const glm::vec3 position) {
 	this->position = position;
+	this->local_dirty = true;
+	this->invalidate_transform();
 }
 
 /**
@@ -49,6 +91,8 @@ void ENG_API Node::set_position(const glm::vec3 position) {
  */
 void ENG_API Node::set_rotation(const glm::vec3 rotation) {
 	this->rotation = rotation;
+	this->local_dirty = true;
+	this->invalidate_transform();
 }
 
 /**
@@ -58,6 +102,8 @@ void ENG_API Node::set_rotation(const glm::vec3 rotation) {
  */
 void ENG_API Node::set_scale(const glm::vec3 scale) {
 	this->scale = scale;
+	this->local_dirty = true;
+	this->invalidate_transform();
 }
 
 /**
@@ -69,13 +115,107 @@ std::vector<std::shared_ptr<Node>> ENG_API Node::get_children() const {
     return this->children;
 }
 
+/**
+ * Retrieves the parent of this node.
+ * 
+ * @return A shared pointer to the parent node, or nullptr if the node has no parent.
+ */
+std::shared_ptr<Node> ENG_API Node::get_parent() const {
+	if (this->parent == nullptr) return nullptr;
+	return this->parent->weak_from_this().lock();
+}
+
+/**
+ * Retrieves the generational handle of this node, which can be resolved with `NodePool::get`
+ * without holding a reference to the node.
+ * 
+ * @return The handle of the node.
+ */
+NodeHandle ENG_API Node::get_handle() const {
+	return this->handle;
+}
+
+/**
+ * Retrieves the scene index the node is registered in.
+ * 
+ * @return A pointer to the scene index, or nullptr if the node is not part of an indexed scene.
+ */
+SceneIndex ENG_API *Node::get_scene_index() const {
+	return this->index;
+}
+
 /**
  * Adds a child object to this node's list of children.
+ * If this node is part of an indexed scene, the child's subtree is registered in the index.
  * 
  * @param child A shared pointer to the child object to be added.
  */
 void ENG_API Node::add_child(const std::shared_ptr<Node> child) {
+	if (UNLIKELY(child == nullptr || child.get() == this)) return;
+	if (child->parent != nullptr) {
+		child->parent->remove_child(child);
+	}
+	child->parent = this;
+	child->invalidate_transform();
 	this->children.push_back(child);
+	if (this->index != nullptr) {
+		this->index->insert(*child);
+	}
+}
+
+/**
+ * Removes a child from this node's list of children.
+ * The child's subtree is unregistered from the scene index and its cached transforms are invalidated,
+ * so the cost is proportional to the size of the subtree.
+ * 
+ * @param child A shared pointer to the child to remove.
+ * @return true if the child was found and removed, false otherwise.
+ */
+bool ENG_API Node::remove_child(const std::shared_ptr<Node> child) {
+	if (UNLIKELY(child == nullptr || child->parent != this)) return false;
+	const auto it = std::find(this->children.begin(), this->children.end(), child);
+	if (UNLIKELY(it == this->children.end())) return false;
+	if (child->index != nullptr) {
+		child->index->remove(*child);
+	}
+	this->children.erase(it);
+	child->parent = nullptr;
+	child->invalidate_transform();
+	return true;
+}
+
+/**
+ * Detaches this node, with its subtree, from its parent.
+ * 
+ * @return A shared pointer to this node, which keeps the detached subtree alive.
+ */
+std::shared_ptr<Node> ENG_API Node::detach() {
+	std::shared_ptr<Node> self = this->weak_from_this().lock();
+	if (this->parent != nullptr && self != nullptr) {
+		this->parent->remove_child(self);
+	}
+	return self;
+}
+
+/**
+ * Moves this node, with its subtree, under a new parent.
+ * The local transform is kept, so the world transform follows the new parent.
+ * 
+ * @param new_parent A shared pointer to the new parent node.
+ * @return true if the node was moved, false if the new parent is this node or one of its descendants.
+ */
+bool ENG_API Node::reparent(const std::shared_ptr<Node> new_parent) {
+	if (UNLIKELY(new_parent == nullptr)) return false;
+	for (const Node *ancestor = new_parent.get(); ancestor != nullptr; ancestor = ancestor->parent) {
+		if (ancestor == this) {
+			WARN("cannot reparent node %s under its own subtree", this->get_name().c_str());
+			return false;
+		}
+	}
+	std::shared_ptr<Node> self = this->detach();
+	if (UNLIKELY(self == nullptr)) return false;
+	new_parent->add_child(self);
+	return true;
 }
 
 /**
@@ -94,6 +234,7 @@ void ENG_API Node::add_child(const std::shared_ptr<Node> child) {
  * @return A glm::mat4 representing the local transformation matrix.
  */
 glm::mat4 ENG_API Node::get_local_matrix() const {
+	if (!this->local_dirty) return this->local_matrix;
 	const glm::mat4 model_position_matrix = glm::translate(glm::mat4(1.0f), this->position);
 	const glm::mat4 model_rotation_matrix =
 		glm::rotate(glm::mat4(1.0f), glm::radians(this->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f)) *
@@ -101,7 +242,45 @@ glm::mat4 ENG_API Node::get_local_matrix() const {
 		glm::rotate(glm::mat4(1.0f), glm::radians(this->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
 	const glm::mat4 model_scale_matrix = glm::scale(glm::mat4(1.0f), this->scale);
 	const glm::mat4 offset_matrix = model_position_matrix * model_rotation_matrix * model_scale_matrix;
-	return offset_matrix * this->base_matrix;
+	this->local_matrix = offset_matrix * this->base_matrix;
+	this->local_dirty = false;
+	return this->local_matrix;
+}
+
+/**
+ * Computes and returns the world transformation matrix of the node,
+ * i.e. the product of the local matrices of its ancestors and of its own.
+ * 
+ * The matrix is cached and only recomputed after the transform of the node or of one of its
+ * ancestors changes, or after the node is moved in the scene graph.
+ * 
+ * @return A glm::mat4 representing the world transformation matrix.
+ */
+glm::mat4 ENG_API Node::get_world_matrix() const {
+	if (!this->world_dirty) return this->world_matrix;
+	const glm::mat4 local = this->get_local_matrix();
+	this->world_matrix = this->parent != nullptr ? this->parent->get_world_matrix() * local : local;
+	this->world_dirty = false;
+	return this->world_matrix;
+}
+
+/**
+ * Marks the cached world matrix of the node and of its subtree as outdated.
+ * A dirty node only has dirty descendants, so the walk stops at nodes that are already dirty.
+ */
+void Node::invalidate_transform() {
+	if (this->world_dirty) return;
+	std::vector<Node *> stack{ this };
+	while (!stack.empty()) {
+		Node *current = stack.back();
+		stack.pop_back();
+		current->world_dirty = true;
+		for (const auto &child : current->children) {
+			if (!child->world_dirty) {
+				stack.push_back(child.get());
+			}
+		}
+	}
 }
 
 /**
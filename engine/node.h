@@ -11,6 +11,8 @@
 
 #include "common.h"
 #include "object.h"
+#include "node_pool.h"
+#include "scene_index.h"
 
 #include <glm/glm.hpp>
 #include <vector>
@@ -21,15 +23,24 @@ namespace lrvg {
 /**
  * @brief Scene graph node class.
  */
-class ENG_API Node : public Object {
+class ENG_API Node : public Object, public std::enable_shared_from_this<Node> {
 public:
 	Node();
+	~Node();
 	glm::mat4 get_local_matrix() const override;
+	glm::mat4 get_world_matrix() const;
 	glm::vec3 get_position() const;
 	glm::vec3 get_rotation() const;
 	glm::vec3 get_scale() const;
     std::vector<std::shared_ptr<Node>> get_children() const;
+	std::shared_ptr<Node> get_parent() const;
+	SceneIndex *get_scene_index() const;
+	NodeHandle get_handle() const;
 	void add_child(const std::shared_ptr<Node> child);
+	bool remove_child(const std::shared_ptr<Node> child);
+	std::shared_ptr<Node> detach();
+	bool reparent(const std::shared_ptr<Node> new_parent);
+    void set_name(const std::string name) override;
     void set_base_matrix(const glm::mat4 base_matrix);
     void set_position(const glm::vec3 position);
     void set_rotation(const glm::vec3 rotation);
@@ -38,10 +49,19 @@ public:
 protected:
 	std::vector<std::shared_ptr<Node>> children;
 private:
+	friend class SceneIndex;
+	void invalidate_transform();
+	NodeHandle handle;
+	Node *parent;
+	SceneIndex *index;
 	glm::mat4 base_matrix;
 	glm::vec3 position;
 	glm::vec3 rotation;
 	glm::vec3 scale;
+	mutable glm::mat4 local_matrix;
+	mutable glm::mat4 world_matrix;
+	mutable bool local_dirty;
+	mutable bool world_dirty;
 };
 
 }
@@ -0,0 +1,238 @@
+/**
+ * @file	node_pool.cpp
+ * @brief	Node pool class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "node_pool.h"
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include "common.h"
+
+using namespace lrvg;
+
+// Blocks start after the chunk header, rounded up to the block alignment
+static constexpr size_t CHUNK_HEADER_SIZE = 32;
+
+/**
+ * Creates a new, empty node pool.
+ */
+ENG_API NodePool::NodePool() : node_count{ 0 }, pooled_count{ 0 } {
+	static_assert(sizeof(Chunk) <= CHUNK_HEADER_SIZE, "chunk header does not fit");
+	// Slot 0 is never handed out, so that the zero handle is always null
+	this->slots.push_back(Slot{ nullptr, NodeHandle::MAX_GENERATION });
+}
+
+/**
+ * Destroys the node pool and releases its memory.
+ * The pool must outlive every node created through it.
+ */
+ENG_API NodePool::~NodePool() {
+	for (auto &item : this->slabs) {
+		for (Chunk *chunk : item.second.chunks) {
+			::operator delete(chunk, std::align_val_t(CHUNK_SIZE));
+		}
+	}
+}
+
+/**
+ * Resolves a handle to the node it refers to.
+ *
+ * @param handle The handle to resolve.
+ * @return A pointer to the node, or nullptr if the handle is null or the node has been destroyed.
+ */
+Node ENG_API *NodePool::get(const NodeHandle handle) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	const uint32_t index = handle.get_index();
+	if (UNLIKELY(index >= this->slots.size())) return nullptr;
+	const Slot &slot = this->slots[index];
+	if (slot.generation != handle.get_generation()) return nullptr;
+	return slot.node;
+}
+
+/**
+ * Retrieves the number of live nodes with a handle in this pool.
+ *
+ * @return The number of live nodes.
+ */
+size_t ENG_API NodePool::get_node_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->node_count;
+}
+
+/**
+ * Retrieves the number of live objects stored in the pool slabs.
+ *
+ * @return The number of pooled objects.
+ */
+size_t ENG_API NodePool::get_pooled_count() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->pooled_count;
+}
+
+/**
+ * Retrieves the amount of memory reserved by the pool slabs.
+ *
+ * @return The reserved memory, in bytes.
+ */
+size_t ENG_API NodePool::get_reserved_bytes() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	size_t chunks = 0;
+	for (const auto &item : this->slabs) {
+		chunks += item.second.chunks.size();
+	}
+	return chunks * CHUNK_SIZE;
+}
+
+/**
+ * Releases the slab chunks that no longer hold any object.
+ * Since new objects always fill the lowest chunks first, live objects tend to gather at the
+ * front of each slab, and unloading a scene followed by a trim gives the memory back.
+ *
+ * @return The amount of memory released, in bytes.
+ */
+size_t ENG_API NodePool::trim() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	size_t released = 0;
+	for (auto &item : this->slabs) {
+		Slab &slab = item.second;
+		size_t kept = 0;
+		for (Chunk *chunk : slab.chunks) {
+			if (chunk->used == 0) {
+				::operator delete(chunk, std::align_val_t(CHUNK_SIZE));
+				released += CHUNK_SIZE;
+				continue;
+			}
+			chunk->position = (uint32_t)kept;
+			slab.chunks[kept++] = chunk;
+		}
+		slab.chunks.resize(kept);
+		slab.first_available = 0;
+	}
+	return released;
+}
+
+/**
+ * Retrieves the process-wide node pool. Every node takes its handle from this pool.
+ * The pool is never destroyed, so that nodes released during static destruction stay valid.
+ *
+ * @return A reference to the shared node pool.
+ */
+NodePool ENG_API &NodePool::get_shared() {
+	static NodePool *pool = new NodePool();
+	return *pool;
+}
+
+/**
+ * Allocates a block from the slab of the given size.
+ *
+ * @param size The size of the object to store.
+ * @return A pointer to the block.
+ */
+void *NodePool::allocate(const size_t size) {
+	const size_t block_size = (size + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+	std::lock_guard<std::mutex> lock(this->mutex);
+	Slab &slab = this->slabs[block_size];
+	slab.block_size = block_size;
+	while (slab.first_available < slab.chunks.size() && slab.chunks[slab.first_available]->free_list == nullptr) {
+		slab.first_available++;
+	}
+	Chunk *chunk = slab.first_available < slab.chunks.size() ? slab.chunks[slab.first_available] : NodePool::new_chunk(slab);
+	void *block = chunk->free_list;
+	chunk->free_list = *static_cast<void **>(block);
+	chunk->used++;
+	this->pooled_count++;
+	return block;
+}
+
+/**
+ * Returns a block to its slab.
+ *
+ * @param ptr A pointer to the block, as returned by `allocate`.
+ */
+void NodePool::deallocate(void *ptr) {
+	// Chunks are aligned to their size, so the owning chunk is found by masking the address
+	Chunk *chunk = reinterpret_cast<Chunk *>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(CHUNK_SIZE - 1));
+	std::lock_guard<std::mutex> lock(this->mutex);
+	*static_cast<void **>(ptr) = chunk->free_list;
+	chunk->free_list = ptr;
+	chunk->used--;
+	this->pooled_count--;
+	if (chunk->position < chunk->slab->first_available) {
+		chunk->slab->first_available = chunk->position;
+	}
+}
+
+/**
+ * Assigns a handle to a node.
+ *
+ * @param node The node to register.
+ * @return The handle of the node.
+ */
+NodeHandle NodePool::acquire(Node &node) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	uint32_t index;
+	if (!this->free_slots.empty()) {
+		index = this->free_slots.back();
+		this->free_slots.pop_back();
+	} else {
+		index = (uint32_t)this->slots.size();
+		if (UNLIKELY(index > NodeHandle::INDEX_MASK)) {
+			ERROR("node handle space exhausted");
+			return NodeHandle{};
+		}
+		this->slots.push_back(Slot{ nullptr, 0 });
+	}
+	Slot &slot = this->slots[index];
+	slot.node = &node;
+	slot.generation++;
+	this->node_count++;
+	return NodeHandle{ (slot.generation << NodeHandle::INDEX_BITS) | index };
+}
+
+/**
+ * Invalidates the handle of a node being destroyed.
+ *
+ * @param handle The handle of the node.
+ */
+void NodePool::release(const NodeHandle handle) {
+	if (UNLIKELY(!handle)) return;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	Slot &slot = this->slots[handle.get_index()];
+	slot.node = nullptr;
+	this->node_count--;
+	// A slot whose generation would wrap around is retired, so that stale handles never come back to life
+	if (slot.generation < NodeHandle::MAX_GENERATION) {
+		this->free_slots.push_back(handle.get_index());
+	}
+}
+
+/**
+ * Allocates a new chunk for a slab and threads its blocks into a free list.
+ *
+ * @param slab The slab to grow.
+ * @return The new chunk.
+ */
+NodePool::Chunk *NodePool::new_chunk(Slab &slab) {
+	void *memory = ::operator new(CHUNK_SIZE, std::align_val_t(CHUNK_SIZE));
+	Chunk *chunk = static_cast<Chunk *>(memory);
+	chunk->slab = &slab;
+	chunk->free_list = nullptr;
+	chunk->used = 0;
+	chunk->position = (uint32_t)slab.chunks.size();
+	const size_t count = (CHUNK_SIZE - CHUNK_HEADER_SIZE) / slab.block_size;
+	char *blocks = static_cast<char *>(memory) + CHUNK_HEADER_SIZE;
+	for (size_t i = count; i > 0; i--) {
+		void *block = blocks + (i - 1) * slab.block_size;
+		*static_cast<void **>(block) = chunk->free_list;
+		chunk->free_list = block;
+	}
+	slab.chunks.push_back(chunk);
+	return chunk;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file	node_pool.h
+ * @brief	Node pool class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+namespace lrvg {
+
+class Node;
+
+/**
+ * @brief 32-bit generational handle to a scene node.
+ * The low bits hold a slot index, the high bits the generation of the slot, so that a handle
+ * to a destroyed node never resolves to a node created later in the same slot.
+ * The zero handle is the null handle.
+ */
+struct ENG_API NodeHandle {
+	static constexpr uint32_t INDEX_BITS = 24;
+	static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static constexpr uint32_t MAX_GENERATION = (1u << (32 - INDEX_BITS)) - 1;
+	uint32_t value = 0;
+	uint32_t get_index() const { return this->value & INDEX_MASK; }
+	uint32_t get_generation() const { return this->value >> INDEX_BITS; }
+	explicit operator bool() const { return this->value != 0; }
+	bool operator==(const NodeHandle other) const { return this->value == other.value; }
+	bool operator!=(const NodeHandle other) const { return this->value != other.value; }
+};
+
+/**
+ * @brief Pooled storage for scene nodes.
+ * Nodes created through the pool live in contiguous slabs, one per node type, together with their
+ * reference count, instead of separate heap allocations. They are still handed out as std::shared_ptr,
+ * so the rest of the API is unchanged. Every node, pooled or not, is addressable by a NodeHandle.
+ */
+class ENG_API NodePool final {
+public:
+	NodePool();
+	NodePool(NodePool const &) = delete;
+	void operator=(NodePool const &) = delete;
+	~NodePool();
+	template <typename T, typename... Args>
+	std::shared_ptr<T> create(Args &&...args) {
+		return std::allocate_shared<T>(Allocator<T>(this), std::forward<Args>(args)...);
+	}
+	Node *get(const NodeHandle handle) const;
+	size_t get_node_count() const;
+	size_t get_pooled_count() const;
+	size_t get_reserved_bytes() const;
+	size_t trim();
+	static NodePool &get_shared();
+private:
+	friend class Node;
+	static constexpr size_t CHUNK_SIZE = 64 * 1024;
+	static constexpr size_t BLOCK_ALIGNMENT = 16;
+	static constexpr size_t MAX_BLOCK_SIZE = CHUNK_SIZE / 8;
+	template <typename U>
+	struct Allocator {
+		using value_type = U;
+		NodePool *pool;
+		explicit Allocator(NodePool *pool) : pool{ pool } {}
+		template <typename V>
+		Allocator(const Allocator<V> &other) : pool{ other.pool } {}
+		static constexpr bool POOLED = sizeof(U) <= MAX_BLOCK_SIZE && alignof(U) <= BLOCK_ALIGNMENT;
+		U *allocate(const size_t n) {
+			if (n == 1 && POOLED) return static_cast<U *>(this->pool->allocate(sizeof(U)));
+			return static_cast<U *>(::operator new(n * sizeof(U), std::align_val_t(alignof(U))));
+		}
+		void deallocate(U *ptr, const size_t n) {
+			if (n == 1 && POOLED) this->pool->deallocate(ptr);
+			else ::operator delete(ptr, std::align_val_t(alignof(U)));
+		}
+		template <typename V>
+		bool operator==(const Allocator<V> &other) const { return this->pool == other.pool; }
+		template <typename V>
+		bool operator!=(const Allocator<V> &other) const { return this->pool != other.pool; }
+	};
+	struct Slab;
+	struct Chunk {
+		Slab *slab;
+		void *free_list;
+		uint32_t used;
+		uint32_t position;
+	};
+	struct Slab {
+		size_t block_size;
+		size_t first_available;
+		std::vector<Chunk *> chunks;
+	};
+	struct Slot {
+		Node *node;
+		uint32_t generation;
+	};
+	void *allocate(const size_t size);
+	void deallocate(void *ptr);
+	NodeHandle acquire(Node &node);
+	void release(const NodeHandle handle);
+	static Chunk *new_chunk(Slab &slab);
+	mutable std::mutex mutex;
+	std::unordered_map<size_t, Slab> slabs;
+	std::vector<Slot> slots;
+	std::vector<uint32_t> free_slots;
+	size_t node_count;
+	size_t pooled_count;
+};
+
+}
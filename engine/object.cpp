@@ -1,24 +1,33 @@
 #include "object.h"
 
-#include <sstream>
+#include <atomic>
 #include <string>
 
 #include <glm/glm.hpp>
 
+#include "atom.h"
 #include "common.h"
 
 using namespace lrvg;
 
-int Object::next_id = 0;
+std::atomic<int> Object::next_id{ 0 };
 
 /**
  * Creates a new instance of Object with a unique ID and default name.
+ * The `id` is automatically assigned and incremented for each new object, atomically so that
+ * objects can be created on any thread.
+ * The default name, "[id]", is only built when first asked for.
+ */
+ENG_API Object::Object() : id{ Object::next_id.fetch_add(1, std::memory_order_relaxed) } {
+}
+
+/**
+ * Creates a new instance of Object with a specified name and unique ID.
  * The `id` is automatically assigned and incremented for each new object.
+ * 
+ * @param name The name to assign to the object.
  */
-ENG_API Object::Object() : id{ Object::next_id++ } {
-	std::stringstream ss;
-	ss << '[' << this->get_id() << ']';
-	this->name = ss.str();
+ENG_API Object::Object(const std::string name) : id{ Object::next_id.fetch_add(1, std::memory_order_relaxed) }, name{ name } {
 }
 
 /**
@@ -31,10 +40,10 @@ int ENG_API Object::get_id() const {
 }
 
 /**
- * Creates a new instance of Object with a specified name and unique ID.
- * The `id` is automatically assigned and incremented for each new object.
+ * Returns the local transformation matrix of the object.
+ * Default implementation returns the identity; can be overridden in derived classes.
  * 
- * @param name The name to assign to the object.
+ * @return The local transformation matrix.
  */
 glm::mat4 ENG_API Object::get_local_matrix() const {
 	return glm::mat4(1.0f);
@@ -52,18 +61,50 @@ int ENG_API Object::get_priority() const {
 
 /**
  * Retrieves the name of the object.
+ * Objects that were never named report their default name, "[id]".
  * 
  * @return The name of the object as a string.
  */
 std::string ENG_API Object::get_name() const {
+	if (LIKELY(!this->name.is_null())) return this->name.str();
+	return this->get_default_name();
+}
+
+/**
+ * Builds the default name of the object, "[id]".
+ * Default names are built on request and never interned, so that unnamed objects cost no atom.
+ * 
+ * @return The default name of the object.
+ */
+std::string ENG_API Object::get_default_name() const {
+	return '[' + std::to_string(this->id) + ']';
+}
+
+/**
+ * Retrieves the name of the object as an atom, for constant-time comparisons.
+ * 
+ * @return The name atom, or the null atom if the object was never named.
+ */
+Atom ENG_API Object::get_name_atom() const {
 	return this->name;
 }
 
+/**
+ * Checks whether the object was given a name, as opposed to using its default one.
+ * 
+ * @return True if the object has been named, false otherwise.
+ */
+bool ENG_API Object::has_name() const {
+	return !this->name.is_null();
+}
+
 /**
  * Sets the name of the object.
+ * The name is interned, so that objects sharing a name share its storage.
+ * An empty name restores the default name.
  * 
  * @param name The new name to assign to the object.
  */
 void ENG_API Object::set_name(const std::string name) {
-	this->name = name;
+	this->name = Atom(name);
 }
@@ -9,10 +9,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 
 #include <glm/glm.hpp>
 
+#include "atom.h"
 #include "common.h"
 
 namespace lrvg {
@@ -27,14 +29,17 @@ public:
     virtual ~Object() = default;
 	int get_id() const;
     std::string get_name() const;
-    void set_name(const std::string name);
+    std::string get_default_name() const;
+    Atom get_name_atom() const;
+    bool has_name() const;
+    virtual void set_name(const std::string name);
 	virtual glm::mat4 get_local_matrix() const;
 	virtual int get_priority() const;
 	virtual void render(const glm::mat4 world_matrix) const = 0;
 private:
-	static int next_id;
+	static std::atomic<int> next_id;
 	int id;
-	std::string name;
+	Atom name;
 };
 
 }
@@ -0,0 +1,437 @@
+/**
+ * @file	occlusion_culler.cpp
+ * @brief	CPU occlusion culler class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "occlusion_culler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+#include "thread_pool.h"
+
+#if defined(HAS_SSE2)
+#include <emmintrin.h>
+#elif defined(HAS_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace lrvg;
+
+/**
+ * Clip-space w below which a vertex is considered on or behind the camera plane.
+ */
+static constexpr float MIN_CLIP_W = 1e-5f;
+
+/**
+ * Clips a triangle against the far plane (z <= w in clip space).
+ * Parts beyond the far plane are cut off rather than having their depth clamped, since a clamped
+ * vertex would pull the depth of the whole triangle nearer than its real surface.
+ *
+ * @param c0 The first vertex, in clip space.
+ * @param c1 The second vertex, in clip space.
+ * @param c2 The third vertex, in clip space.
+ * @param polygon The clipped polygon, of up to four vertices.
+ * @return The number of vertices of the clipped polygon.
+ */
+static int clip_far(const glm::vec4 &c0, const glm::vec4 &c1, const glm::vec4 &c2, glm::vec4 polygon[4]) {
+	const glm::vec4 input[3] = { c0, c1, c2 };
+	int count = 0;
+	for (int i = 0; i < 3; i++) {
+		const glm::vec4 &a = input[i];
+		const glm::vec4 &b = input[(i + 1) % 3];
+		const float da = a.w - a.z;
+		const float db = b.w - b.z;
+		if (da >= 0.0f) polygon[count++] = a;
+		if ((da >= 0.0f) != (db >= 0.0f)) {
+			polygon[count++] = a + (b - a) * (da / (da - db));
+		}
+	}
+	return count;
+}
+
+/**
+ * Creates a new occlusion culler with a depth buffer of the given resolution.
+ *
+ * Default parameters:
+ * * Maximum number of automatically selected occluders: 8
+ *
+ * @param width The width of the CPU depth buffer in pixels.
+ * @param height The height of the CPU depth buffer in pixels.
+ */
+ENG_API OcclusionCuller::OcclusionCuller(const int width, const int height) {
+	this->set_resolution(width, height);
+	this->set_max_auto_occluders(8);
+	this->view_projection = glm::mat4(1.0f);
+	this->occluder_count = 0;
+	this->tested_count = 0;
+	this->culled_count = 0;
+	this->has_hierarchy = false;
+}
+
+/**
+ * Sets the resolution of the CPU depth buffer.
+ * Low resolutions (a few hundred pixels wide) are enough, as the buffer only drives conservative visibility tests.
+ *
+ * @param width The width of the depth buffer in pixels.
+ * @param height The height of the depth buffer in pixels.
+ */
+void ENG_API OcclusionCuller::set_resolution(const int width, const int height) {
+	this->width = std::max(width, 1);
+	this->height = std::max(height, 1);
+	this->levels.clear();
+	this->level_sizes.clear();
+	int w = this->width;
+	int h = this->height;
+	while (true) {
+		this->level_sizes.emplace_back(w, h);
+		this->levels.emplace_back((size_t)w * (size_t)h, 1.0f);
+		if (w == 1 && h == 1) break;
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+	}
+	this->has_hierarchy = false;
+}
+
+/**
+ * Sets the number of meshes picked as occluders when no mesh of the scene is explicitly flagged as occluder.
+ * The largest meshes on screen are selected. A value of 0 disables the automatic selection.
+ *
+ * @param max_auto_occluders The maximum number of automatically selected occluders.
+ */
+void ENG_API OcclusionCuller::set_max_auto_occluders(const int max_auto_occluders) {
+	this->max_auto_occluders = std::max(max_auto_occluders, 0);
+}
+
+/**
+ * Retrieves the width of the CPU depth buffer.
+ *
+ * @return The width in pixels.
+ */
+int ENG_API OcclusionCuller::get_width() const {
+	return this->width;
+}
+
+/**
+ * Retrieves the height of the CPU depth buffer.
+ *
+ * @return The height in pixels.
+ */
+int ENG_API OcclusionCuller::get_height() const {
+	return this->height;
+}
+
+/**
+ * Retrieves the number of meshes picked as occluders when none is explicitly flagged.
+ *
+ * @return The maximum number of automatically selected occluders.
+ */
+int ENG_API OcclusionCuller::get_max_auto_occluders() const {
+	return this->max_auto_occluders;
+}
+
+/**
+ * Retrieves the number of occluders rasterized in the current frame.
+ *
+ * @return The number of occluders.
+ */
+int ENG_API OcclusionCuller::get_occluder_count() const {
+	return this->occluder_count;
+}
+
+/**
+ * Retrieves the number of visibility tests performed in the current frame.
+ *
+ * @return The number of tested bounding boxes.
+ */
+int ENG_API OcclusionCuller::get_tested_count() const {
+	return this->tested_count;
+}
+
+/**
+ * Retrieves the number of bounding boxes found hidden in the current frame.
+ *
+ * @return The number of culled bounding boxes.
+ */
+int ENG_API OcclusionCuller::get_culled_count() const {
+	return this->culled_count;
+}
+
+/**
+ * Retrieves the full-resolution depth buffer, with depths in the [0, 1] range (1 being the far plane).
+ * Rows are stored bottom to top.
+ *
+ * @return A constant reference to the depth buffer.
+ */
+const std::vector<float> ENG_API &OcclusionCuller::get_depth_buffer() const {
+	return this->levels[0];
+}
+
+/**
+ * Starts a new culling frame: clears the occluders and the statistics of the previous frame.
+ *
+ * @param view_projection The combined projection and view matrix of the active camera.
+ */
+void ENG_API OcclusionCuller::begin_frame(const glm::mat4 view_projection) {
+	this->view_projection = view_projection;
+	this->triangles.clear();
+	this->occluder_count = 0;
+	this->tested_count = 0;
+	this->culled_count = 0;
+	this->has_hierarchy = false;
+}
+
+/**
+ * Transforms the triangles of an occluder to screen space and queues them for rasterization.
+ * Triangles crossing the camera plane are dropped and triangles crossing the far plane are clipped,
+ * which keeps the occlusion conservative.
+ *
+ * @param mesh The mesh to use as occluder.
+ * @param world_matrix The world transformation matrix of the mesh.
+ */
+void ENG_API OcclusionCuller::add_occluder(const Mesh &mesh, const glm::mat4 world_matrix) {
+	const std::vector<glm::vec3> &vertices = mesh.get_vertices();
+	if (UNLIKELY(vertices.empty())) return;
+	const glm::mat4 mvp = this->view_projection * world_matrix;
+	this->clip_vertices.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		this->clip_vertices[i] = mvp * glm::vec4(vertices[i], 1.0f);
+	}
+	const float half_w = 0.5f * (float)this->width;
+	const float half_h = 0.5f * (float)this->height;
+	const auto to_screen = [half_w, half_h](const glm::vec4 &clip) {
+		const float inv_w = 1.0f / clip.w;
+		return glm::vec3(
+			(clip.x * inv_w + 1.0f) * half_w,
+			(clip.y * inv_w + 1.0f) * half_h,
+			glm::clamp(clip.z * inv_w * 0.5f + 0.5f, 0.0f, 1.0f)
+		);
+	};
+	for (const auto &face : mesh.get_faces()) {
+		const glm::vec4 &c0 = this->clip_vertices[std::get<0>(face)];
+		const glm::vec4 &c1 = this->clip_vertices[std::get<1>(face)];
+		const glm::vec4 &c2 = this->clip_vertices[std::get<2>(face)];
+		if (c0.w < MIN_CLIP_W || c1.w < MIN_CLIP_W || c2.w < MIN_CLIP_W) continue;
+		if ((c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) || (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w)) continue;
+		if ((c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w)) continue;
+		if (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w) continue;
+		glm::vec4 polygon[4];
+		const int count = clip_far(c0, c1, c2, polygon);
+		for (int i = 2; i < count; i++) {
+			ScreenTriangle triangle{ to_screen(polygon[0]), to_screen(polygon[i - 1]), to_screen(polygon[i]) };
+			const float area =
+				(triangle.v1.x - triangle.v0.x) * (triangle.v2.y - triangle.v0.y) -
+				(triangle.v1.y - triangle.v0.y) * (triangle.v2.x - triangle.v0.x);
+			if (std::fabs(area) < 1e-6f) continue;
+			if (area < 0.0f) std::swap(triangle.v1, triangle.v2);
+			this->triangles.push_back(triangle);
+		}
+	}
+	this->occluder_count++;
+}
+
+/**
+ * Rasterizes the queued occluders into the depth buffer and builds the hierarchical-Z pyramid.
+ * The depth buffer is split in horizontal bands processed in parallel on the shared thread pool.
+ */
+void ENG_API OcclusionCuller::rasterize() {
+	std::fill(this->levels[0].begin(), this->levels[0].end(), 1.0f);
+	if (this->triangles.empty()) {
+		this->has_hierarchy = false;
+		return;
+	}
+	ThreadPool::get_shared().parallel_for((size_t)this->height, [this](const size_t begin, const size_t end) {
+		this->rasterize_rows((int)begin, (int)end);
+	});
+	this->build_hierarchy();
+	this->has_hierarchy = true;
+}
+
+/**
+ * Tests a bounding box against the hierarchical-Z pyramid.
+ * Boxes outside the view frustum are reported as hidden as well. The screen rectangle of the box is
+ * grown by one texel before the lookup, which keeps the test conservative along occluder edges.
+ *
+ * @param bounds_min The minimum corner of the local-space bounding box.
+ * @param bounds_max The maximum corner of the local-space bounding box.
+ * @param world_matrix The world transformation matrix of the box.
+ * @return true if the box may be visible, false if it is certainly hidden.
+ */
+bool ENG_API OcclusionCuller::is_visible(const glm::vec3 bounds_min, const glm::vec3 bounds_max, const glm::mat4 world_matrix) {
+	this->tested_count++;
+	const glm::mat4 mvp = this->view_projection * world_matrix;
+	glm::vec3 ndc_min(1e30f);
+	glm::vec3 ndc_max(-1e30f);
+	int outside[6] = { 0, 0, 0, 0, 0, 0 };
+	bool crosses_camera_plane = false;
+	for (int i = 0; i < 8; i++) {
+		const glm::vec3 corner(
+			(i & 1) ? bounds_max.x : bounds_min.x,
+			(i & 2) ? bounds_max.y : bounds_min.y,
+			(i & 4) ? bounds_max.z : bounds_min.z
+		);
+		const glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+		outside[0] += clip.x < -clip.w;
+		outside[1] += clip.x > clip.w;
+		outside[2] += clip.y < -clip.w;
+		outside[3] += clip.y > clip.w;
+		outside[4] += clip.z < -clip.w;
+		outside[5] += clip.z > clip.w;
+		if (clip.w < MIN_CLIP_W) {
+			crosses_camera_plane = true;
+			continue;
+		}
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		ndc_min = glm::min(ndc_min, ndc);
+		ndc_max = glm::max(ndc_max, ndc);
+	}
+	for (int i = 0; i < 6; i++) {
+		if (outside[i] == 8) {
+			this->culled_count++;
+			return false;
+		}
+	}
+	if (crosses_camera_plane || !this->has_hierarchy) return true;
+	const int x0 = std::max((int)std::floor((ndc_min.x * 0.5f + 0.5f) * (float)this->width), 0);
+	const int y0 = std::max((int)std::floor((ndc_min.y * 0.5f + 0.5f) * (float)this->height), 0);
+	const int x1 = std::min((int)std::floor((ndc_max.x * 0.5f + 0.5f) * (float)this->width), this->width - 1);
+	const int y1 = std::min((int)std::floor((ndc_max.y * 0.5f + 0.5f) * (float)this->height), this->height - 1);
+	if (x0 > x1 || y0 > y1) {
+		this->culled_count++;
+		return false;
+	}
+	// Occluders are sampled at texel centres, so a texel may hold their depth while they cover only
+	// part of it; the rectangle grows by one texel to reach beyond the edges of the occluders
+	const int grown_x0 = std::max(x0 - 1, 0);
+	const int grown_y0 = std::max(y0 - 1, 0);
+	const int grown_x1 = std::min(x1 + 1, this->width - 1);
+	const int grown_y1 = std::min(y1 + 1, this->height - 1);
+	// Pick the finest level where the rectangle spans at most 2x2 texels
+	size_t level = 0;
+	while (level + 1 < this->levels.size() && ((grown_x1 >> level) - (grown_x0 >> level) > 1 || (grown_y1 >> level) - (grown_y0 >> level) > 1)) {
+		level++;
+	}
+	const std::vector<float> &depth = this->levels[level];
+	const int level_width = this->level_sizes[level].x;
+	float max_depth = 0.0f;
+	for (int y = grown_y0 >> level; y <= grown_y1 >> level; y++) {
+		for (int x = grown_x0 >> level; x <= grown_x1 >> level; x++) {
+			max_depth = std::max(max_depth, depth[(size_t)y * level_width + x]);
+		}
+	}
+	const float box_depth = ndc_min.z * 0.5f + 0.5f;
+	if (box_depth > max_depth) {
+		this->culled_count++;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Rasterizes every queued triangle into the rows [y_begin, y_end) of the depth buffer,
+ * keeping the nearest depth per pixel. Pixels are evaluated four at a time when SIMD is available.
+ *
+ * @param y_begin The first row to rasterize.
+ * @param y_end One past the last row to rasterize.
+ */
+void OcclusionCuller::rasterize_rows(const int y_begin, const int y_end) {
+	std::vector<float> &depth = this->levels[0];
+	const int w = this->width;
+	for (const auto &triangle : this->triangles) {
+		const glm::vec3 &v0 = triangle.v0;
+		const glm::vec3 &v1 = triangle.v1;
+		const glm::vec3 &v2 = triangle.v2;
+		const int min_x = std::max((int)std::floor(std::min({ v0.x, v1.x, v2.x })), 0);
+		const int max_x = std::min((int)std::ceil(std::max({ v0.x, v1.x, v2.x })), w - 1);
+		const int min_y = std::max((int)std::floor(std::min({ v0.y, v1.y, v2.y })), y_begin);
+		const int max_y = std::min((int)std::ceil(std::max({ v0.y, v1.y, v2.y })), y_end - 1);
+		if (min_x > max_x || min_y > max_y) continue;
+		// Edge functions e(x, y) = a * x + b * y + c, positive inside the counter-clockwise triangle
+		const float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v1.y * v2.x;
+		const float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v2.y * v0.x;
+		const float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v0.y * v1.x;
+		const float inv_area = 1.0f / (c0 + c1 + c2);
+		// Depth plane z(x, y) = za * x + zb * y + zc
+		const float za = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * inv_area;
+		const float zb = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * inv_area;
+		const float zc = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * inv_area;
+		for (int y = min_y; y <= max_y; y++) {
+			const float py = (float)y + 0.5f;
+			const float row0 = b0 * py + c0;
+			const float row1 = b1 * py + c1;
+			const float row2 = b2 * py + c2;
+			const float rowz = zb * py + zc;
+			float *out = depth.data() + (size_t)y * w;
+			int x = min_x;
+#if defined(HAS_SSE2)
+			const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 zero = _mm_setzero_ps();
+			for (; x + 3 <= max_x; x += 4) {
+				const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+				const __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), px), _mm_set1_ps(row0));
+				const __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), px), _mm_set1_ps(row1));
+				const __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), px), _mm_set1_ps(row2));
+				const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+				const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px), _mm_set1_ps(rowz));
+				const __m128 old_z = _mm_loadu_ps(out + x);
+				const __m128 new_z = _mm_min_ps(old_z, z);
+				_mm_storeu_ps(out + x, _mm_or_ps(_mm_and_ps(inside, new_z), _mm_andnot_ps(inside, old_z)));
+			}
+#elif defined(HAS_NEON)
+			const float lane_offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+			const float32x4_t lanes = vld1q_f32(lane_offsets);
+			const float32x4_t zero = vdupq_n_f32(0.0f);
+			for (; x + 3 <= max_x; x += 4) {
+				const float32x4_t px = vaddq_f32(vdupq_n_f32((float)x), lanes);
+				const float32x4_t e0 = vmlaq_n_f32(vdupq_n_f32(row0), px, a0);
+				const float32x4_t e1 = vmlaq_n_f32(vdupq_n_f32(row1), px, a1);
+				const float32x4_t e2 = vmlaq_n_f32(vdupq_n_f32(row2), px, a2);
+				const uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(e0, zero), vcgeq_f32(e1, zero)), vcgeq_f32(e2, zero));
+				const float32x4_t z = vmlaq_n_f32(vdupq_n_f32(rowz), px, za);
+				const float32x4_t old_z = vld1q_f32(out + x);
+				vst1q_f32(out + x, vbslq_f32(inside, vminq_f32(old_z, z), old_z));
+			}
+#endif
+			for (; x <= max_x; x++) {
+				const float px = (float)x + 0.5f;
+				if (a0 * px + row0 < 0.0f || a1 * px + row1 < 0.0f || a2 * px + row2 < 0.0f) continue;
+				out[x] = std::min(out[x], za * px + rowz);
+			}
+		}
+	}
+}
+
+/**
+ * Builds the hierarchical-Z pyramid from the full-resolution depth buffer.
+ * Each texel of a coarser level stores the farthest depth of the texels it covers.
+ */
+void OcclusionCuller::build_hierarchy() {
+	for (size_t level = 1; level < this->levels.size(); level++) {
+		const std::vector<float> &src = this->levels[level - 1];
+		std::vector<float> &dst = this->levels[level];
+		const glm::ivec2 src_size = this->level_sizes[level - 1];
+		const glm::ivec2 dst_size = this->level_sizes[level];
+		for (int y = 0; y < dst_size.y; y++) {
+			const int sy0 = y * 2;
+			const int sy1 = std::min(sy0 + 1, src_size.y - 1);
+			for (int x = 0; x < dst_size.x; x++) {
+				const int sx0 = x * 2;
+				const int sx1 = std::min(sx0 + 1, src_size.x - 1);
+				dst[(size_t)y * dst_size.x + x] = std::max(
+					std::max(src[(size_t)sy0 * src_size.x + sx0], src[(size_t)sy0 * src_size.x + sx1]),
+					std::max(src[(size_t)sy1 * src_size.x + sx0], src[(size_t)sy1 * src_size.x + sx1])
+				);
+			}
+		}
+	}
+}
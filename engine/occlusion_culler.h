@@ -0,0 +1,63 @@
+/**
+ * @file	occlusion_culler.h
+ * @brief	CPU occlusion culler class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mesh.h"
+
+namespace lrvg {
+
+/**
+ * @brief Software occlusion culler. Occluders are rasterized into a low-resolution CPU depth buffer,
+ * from which a hierarchical-Z pyramid is built to test the screen-space bounds of candidate meshes.
+ */
+class ENG_API OcclusionCuller final {
+public:
+	OcclusionCuller(const int width = 256, const int height = 128);
+	void set_resolution(const int width, const int height);
+	void set_max_auto_occluders(const int max_auto_occluders);
+	int get_width() const;
+	int get_height() const;
+	int get_max_auto_occluders() const;
+	int get_occluder_count() const;
+	int get_tested_count() const;
+	int get_culled_count() const;
+	const std::vector<float> &get_depth_buffer() const;
+	void begin_frame(const glm::mat4 view_projection);
+	void add_occluder(const Mesh &mesh, const glm::mat4 world_matrix);
+	void rasterize();
+	bool is_visible(const glm::vec3 bounds_min, const glm::vec3 bounds_max, const glm::mat4 world_matrix);
+private:
+	struct ScreenTriangle {
+		glm::vec3 v0;
+		glm::vec3 v1;
+		glm::vec3 v2;
+	};
+	void rasterize_rows(const int y_begin, const int y_end);
+	void build_hierarchy();
+	int width;
+	int height;
+	int max_auto_occluders;
+	int occluder_count;
+	int tested_count;
+	int culled_count;
+	bool has_hierarchy;
+	glm::mat4 view_projection;
+	std::vector<glm::vec4> clip_vertices;
+	std::vector<ScreenTriangle> triangles;
+	std::vector<std::vector<float>> levels;
+	std::vector<glm::ivec2> level_sizes;
+};
+
+}
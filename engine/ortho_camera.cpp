@@ -47,6 +47,21 @@ float ENG_API OrthoCamera::get_zoom() const {
 	return this->zoom;
 }
 
+/**
+ * Computes the orthographic projection matrix of the camera.
+ * The matrix is built from the camera's zoom level, the window dimensions and the clipping planes.
+ * 
+ * @return A glm::mat4 representing the projection matrix.
+ */
+glm::mat4 ENG_API OrthoCamera::get_projection_matrix() const {
+    const float width = static_cast<float>(this->window_width);
+    const float height = static_cast<float>(this->window_height);
+    const float max = std::max(width, height);
+    const float w = (width / max) * (this->zoom);
+    const float h = (height / max) * (this->zoom);
+    return glm::ortho(-w / 2.0f, w / 2.0f, -h / 2.0f, h / 2.0f, this->near_clipping, this->far_clipping);
+}
+
 /**
  * Renders the scene from the perspective of the orthographic camera.
  * This method sets up the orthographic projection matrix based on the camera's zoom level and window dimensions,
@@ -57,12 +72,7 @@ float ENG_API OrthoCamera::get_zoom() const {
 void ENG_API OrthoCamera::render(const glm::mat4 world_matrix) const {
     if (!this->is_active) return;
     Node::render(world_matrix);
-    const float width = static_cast<float>(this->window_width);
-    const float height = static_cast<float>(this->window_height);
-    const float max = std::max(width, height);
-    const float w = (width / max) * (this->zoom);
-    const float h = (height / max) * (this->zoom);
-    const glm::mat4 ortho_matrix = glm::ortho(-w / 2.0f, w / 2.0f, -h / 2.0f, h / 2.0f, this->near_clipping, this->far_clipping);
+    const glm::mat4 ortho_matrix = this->get_projection_matrix();
     glMatrixMode(GL_PROJECTION);
     glLoadMatrixf(glm::value_ptr(ortho_matrix));
 }
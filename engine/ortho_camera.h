@@ -24,6 +24,7 @@ public:
 	OrthoCamera();
 	float get_zoom() const;
     void set_zoom(float zoom);
+	glm::mat4 get_projection_matrix() const override;
 	void render(const glm::mat4 world_matrix) const override;
 private:
 	float zoom;
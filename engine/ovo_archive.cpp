@@ -0,0 +1,261 @@
+/**
+ * @file	ovo_archive.cpp
+ * @brief	Compressed OVO container class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "ovo_archive.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "common.h"
+#include "lz_codec.h"
+#include "mapped_file.h"
+#include "ovo_parser.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+/**
+ * Signature at the start of every compressed OVO file.
+ */
+static constexpr char MAGIC[8] = { 'L', 'R', 'V', 'G', 'O', 'V', 'Z', '\0' };
+
+/**
+ * Width of the lanes bytes are shuffled into, that of the floats and packed values of OVO chunks.
+ */
+static constexpr size_t SHUFFLE_WIDTH = 4;
+
+/**
+ * Shuffles bytes into lanes: the first byte of every group of four, then the second, and so on.
+ * Trailing bytes that do not fill a group are kept at the end as they are.
+ *
+ * @param src Pointer to the bytes.
+ * @param size Number of bytes.
+ * @param dst Pointer to the shuffled bytes.
+ */
+static void shuffle(const uint8_t *src, const size_t size, uint8_t *dst) {
+	const size_t count = size / SHUFFLE_WIDTH;
+	for (size_t i = 0; i < count; i++) {
+		for (size_t lane = 0; lane < SHUFFLE_WIDTH; lane++) {
+			dst[lane * count + i] = src[i * SHUFFLE_WIDTH + lane];
+		}
+	}
+	memcpy(dst + count * SHUFFLE_WIDTH, src + count * SHUFFLE_WIDTH, size - count * SHUFFLE_WIDTH);
+}
+
+/**
+ * Restores bytes shuffled into lanes by `shuffle`.
+ *
+ * @param src Pointer to the shuffled bytes.
+ * @param size Number of bytes.
+ * @param dst Pointer to the restored bytes.
+ */
+static void unshuffle(const uint8_t *src, const size_t size, uint8_t *dst) {
+	const size_t count = size / SHUFFLE_WIDTH;
+	for (size_t i = 0; i < count; i++) {
+		for (size_t lane = 0; lane < SHUFFLE_WIDTH; lane++) {
+			dst[i * SHUFFLE_WIDTH + lane] = src[lane * count + i];
+		}
+	}
+	memcpy(dst + count * SHUFFLE_WIDTH, src + count * SHUFFLE_WIDTH, size - count * SHUFFLE_WIDTH);
+}
+
+/**
+ * Compresses an OVO file into a compressed OVO file.
+ *
+ * @param source_path The path of the OVO file.
+ * @param path The path of the compressed file to write.
+ * @return Whether the compressed file was written.
+ */
+bool ENG_API OVOArchive::write(const std::string &source_path, const std::string &path) {
+	const MappedFile source(source_path);
+	if (UNLIKELY(!source.is_open())) {
+		ERROR("Failed to read file '%s'", source_path.c_str());
+		return false;
+	}
+	if (OVOArchive::is_compressed(source.data(), source.size())) {
+		ERROR("File '%s' is already compressed", source_path.c_str());
+		return false;
+	}
+	return OVOArchive::write(source.data(), source.size(), path);
+}
+
+/**
+ * Compresses OVO data into a compressed OVO file.
+ * Chunks are compressed in parallel, each with the codec that makes it smallest. The file is written
+ * next to its final path and then renamed, so that an interrupted write never leaves a partial file behind.
+ *
+ * @param data Pointer to the OVO data.
+ * @param size Size of the OVO data.
+ * @param path The path of the compressed file to write.
+ * @return Whether the compressed file was written.
+ */
+bool ENG_API OVOArchive::write(const uint8_t *data, const size_t size, const std::string &path) {
+	UNREF const auto start_time = std::chrono::steady_clock::now();
+	const std::vector<OVOParser::Chunk> chunks = OVOParser::scan_chunks(data, size);
+	std::vector<std::vector<uint8_t>> blobs(chunks.size());
+	std::vector<ChunkRecord> records(chunks.size());
+	ThreadPool::get_shared().parallel_for_each(chunks.size(), [&](const size_t i) {
+		const OVOParser::Chunk &chunk = chunks[i];
+		ChunkRecord &record = records[i];
+		std::vector<uint8_t> &blob = blobs[i];
+		record = ChunkRecord{ chunk.type, chunk.size, chunk.size, Codec::Stored, 0 };
+		if (chunk.size == 0) return;
+		blob.resize(LZCodec::get_max_compressed_size(chunk.size));
+		const size_t plain_size = LZCodec::compress(chunk.data, chunk.size, blob.data());
+		if (plain_size < record.compressed_size) {
+			record.compressed_size = (uint32_t)plain_size;
+			record.codec = Codec::LZ;
+		}
+		std::vector<uint8_t> shuffled(chunk.size);
+		shuffle(chunk.data, chunk.size, shuffled.data());
+		std::vector<uint8_t> candidate(blob.size());
+		const size_t shuffled_size = LZCodec::compress(shuffled.data(), chunk.size, candidate.data());
+		if (shuffled_size < record.compressed_size) {
+			record.compressed_size = (uint32_t)shuffled_size;
+			record.codec = Codec::ShuffledLZ;
+			blob.swap(candidate);
+		}
+		if (record.codec == Codec::Stored) {
+			blob.assign(chunk.data, chunk.data + chunk.size);
+		}
+		blob.resize(record.compressed_size);
+	});
+
+	const std::string temp_path = path + ".tmp";
+	FILE *file = fopen(temp_path.c_str(), "wb");
+	if (UNLIKELY(file == nullptr)) {
+		ERROR("Failed to write file '%s'", temp_path.c_str());
+		return false;
+	}
+	Header header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = OVOArchive::VERSION;
+	header.chunk_count = (uint32_t)chunks.size();
+	header.image_size = 0;
+	uint64_t offset = sizeof(Header);
+	fwrite(&header, sizeof(Header), 1, file);
+	for (size_t i = 0; i < chunks.size(); i++) {
+		records[i].offset = offset;
+		if (!blobs[i].empty()) fwrite(blobs[i].data(), 1, blobs[i].size(), file);
+		offset += blobs[i].size();
+		header.image_size += 2 * sizeof(uint32_t) + chunks[i].size;
+	}
+	header.chunk_table_offset = offset;
+	if (!records.empty()) fwrite(records.data(), sizeof(ChunkRecord), records.size(), file);
+	offset += records.size() * sizeof(ChunkRecord);
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(Header), 1, file);
+	const bool failed = ferror(file) != 0;
+	fclose(file);
+	std::error_code error;
+	if (!failed) std::filesystem::rename(temp_path, path, error);
+	if (UNLIKELY(failed || error)) {
+		ERROR("Failed to write file '%s'", path.c_str());
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+	DEBUG("Compressed %zu chunks into '%s': %.2f MB -> %.2f MB (%.2fx), in %.1f ms.", chunks.size(), path.c_str(),
+		(double)header.image_size / (1024.0 * 1024.0), (double)offset / (1024.0 * 1024.0), offset > 0 ? (double)header.image_size / (double)offset : 0.0,
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+	return true;
+}
+
+/**
+ * Checks whether data is a compressed OVO file, from its signature.
+ *
+ * @param data Pointer to the data.
+ * @param size Size of the data.
+ * @return Whether the data is a compressed OVO file.
+ */
+bool ENG_API OVOArchive::is_compressed(const uint8_t *data, const size_t size) {
+	return size >= sizeof(Header) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * Decompresses a compressed OVO file into the plain OVO layout.
+ * Chunk headers are laid out first, then the chunks are decompressed in parallel straight into
+ * their place in the image; only shuffled chunks go through a scratch buffer.
+ *
+ * @param data Pointer to the compressed data.
+ * @param size Size of the compressed data.
+ * @param image The vector to fill with the plain OVO data.
+ * @return Whether the data was valid and fully decompressed.
+ */
+bool ENG_API OVOArchive::decompress(const uint8_t *data, const size_t size, std::vector<uint8_t> &image) {
+	UNREF const auto start_time = std::chrono::steady_clock::now();
+	if (!OVOArchive::is_compressed(data, size)) return false;
+	Header header;
+	memcpy(&header, data, sizeof(Header));
+	if (UNLIKELY(header.version != OVOArchive::VERSION || header.chunk_table_offset > size ||
+			(uint64_t)header.chunk_count * sizeof(ChunkRecord) > size - header.chunk_table_offset)) {
+		ERROR("Corrupted compressed OVO data");
+		return false;
+	}
+	std::vector<ChunkRecord> records(header.chunk_count);
+	std::vector<uint64_t> image_offsets(header.chunk_count);
+	uint64_t image_size = 0;
+	for (uint32_t i = 0; i < header.chunk_count; i++) {
+		ChunkRecord &record = records[i];
+		memcpy(&record, data + header.chunk_table_offset + i * sizeof(ChunkRecord), sizeof(ChunkRecord));
+		if (UNLIKELY(record.offset > size || record.compressed_size > size - record.offset || record.codec > Codec::ShuffledLZ ||
+				(record.codec == Codec::Stored && record.compressed_size != record.size))) {
+			ERROR("Corrupted compressed OVO data");
+			return false;
+		}
+		image_offsets[i] = image_size + 2 * sizeof(uint32_t);
+		image_size += 2 * sizeof(uint32_t) + record.size;
+	}
+	if (UNLIKELY(image_size != header.image_size)) {
+		ERROR("Corrupted compressed OVO data");
+		return false;
+	}
+	image.resize(image_size);
+	for (uint32_t i = 0; i < header.chunk_count; i++) {
+		memcpy(image.data() + image_offsets[i] - 2 * sizeof(uint32_t), &records[i].type, sizeof(uint32_t));
+		memcpy(image.data() + image_offsets[i] - sizeof(uint32_t), &records[i].size, sizeof(uint32_t));
+	}
+	std::atomic<bool> valid{ true };
+	ThreadPool::get_shared().parallel_for_each(records.size(), [&](const size_t i) {
+		const ChunkRecord &record = records[i];
+		const uint8_t *src = data + record.offset;
+		uint8_t *dst = image.data() + image_offsets[i];
+		bool decoded = true;
+		if (record.codec == Codec::Stored) {
+			if (record.size > 0) memcpy(dst, src, record.size);
+		} else if (record.codec == Codec::LZ) {
+			decoded = LZCodec::decompress(src, record.compressed_size, dst, record.size);
+		} else {
+			std::vector<uint8_t> scratch(record.size);
+			decoded = LZCodec::decompress(src, record.compressed_size, scratch.data(), record.size);
+			if (decoded) unshuffle(scratch.data(), record.size, dst);
+		}
+		if (UNLIKELY(!decoded)) valid = false;
+	});
+	if (UNLIKELY(!valid)) {
+		ERROR("Corrupted compressed OVO data");
+		image.clear();
+		return false;
+	}
+	DEBUG("Decompressed %u chunks: %.2f MB -> %.2f MB in %.1f ms.", header.chunk_count, (double)size / (1024.0 * 1024.0),
+		(double)image_size / (1024.0 * 1024.0), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+	return true;
+}
+
+/**
+ * Gets the path of the compressed variant of an OVO file, next to it.
+ *
+ * @param source_path The path of the OVO file.
+ * @return The path of the compressed file.
+ */
+std::string ENG_API OVOArchive::get_default_path(const std::string &source_path) {
+	return std::filesystem::path(source_path).replace_extension(".ovz").string();
+}
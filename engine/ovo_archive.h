@@ -0,0 +1,59 @@
+/**
+ * @file	ovo_archive.h
+ * @brief	Compressed OVO container class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Compressed variant of OVO files, where each chunk is compressed on its own.
+ * Chunks are stored with `LZCodec`, either as they are or with their bytes first shuffled into
+ * four lanes, which groups the similar bytes of float arrays; whichever is smaller is kept, and
+ * chunks that do not compress are stored raw. Decompression rebuilds the plain OVO layout in
+ * memory, decompressing the chunks in parallel straight into their place, so that every loader
+ * can read compressed files like plain ones.
+ */
+class ENG_API OVOArchive final {
+public:
+	static constexpr uint32_t VERSION = 1;
+	static bool write(const std::string &source_path, const std::string &path);
+	static bool write(const uint8_t *data, const size_t size, const std::string &path);
+	static bool is_compressed(const uint8_t *data, const size_t size);
+	static bool decompress(const uint8_t *data, const size_t size, std::vector<uint8_t> &image);
+	static std::string get_default_path(const std::string &source_path);
+private:
+	enum class Codec : uint32_t {
+		Stored,
+		LZ,
+		ShuffledLZ
+	};
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t chunk_count;
+		uint64_t image_size;
+		uint64_t chunk_table_offset;
+	};
+	struct ChunkRecord {
+		uint32_t type;
+		uint32_t size;
+		uint32_t compressed_size;
+		Codec codec;
+		uint64_t offset;
+	};
+};
+
+}
@@ -0,0 +1,331 @@
+/**
+ * @file	ovo_index.cpp
+ * @brief	OVO chunk index class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "ovo_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "ovo_archive.h"
+#include "ovo_parser.h"
+#include "scene_cache.h"
+
+using namespace lrvg;
+
+/**
+ * Signature at the start of every index file.
+ */
+static constexpr char MAGIC[8] = { 'L', 'R', 'V', 'G', 'I', 'D', 'X', '\0' };
+
+/**
+ * Gets the modification time of a file, as stored in index headers.
+ *
+ * @param path The path of the file.
+ * @return The modification time, or 0 if it cannot be read.
+ */
+static int64_t get_file_time(const std::string &path) {
+	std::error_code error;
+	const auto time = std::filesystem::last_write_time(path, error);
+	return error ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+/**
+ * Checks whether a chunk type is a node of the scene hierarchy.
+ *
+ * @param type The chunk type.
+ * @return Whether chunks of this type are nodes.
+ */
+static bool is_node_type(const uint32_t type) {
+	return type == 1 || type == 16 || type == 18;
+}
+
+/**
+ * Builds the index of OVO data, reading only the chunk headers and names.
+ * The hierarchy is walked as the parser does, from the child counts of the nodes.
+ *
+ * @param data Pointer to the OVO data.
+ * @param size Size of the OVO data.
+ * @return The index of the chunks, in file order.
+ */
+OVOIndex ENG_API OVOIndex::build(const uint8_t *data, const size_t size) {
+	OVOIndex index;
+	const std::vector<OVOParser::Chunk> chunks = OVOParser::scan_chunks(data, size);
+	index.entries.reserve(chunks.size());
+	// The file holds a single top-level node, under which the whole scene hangs
+	std::vector<std::pair<int32_t, uint32_t>> hierarchy{ { -1, 1 } };
+	for (const OVOParser::Chunk &chunk : chunks) {
+		Entry entry{ (uint64_t)(chunk.data - data), chunk.type, chunk.size, -1, 0, std::string() };
+		if ((chunk.type == 9 || is_node_type(chunk.type)) && chunk.size > 0) {
+			entry.name = OVOParser::parse_string(chunk.data, chunk.size);
+		}
+		if (is_node_type(chunk.type)) {
+			const size_t count_offset = entry.name.length() + 1 + sizeof(glm::mat4);
+			if (count_offset + sizeof(uint32_t) <= chunk.size) {
+				memcpy(&entry.child_count, chunk.data + count_offset, sizeof(uint32_t));
+			}
+			if (!hierarchy.empty()) {
+				entry.parent = hierarchy.back().first;
+				hierarchy.back().second--;
+			}
+			hierarchy.emplace_back((int32_t)index.entries.size(), entry.child_count);
+		}
+		index.entries.push_back(std::move(entry));
+		while (!hierarchy.empty() && hierarchy.back().second == 0) {
+			hierarchy.pop_back();
+		}
+	}
+	return index;
+}
+
+/**
+ * Gets the index of an OVO file, building it from the file or reading it from its sidecar.
+ *
+ * @param source_path The path of the OVO file.
+ * @param persist Whether to read the index from its sidecar file, and write it there when missing or stale.
+ * @return The index of the chunks, empty if the file cannot be read.
+ */
+OVOIndex ENG_API OVOIndex::from_file(const std::string &source_path, const bool persist) {
+	const MappedFile source(source_path);
+	if (UNLIKELY(!source.is_open())) {
+		ERROR("Failed to read file '%s'", source_path.c_str());
+		return OVOIndex();
+	}
+	if (OVOArchive::is_compressed(source.data(), source.size())) {
+		std::vector<uint8_t> image;
+		if (UNLIKELY(!OVOArchive::decompress(source.data(), source.size(), image))) {
+			ERROR("Failed to decompress file '%s'", source_path.c_str());
+			return OVOIndex();
+		}
+		return OVOIndex::load_or_build(source_path, source, image.data(), image.size(), persist);
+	}
+	return OVOIndex::load_or_build(source_path, source, source.data(), source.size(), persist);
+}
+
+/**
+ * Gets the index of an already mapped OVO file, building it or reading it from its sidecar.
+ * Offsets refer to the plain OVO data, which for compressed files is their decompressed image.
+ *
+ * @param source_path The path of the OVO file.
+ * @param source The mapped OVO file.
+ * @param data Pointer to the plain OVO data.
+ * @param size Size of the plain OVO data.
+ * @param persist Whether to read the index from its sidecar file, and write it there when missing or stale.
+ * @return The index of the chunks.
+ */
+OVOIndex ENG_API OVOIndex::load_or_build(const std::string &source_path, const MappedFile &source, const uint8_t *data, const size_t size, const bool persist) {
+	const std::string path = OVOIndex::get_default_path(source_path);
+	OVOIndex index;
+	if (persist && index.read(path, source_path, source, size)) {
+		return index;
+	}
+	index = OVOIndex::build(data, size);
+	if (persist) {
+		index.write(path, source_path, source);
+	}
+	return index;
+}
+
+/**
+ * Gets the path of the index sidecar of an OVO file, next to it.
+ *
+ * @param source_path The path of the OVO file.
+ * @return The path of the index file.
+ */
+std::string ENG_API OVOIndex::get_default_path(const std::string &source_path) {
+	return std::filesystem::path(source_path).replace_extension(".ovoidx").string();
+}
+
+/**
+ * Checks whether a filter lets everything through.
+ *
+ * @param filter The filter.
+ * @return Whether the filter is empty.
+ */
+bool ENG_API OVOIndex::is_empty(const OVOFilter &filter) {
+	return filter.names.empty() && filter.path_prefixes.empty() && filter.chunk_types.empty();
+}
+
+/**
+ * Retrieves the entries of the index, one per chunk, in file order.
+ * Parents always come before their children.
+ *
+ * @return The entries.
+ */
+const std::vector<OVOIndex::Entry> ENG_API &OVOIndex::get_entries() const {
+	return this->entries;
+}
+
+/**
+ * Gets the path of a chunk, from the top of the hierarchy down to the chunk itself.
+ *
+ * @param index The index of the entry.
+ * @return The names of the chunk and its ancestors, separated by slashes.
+ */
+std::string ENG_API OVOIndex::get_path(const size_t index) const {
+	std::string path = this->entries[index].name;
+	for (int32_t parent = this->entries[index].parent; parent >= 0; parent = this->entries[parent].parent) {
+		path = this->entries[parent].name + "/" + path;
+	}
+	return path;
+}
+
+/**
+ * Finds the first chunk with a name.
+ *
+ * @param name The name of the chunk.
+ * @return The index of the entry, or -1 if there is none.
+ */
+int ENG_API OVOIndex::find(const std::string &name) const {
+	for (size_t i = 0; i < this->entries.size(); i++) {
+		if (this->entries[i].name == name) return (int)i;
+	}
+	return -1;
+}
+
+/**
+ * Selects the chunks to load for a filter: the matching chunks and their subtrees, plus the
+ * ancestors of those, which are only needed for their transforms.
+ *
+ * @param filter The filter.
+ * @return The selection of each entry.
+ */
+std::vector<OVOSelection> ENG_API OVOIndex::select(const OVOFilter &filter) const {
+	std::vector<OVOSelection> selection(this->entries.size(), OVOSelection::Skipped);
+	const bool everything = OVOIndex::is_empty(filter);
+	for (size_t i = 0; i < this->entries.size(); i++) {
+		const int32_t parent = this->entries[i].parent;
+		if (everything || (parent >= 0 && selection[parent] == OVOSelection::Included) || this->matches(i, filter)) {
+			selection[i] = OVOSelection::Included;
+		}
+	}
+	for (size_t i = this->entries.size(); i-- > 0;) {
+		if (selection[i] == OVOSelection::Skipped) continue;
+		for (int32_t parent = this->entries[i].parent; parent >= 0 && selection[parent] == OVOSelection::Skipped; parent = this->entries[parent].parent) {
+			selection[parent] = OVOSelection::Ancestor;
+		}
+	}
+	return selection;
+}
+
+/**
+ * Checks whether a chunk matches a filter by itself, regardless of its ancestors.
+ *
+ * @param index The index of the entry.
+ * @param filter The filter.
+ * @return Whether the chunk matches.
+ */
+bool ENG_API OVOIndex::matches(const size_t index, const OVOFilter &filter) const {
+	const Entry &entry = this->entries[index];
+	if (std::find(filter.chunk_types.begin(), filter.chunk_types.end(), entry.type) != filter.chunk_types.end()) return true;
+	if (entry.name.empty()) return false;
+	if (std::find(filter.names.begin(), filter.names.end(), entry.name) != filter.names.end()) return true;
+	if (filter.path_prefixes.empty()) return false;
+	const std::string path = this->get_path(index);
+	for (const std::string &prefix : filter.path_prefixes) {
+		if (path.compare(0, prefix.length(), prefix) == 0) return true;
+	}
+	return false;
+}
+
+/**
+ * Reads the index from its sidecar file, if it is up to date with the OVO file.
+ *
+ * @param path The path of the index file.
+ * @param source_path The path of the OVO file.
+ * @param source The mapped OVO file.
+ * @param size Size of the plain OVO data the entries must lie in.
+ * @return Whether the index was read.
+ */
+bool ENG_API OVOIndex::read(const std::string &path, const std::string &source_path, const MappedFile &source, const size_t size) {
+	const MappedFile file(path);
+	if (!file.is_open() || file.size() < sizeof(Header)) return false;
+	Header header;
+	memcpy(&header, file.data(), sizeof(Header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != OVOIndex::VERSION || header.source_size != source.size()) {
+		return false;
+	}
+	if (get_file_time(source_path) != header.source_time && SceneCache::hash(source.data(), source.size()) != header.source_hash) {
+		DEBUG("Chunk index '%s' is out of date.", path.c_str());
+		return false;
+	}
+	const uint64_t records_size = (uint64_t)header.entry_count * sizeof(Record);
+	if (UNLIKELY(file.size() - sizeof(Header) < records_size || file.size() - sizeof(Header) - records_size != header.names_size)) {
+		ERROR("Corrupted chunk index '%s'", path.c_str());
+		return false;
+	}
+	const uint8_t *records = file.data() + sizeof(Header);
+	const char *names = (const char *)(records + records_size);
+	std::vector<Entry> entries(header.entry_count);
+	for (uint32_t i = 0; i < header.entry_count; i++) {
+		Record record;
+		memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+		if (UNLIKELY(record.offset > size || record.size > size - record.offset || record.parent >= (int32_t)i ||
+				(uint64_t)record.name_offset + record.name_length > header.names_size)) {
+			ERROR("Corrupted chunk index '%s'", path.c_str());
+			return false;
+		}
+		entries[i] = Entry{ record.offset, record.type, record.size, record.parent, record.child_count, std::string(names + record.name_offset, record.name_length) };
+	}
+	this->entries = std::move(entries);
+	return true;
+}
+
+/**
+ * Writes the index to its sidecar file.
+ * The file is written next to its final path and then renamed, so that an interrupted write never
+ * leaves a partial index behind.
+ *
+ * @param path The path of the index file.
+ * @param source_path The path of the OVO file.
+ * @param source The mapped OVO file.
+ * @return Whether the index was written.
+ */
+bool ENG_API OVOIndex::write(const std::string &path, const std::string &source_path, const MappedFile &source) const {
+	Header header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = OVOIndex::VERSION;
+	header.entry_count = (uint32_t)this->entries.size();
+	header.source_size = source.size();
+	header.source_time = get_file_time(source_path);
+	header.source_hash = SceneCache::hash(source.data(), source.size());
+	std::vector<Record> records(this->entries.size());
+	std::string names;
+	for (size_t i = 0; i < this->entries.size(); i++) {
+		const Entry &entry = this->entries[i];
+		records[i] = Record{ entry.offset, entry.type, entry.size, entry.parent, entry.child_count, (uint32_t)names.size(), (uint32_t)entry.name.size() };
+		names += entry.name;
+	}
+	header.names_size = names.size();
+	const std::string temp_path = path + ".tmp";
+	FILE *file = fopen(temp_path.c_str(), "wb");
+	if (UNLIKELY(file == nullptr)) {
+		ERROR("Failed to write file '%s'", temp_path.c_str());
+		return false;
+	}
+	fwrite(&header, sizeof(Header), 1, file);
+	if (!records.empty()) fwrite(records.data(), sizeof(Record), records.size(), file);
+	if (!names.empty()) fwrite(names.data(), 1, names.size(), file);
+	const bool failed = ferror(file) != 0;
+	fclose(file);
+	std::error_code error;
+	if (!failed) std::filesystem::rename(temp_path, path, error);
+	if (UNLIKELY(failed || error)) {
+		ERROR("Failed to write file '%s'", path.c_str());
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+	DEBUG("Chunk index of '%s' written to '%s': %zu chunks.", source_path.c_str(), path.c_str(), this->entries.size());
+	return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file	ovo_index.h
+ * @brief	OVO chunk index class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "mapped_file.h"
+
+namespace lrvg {
+
+/**
+ * @brief Restricts an OVO load to some parts of the file.
+ * A chunk matches if its name is one of `names`, its path starts with one of `path_prefixes`, or
+ * its type is one of `chunk_types`. Matching nodes are loaded with their whole subtree, and with
+ * their ancestors as plain nodes so that they keep their place; materials are loaded only if they
+ * match or are used by a loaded mesh. An empty filter loads everything.
+ */
+struct ENG_API OVOFilter {
+	std::vector<std::string> names;
+	std::vector<std::string> path_prefixes;
+	std::vector<uint32_t> chunk_types;
+};
+
+/**
+ * @brief How a chunk takes part in a filtered load.
+ */
+enum class OVOSelection : uint8_t {
+	Skipped,
+	Ancestor,
+	Included
+};
+
+/**
+ * @brief Index of the chunks of an OVO file: their offsets, types, names and parent links.
+ * The index only reads chunk headers and names, so it is much cheaper to build than a full load,
+ * and can be persisted in a sidecar file next to the OVO file. Paths are the names of the nodes
+ * from the top of the hierarchy down, separated by slashes.
+ */
+class ENG_API OVOIndex final {
+public:
+	static constexpr uint32_t VERSION = 1;
+	struct Entry {
+		uint64_t offset;
+		uint32_t type;
+		uint32_t size;
+		int32_t parent;
+		uint32_t child_count;
+		std::string name;
+	};
+	static OVOIndex build(const uint8_t *data, const size_t size);
+	static OVOIndex from_file(const std::string &source_path, const bool persist = false);
+	static OVOIndex load_or_build(const std::string &source_path, const MappedFile &source, const uint8_t *data, const size_t size, const bool persist);
+	static std::string get_default_path(const std::string &source_path);
+	static bool is_empty(const OVOFilter &filter);
+	const std::vector<Entry> &get_entries() const;
+	std::string get_path(const size_t index) const;
+	int find(const std::string &name) const;
+	std::vector<OVOSelection> select(const OVOFilter &filter) const;
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t entry_count;
+		uint64_t source_size;
+		int64_t source_time;
+		uint64_t source_hash;
+		uint64_t names_size;
+	};
+	struct Record {
+		uint64_t offset;
+		uint32_t type;
+		uint32_t size;
+		int32_t parent;
+		uint32_t child_count;
+		uint32_t name_offset;
+		uint32_t name_length;
+	};
+	bool read(const std::string &path, const std::string &source_path, const MappedFile &source, const size_t size);
+	bool write(const std::string &path, const std::string &source_path, const MappedFile &source) const;
+	bool matches(const size_t index, const OVOFilter &filter) const;
+	std::vector<Entry> entries;
+};
+
+}
@@ -2,108 +2,644 @@
 #include "directional_light.h"
 #include "glm/common.hpp"
 #include "glm/gtc/packing.hpp"
+#include "lazy_mesh_loader.h"
 #include "material.h"
+#include "mapped_file.h"
 #include "mesh.h"
+#include "mesh_builder.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlet.h"
+#include "node_pool.h"
+#include "ovo_archive.h"
 #include "common.h"
 #include "point_light.h"
+#include "scene_load_handle.h"
 #include "spot_light.h"
+#include "texture.h"
+#include "thread_pool.h"
+#include "vertex_decoder.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <stack>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #define GLM_ENABLE_EXPERIMENTAL
 
 using namespace lrvg;
 
 /**
- * Material library used during OVO parsing.
+ * Checks whether some bytes can be read from a chunk.
+ *
+ * @param ptr The offset of the bytes in the chunk.
+ * @param size Size of the chunk.
+ * @param count The number of bytes to read.
+ * @return Whether the bytes lie within the chunk.
  */
-std::unordered_map<std::string, std::shared_ptr<Material>> OVOParser::materials;
+static INLINE bool fits(const uint64_t ptr, const uint64_t size, const uint64_t count) {
+    return ptr <= size && count <= size - ptr;
+}
 
 /**
- * Parses an OVO file and constructs the scene graph. 
+ * Guards the default settings and the statistics of the static interface.
+ */
+std::mutex OVOParser::defaults_mutex;
+
+/**
+ * Settings of the parsers created from now on.
+ */
+OVOParserSettings OVOParser::default_settings{};
+
+/**
+ * Statistics of the last file loaded through `from_file`.
+ */
+OVOLoadStats OVOParser::load_stats{};
+
+/**
+ * Creates a new OVO parser.
+ *
+ * @param settings How the parser processes the meshes it loads (default: the current default settings).
+ */
+ENG_API OVOParser::OVOParser(const OVOParserSettings &settings) : settings{ settings }, stats{}, progress{ 0.0f } {}
+
+/**
+ * Retrieves the settings of the parser.
+ *
+ * @return The settings.
+ */
+const OVOParserSettings ENG_API &OVOParser::get_settings() const {
+    return this->settings;
+}
+
+/**
+ * Gets the statistics of the last file loaded by this parser.
+ *
+ * @return The size, chunk count, timings and throughput of the last load.
+ */
+const OVOLoadStats ENG_API &OVOParser::get_stats() const {
+    return this->stats;
+}
+
+/**
+ * Retrieves how far the file being loaded by this parser is, from any thread.
+ * Progress advances in steps, as the chunks are walked, decoded and the meshes processed.
+ *
+ * @return The progress, from 0 to 1.
+ */
+float ENG_API OVOParser::get_progress() const {
+    return this->progress.load(std::memory_order_relaxed);
+}
+
+/**
+ * Retrieves the material library of the last file loaded by this parser.
+ *
+ * @return The materials, by name.
+ */
+const std::unordered_map<std::string, std::shared_ptr<Material>> ENG_API &OVOParser::get_materials() const {
+    return this->materials;
+}
+
+/**
+ * Retrieves the settings that new parsers get by default.
+ *
+ * @return A copy of the default settings.
+ */
+OVOParserSettings ENG_API OVOParser::get_default_settings() {
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    return OVOParser::default_settings;
+}
+
+/**
+ * Enables the generation of levels of detail at load time, for parsers created afterwards.
+ * Meshes stored with a single LOD get up to `level_count` coarser levels, built in parallel
+ * once the file is parsed; meshes exported with their own LODs are kept as they are.
+ *
+ * @param level_count The number of levels to generate, or 0 to disable the generation.
+ */
+void ENG_API OVOParser::set_lod_generation(const unsigned int level_count) {
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    OVOParser::default_settings.lod_generation_levels = level_count;
+}
+
+/**
+ * Enables or disables the optimization of meshes at load time (enabled by default), for parsers
+ * created afterwards. Faces are reordered for the post-transform vertex cache and to reduce overdraw,
+ * then vertices are stored in fetch order; generated levels of detail are optimized as well.
+ *
+ * @param enabled Whether loaded meshes are optimized.
+ */
+void ENG_API OVOParser::set_mesh_optimization(const bool enabled) {
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    OVOParser::default_settings.mesh_optimization = enabled;
+}
+
+/**
+ * Sets the size from which mesh levels are split into meshlets at load time, so that the engine
+ * can cull parts of large meshes, for parsers created afterwards. Meshlets are built after
+ * optimization, in parallel.
+ *
+ * @param min_face_count The minimum number of faces of a level to split it, or 0 to disable meshlets.
+ */
+void ENG_API OVOParser::set_meshlet_generation(const size_t min_face_count) {
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    OVOParser::default_settings.meshlet_min_face_count = min_face_count;
+}
+
+/**
+ * Enables or disables the lazy loading of mesh geometry (disabled by default), for parsers created
+ * afterwards. When enabled, meshes are created with their bounds only and the file stays mapped;
+ * the geometry of each mesh is decoded and processed in the background the first time the engine
+ * finds it visible, through the shared `LazyMeshLoader`, with the settings of the parser that loaded it.
+ *
+ * @param enabled Whether mesh geometry is loaded lazily.
+ */
+void ENG_API OVOParser::set_lazy_loading(const bool enabled) {
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    OVOParser::default_settings.lazy_loading = enabled;
+}
+
+/**
+ * Gets the statistics of the last file loaded through `from_file`.
+ *
+ * @return The size, chunk count, timings and throughput of the last load.
+ */
+OVOLoadStats ENG_API OVOParser::get_load_stats() {
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    return OVOParser::load_stats;
+}
+
+/**
+ * Parses an OVO file and constructs the scene graph, with a parser using the default settings.
  *
  * @param path The file path to the OVO file.
  * @return A shared pointer to the root Node of the constructed scene graph.
  */
 std::shared_ptr<Node> ENG_API OVOParser::from_file(const std::string path) {
-    OVOParser::materials.clear();
-    FILE* file = fopen(path.c_str(), "rb");
-    if (file == nullptr) ERROR("Failed to read file '%s'", path.c_str());
+    return OVOParser::from_file(path, OVOFilter{});
+}
+
+/**
+ * Parses the parts of an OVO file matching a filter and constructs their scene graph, with a
+ * parser using the default settings.
+ *
+ * @param path The file path to the OVO file.
+ * @param filter The names, path prefixes or chunk types to load; see `OVOFilter`.
+ * @return A shared pointer to the root Node of the constructed scene graph.
+ */
+std::shared_ptr<Node> ENG_API OVOParser::from_file(const std::string path, const OVOFilter &filter) {
+    OVOParser parser;
+    const std::shared_ptr<Node> root = parser.load(path, filter);
+    std::lock_guard<std::mutex> lock(OVOParser::defaults_mutex);
+    OVOParser::load_stats = parser.get_stats();
+    return root;
+}
+
+/**
+ * Starts loading an OVO file in the background, without blocking the calling thread.
+ * The file is parsed on a worker thread; the textures of the scene are then uploaded by the
+ * `update` method of the returned handle, in slices, on the thread owning the rendering context.
+ *
+ * @param path The file path to the OVO file.
+ * @param settings How the meshes of the file are processed (default: the current default settings).
+ * @return The handle to the load, providing its progress and a future to the root of the scene graph.
+ */
+std::shared_ptr<SceneLoadHandle> ENG_API OVOParser::load_async(const std::string &path, const OVOParserSettings &settings) {
+    return std::make_shared<SceneLoadHandle>(path, settings);
+}
+
+/**
+ * Parses an OVO file and constructs the scene graph. 
+ * The file is mapped in memory and its chunks are decoded in place, without intermediate copies.
+ * A first pass walks the chunk headers and builds the hierarchy; mesh and material chunks are then
+ * decoded in parallel, and finally linked together in file order.
+ * Only the state of this parser is modified, so that different parsers can load files concurrently.
+ * Scene objects need no rendering context to be created.
+ *
+ * @param path The file path to the OVO file.
+ * @return A shared pointer to the root Node of the constructed scene graph.
+ */
+std::shared_ptr<Node> ENG_API OVOParser::load(const std::string &path) {
+    return this->load(path, OVOFilter{});
+}
+
+/**
+ * Parses the parts of an OVO file matching a filter and constructs their scene graph.
+ * The chunks are located through the index of the file, built from its chunk headers or read from
+ * its sidecar when `persist_chunk_index` is set, and only the selected ones are decoded; the pages
+ * of the others are never touched. An empty filter loads the whole file.
+ *
+ * @param path The file path to the OVO file.
+ * @param filter The names, path prefixes or chunk types to load; see `OVOFilter`.
+ * @return A shared pointer to the root Node of the constructed scene graph.
+ */
+std::shared_ptr<Node> ENG_API OVOParser::load(const std::string &path, const OVOFilter &filter) {
+    const auto start_time = std::chrono::steady_clock::now();
+    this->stats = OVOLoadStats{};
+    this->progress.store(0.0f, std::memory_order_relaxed);
+    this->materials.clear();
+    MappedFile file(path);
+    if (UNLIKELY(!file.is_open())) {
+        ERROR("Failed to read file '%s'", path.c_str());
+        std::shared_ptr<Node> root = NodePool::get_shared().create<Node>();
+        root->set_name("Scene Root");
+        this->progress.store(1.0f, std::memory_order_relaxed);
+        return root;
+    }
     DEBUG("Loading file '%s'...", path.c_str());
-    std::stack<std::pair<std::shared_ptr<Node>, uint32_t>> hierarchy;
-    std::shared_ptr<Node> root = std::make_shared<Node>();
+    // Compressed files are decompressed in memory, and then parsed like plain ones
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+    std::shared_ptr<std::vector<uint8_t>> image;
+    if (OVOArchive::is_compressed(data, size)) {
+        image = std::make_shared<std::vector<uint8_t>>();
+        if (UNLIKELY(!OVOArchive::decompress(data, size, *image))) {
+            ERROR("Failed to decompress file '%s'", path.c_str());
+            std::shared_ptr<Node> root = NodePool::get_shared().create<Node>();
+            root->set_name("Scene Root");
+            this->progress.store(1.0f, std::memory_order_relaxed);
+            return root;
+        }
+        data = image->data();
+        size = image->size();
+    }
+    std::vector<Chunk> chunks;
+    std::vector<MaterialChunk> material_chunks;
+    std::vector<MeshChunk> mesh_chunks;
+    std::shared_ptr<Node> root;
+    if (OVOIndex::is_empty(filter)) {
+        chunks = OVOParser::scan_chunks(data, size);
+        root = OVOParser::build_scene(chunks, material_chunks, mesh_chunks);
+    } else {
+        root = this->build_filtered_scene(path, file, data, size, filter, chunks, material_chunks, mesh_chunks);
+    }
+    this->progress.store(0.1f, std::memory_order_relaxed);
+    const size_t file_size = file.size();
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    if (this->settings.lazy_loading) {
+        OVOParser::decode_chunks(material_chunks, {});
+        meshes = OVOParser::link_chunks(this->materials, material_chunks, mesh_chunks);
+        std::shared_ptr<const void> storage = image;
+        if (storage == nullptr) storage = std::make_shared<const MappedFile>(std::move(file));
+        OVOParser::defer_meshes(storage, mesh_chunks, this->settings);
+    } else {
+        OVOParser::decode_chunks(material_chunks, mesh_chunks);
+        meshes = OVOParser::link_chunks(this->materials, material_chunks, mesh_chunks);
+    }
+    const auto parse_time = std::chrono::steady_clock::now();
+    if (!this->settings.lazy_loading) {
+        this->progress.store(0.5f, std::memory_order_relaxed);
+        OVOParser::process_meshes(meshes, this->settings);
+    }
+    this->progress.store(1.0f, std::memory_order_relaxed);
+    const auto end_time = std::chrono::steady_clock::now();
+    OVOLoadStats &stats = this->stats;
+    stats.file_size = file_size;
+    stats.chunk_count = chunks.size();
+    stats.mesh_count = meshes.size();
+    stats.parse_seconds = std::chrono::duration<double>(parse_time - start_time).count();
+    stats.total_seconds = std::chrono::duration<double>(end_time - start_time).count();
+    const double megabytes = (double)file_size / (1024.0 * 1024.0);
+    stats.parse_throughput = stats.parse_seconds > 0.0 ? megabytes / stats.parse_seconds : 0.0;
+    stats.total_throughput = stats.total_seconds > 0.0 ? megabytes / stats.total_seconds : 0.0;
+    DEBUG("File '%s' loaded successfully: %.2f MB in %.1f ms, parsed at %.1f MB/s (%.1f MB/s overall).",
+        path.c_str(), megabytes, stats.total_seconds * 1000.0, stats.parse_throughput, stats.total_throughput);
+    return root;
+}
+
+/**
+ * Walks the chunk headers of OVO data, without decoding the chunks.
+ * A chunk running past the end of the data ends the walk.
+ *
+ * @param data Pointer to the OVO data.
+ * @param size Size of the OVO data.
+ * @return The chunks, in file order, pointing into `data`.
+ */
+std::vector<OVOParser::Chunk> ENG_API OVOParser::scan_chunks(const uint8_t* data, const size_t size) {
+    std::vector<Chunk> chunks;
+    size_t offset = 0;
+    while (size - offset >= 2 * sizeof(uint32_t)) {
+        Chunk chunk;
+        memcpy(&chunk.type, data + offset, sizeof(uint32_t));
+        memcpy(&chunk.size, data + offset + sizeof(uint32_t), sizeof(uint32_t));
+        offset += 2 * sizeof(uint32_t);
+        if (UNLIKELY(chunk.size > size - offset)) {
+            WARN("Truncated OVO chunk of type %d at offset %zu.", chunk.type, offset);
+            break;
+        }
+        chunk.data = data + offset;
+        offset += chunk.size;
+        chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+/**
+ * Builds the scene hierarchy from OVO chunks, in file order.
+ * Nodes and lights are parsed right away; meshes and materials are only created, and their
+ * chunks returned to be decoded later.
+ *
+ * @param chunks The chunks of the file.
+ * @param material_chunks The vector to append the material chunks to.
+ * @param mesh_chunks The vector to append the mesh chunks to.
+ * @return A shared pointer to the root Node of the scene graph.
+ */
+std::shared_ptr<Node> ENG_API OVOParser::build_scene(const std::vector<Chunk> &chunks, std::vector<MaterialChunk> &material_chunks, std::vector<MeshChunk> &mesh_chunks) {
+    SceneState state;
+    OVOParser::begin_scene(state);
+    for (const Chunk &chunk : chunks) {
+        OVOParser::add_chunk(state, chunk);
+    }
+    material_chunks.insert(material_chunks.end(), state.material_chunks.begin(), state.material_chunks.end());
+    mesh_chunks.insert(mesh_chunks.end(), state.mesh_chunks.begin(), state.mesh_chunks.end());
+    return state.root;
+}
+
+/**
+ * Builds the scene hierarchy of the chunks of an OVO file selected by a filter.
+ * Selected nodes and lights are parsed right away and selected meshes only created, as in
+ * `build_scene`; the ancestors of selected nodes become plain nodes with their transform. Only the
+ * materials matching the filter or used by the selected meshes are created.
+ *
+ * @param path The file path to the OVO file.
+ * @param file The mapped OVO file.
+ * @param data Pointer to the OVO data: the mapped file, or its decompressed image.
+ * @param size Size of the OVO data.
+ * @param filter The filter.
+ * @param chunks The vector to append the selected chunks to.
+ * @param material_chunks The vector to append the material chunks to.
+ * @param mesh_chunks The vector to append the mesh chunks to.
+ * @return A shared pointer to the root Node of the scene graph.
+ */
+std::shared_ptr<Node> ENG_API OVOParser::build_filtered_scene(const std::string &path, const MappedFile &file, const uint8_t* data, const size_t size, const OVOFilter &filter, std::vector<Chunk> &chunks, std::vector<MaterialChunk> &material_chunks, std::vector<MeshChunk> &mesh_chunks) const {
+    const OVOIndex index = OVOIndex::load_or_build(path, file, data, size, this->settings.persist_chunk_index);
+    const std::vector<OVOIndex::Entry> &entries = index.get_entries();
+    const std::vector<OVOSelection> selection = index.select(filter);
+    std::shared_ptr<Node> root = NodePool::get_shared().create<Node>();
     root->set_name("Scene Root");
-    hierarchy.push(std::make_pair(root, 1));
-    while (true) {
-        uint32_t type;
-        uint32_t size;
-        fread(&type, sizeof(uint32_t), 1, file);
-        if (feof(file)) break;
-        fread(&size, sizeof(uint32_t), 1, file);
-        uint8_t* data = new uint8_t[size];
-        fread(data, sizeof(uint8_t), size, file);
-        if (type == 0) {
-            uint32_t version;
-            memcpy(&version, data, sizeof(uint32_t));
-            DEBUG("OVO version: %d", version);
-        } else if (type == 1) {
-            const std::pair<std::shared_ptr<Node>, uint32_t> ret = OVOParser::parse_node_chunk(data, size);
-            auto &top = hierarchy.top();
-            top.first->add_child(ret.first);
-            top.second--;
-            assert(top.second >= 0);
-            hierarchy.push(ret);
-        } else if (type == 9) {
-            const std::pair<std::shared_ptr<Material>, std::string> ret = OVOParser::parse_material_chunk(data, size);
-            const std::shared_ptr<Material> material = ret.first;
-            const std::string mat_name = ret.second;
-            OVOParser::materials[mat_name] = material;
-        } else if (type == 16) {
-            const std::pair<std::shared_ptr<Light>, uint32_t> ret = OVOParser::parse_light_chunk(data, size);
-            auto &top = hierarchy.top();
-            top.first->add_child(ret.first);
-            top.second--;
-            assert(top.second >= 0);
-            hierarchy.push(ret);
-        } else if (type == 18) {
-            const std::pair<std::shared_ptr<Mesh>, uint32_t> ret = OVOParser::parse_mesh_chunk(data, size);
-            auto &top = hierarchy.top();
-            top.first->add_child(ret.first);
-            top.second--;
-           assert(top.second >= 0);
-            hierarchy.push(ret);
+    std::vector<std::shared_ptr<Node>> nodes(entries.size());
+    std::unordered_set<std::string> material_names;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const OVOIndex::Entry &entry = entries[i];
+        if (selection[i] == OVOSelection::Skipped || entry.type == 0 || entry.type == 9) continue;
+        const Chunk chunk{ entry.type, entry.size, data + entry.offset };
+        std::shared_ptr<Node> node;
+        if (selection[i] == OVOSelection::Ancestor || entry.type == 1) {
+            // Node, light and mesh chunks all start with a name, a matrix and a child count
+            node = OVOParser::parse_node_chunk(chunk.data, chunk.size).first;
+        } else if (entry.type == 16) {
+            node = OVOParser::parse_light_chunk(chunk.data, chunk.size).first;
+        } else if (entry.type == 18) {
+            const MeshChunk mesh_chunk = OVOParser::parse_mesh_chunk(chunk.data, chunk.size).first;
+            material_names.insert(mesh_chunk.material_name);
+            mesh_chunks.push_back(mesh_chunk);
+            node = mesh_chunk.mesh;
         } else {
-            WARN("Unsupported OVO chunk type: %d", type);
-        }
-        while (hierarchy.size() > 0 && hierarchy.top().second == 0) {
-            hierarchy.pop();
+            WARN("Unsupported OVO chunk type: %d", entry.type);
+            continue;
         }
-        delete[] data;
+        const std::shared_ptr<Node> &parent = entry.parent >= 0 ? nodes[entry.parent] : root;
+        (parent != nullptr ? parent : root)->add_child(node);
+        nodes[i] = node;
+        chunks.push_back(chunk);
+    }
+    for (size_t i = 0; i < entries.size(); i++) {
+        const OVOIndex::Entry &entry = entries[i];
+        if (entry.type != 9 || (selection[i] == OVOSelection::Skipped && !material_names.contains(entry.name))) continue;
+        const Chunk chunk{ entry.type, entry.size, data + entry.offset };
+        material_chunks.push_back(MaterialChunk{ std::make_shared<Material>(), std::string(), chunk.data, chunk.size });
+        chunks.push_back(chunk);
     }
-    fclose(file);
-    DEBUG("File '%s' loaded successfully.", path.c_str());
+    DEBUG("Selected %zu of %zu chunks.", chunks.size(), entries.size());
     return root;
 }
 
+/**
+ * Starts building a scene hierarchy, with an empty root.
+ *
+ * @param state The state of the scene being built.
+ */
+void ENG_API OVOParser::begin_scene(SceneState &state) {
+    state.root = NodePool::get_shared().create<Node>();
+    state.root->set_name("Scene Root");
+    state.hierarchy = std::stack<std::pair<std::shared_ptr<Node>, uint32_t>>();
+    state.hierarchy.push(std::make_pair(state.root, 1));
+    state.material_chunks.clear();
+    state.mesh_chunks.clear();
+}
+
+/**
+ * Adds the next chunk of the file to a scene hierarchy being built.
+ * Nodes and lights are parsed right away and attached to their parent; meshes are attached
+ * without geometry, and materials only created. Their chunks are kept in the state to be decoded later.
+ *
+ * @param state The state of the scene being built.
+ * @param chunk The next chunk, in file order.
+ */
+void ENG_API OVOParser::add_chunk(SceneState &state, const Chunk &chunk) {
+    auto &hierarchy = state.hierarchy;
+    const uint32_t type = chunk.type;
+    const uint32_t size = chunk.size;
+    const uint8_t* data = chunk.data;
+    if (type == 0) {
+        uint32_t version = 0;
+        if (size >= sizeof(uint32_t)) memcpy(&version, data, sizeof(uint32_t));
+        DEBUG("OVO version: %d", version);
+    } else if (type == 9) {
+        // Materials are created in file order and decoded later
+        state.material_chunks.push_back(MaterialChunk{ std::make_shared<Material>(), std::string(), data, size });
+    } else if (UNLIKELY(hierarchy.empty() && (type == 1 || type == 16 || type == 18))) {
+        WARN("OVO chunk of type %d found past the end of the hierarchy.", type);
+    } else if (type == 1) {
+        const std::pair<std::shared_ptr<Node>, uint32_t> ret = OVOParser::parse_node_chunk(data, size);
+        auto &top = hierarchy.top();
+        top.first->add_child(ret.first);
+        top.second--;
+        hierarchy.push(ret);
+    } else if (type == 16) {
+        const std::pair<std::shared_ptr<Light>, uint32_t> ret = OVOParser::parse_light_chunk(data, size);
+        auto &top = hierarchy.top();
+        top.first->add_child(ret.first);
+        top.second--;
+        hierarchy.push(ret);
+    } else if (type == 18) {
+        const std::pair<MeshChunk, uint32_t> ret = OVOParser::parse_mesh_chunk(data, size);
+        state.mesh_chunks.push_back(ret.first);
+        auto &top = hierarchy.top();
+        top.first->add_child(ret.first.mesh);
+        top.second--;
+        hierarchy.push(std::make_pair(ret.first.mesh, ret.second));
+    } else {
+        WARN("Unsupported OVO chunk type: %d", type);
+    }
+    while (hierarchy.size() > 0 && hierarchy.top().second == 0) {
+        hierarchy.pop();
+    }
+}
+
+/**
+ * Loads the textures of decoded materials and assigns materials to meshes, in file order, so
+ * that the result does not depend on the decoding order.
+ *
+ * @param library The material library to add the materials to, by name.
+ * @param material_chunks The decoded material chunks.
+ * @param mesh_chunks The mesh chunks.
+ * @return The meshes of the chunks.
+ */
+std::vector<std::shared_ptr<Mesh>> ENG_API OVOParser::link_chunks(std::unordered_map<std::string, std::shared_ptr<Material>> &library, const std::vector<MaterialChunk> &material_chunks, const std::vector<MeshChunk> &mesh_chunks) {
+    for (const MaterialChunk &chunk : material_chunks) {
+        OVOParser::link_material(library, chunk);
+    }
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    meshes.reserve(mesh_chunks.size());
+    for (const MeshChunk &chunk : mesh_chunks) {
+        OVOParser::link_mesh(library, chunk);
+        meshes.push_back(chunk.mesh);
+    }
+    return meshes;
+}
+
+/**
+ * Loads the texture of a decoded material and adds the material to a material library.
+ *
+ * @param library The material library, by name.
+ * @param chunk The decoded material chunk.
+ */
+void ENG_API OVOParser::link_material(std::unordered_map<std::string, std::shared_ptr<Material>> &library, const MaterialChunk &chunk) {
+    if (chunk.texture_name != "[none]") {
+        chunk.material->set_texture(std::make_shared<Texture>(chunk.texture_name));
+    }
+    library[chunk.material->get_name()] = chunk.material;
+}
+
+/**
+ * Assigns its material to the mesh of a mesh chunk.
+ *
+ * @param library The material library, by name.
+ * @param chunk The mesh chunk.
+ */
+void ENG_API OVOParser::link_mesh(const std::unordered_map<std::string, std::shared_ptr<Material>> &library, const MeshChunk &chunk) {
+    if (chunk.material_name == "[none]") return;
+    const auto it = library.find(chunk.material_name);
+    if (it == library.end()) {
+        WARN("Material %s not found in material library.", chunk.material_name.c_str());
+    } else {
+        chunk.mesh->set_material(it->second);
+    }
+}
+
+/**
+ * Prepares loaded meshes for rendering, as configured: generates levels of detail, optimizes
+ * the meshes and splits them into meshlets.
+ *
+ * @param meshes The meshes to process.
+ * @param settings The parser settings.
+ */
+void ENG_API OVOParser::process_meshes(const std::vector<std::shared_ptr<Mesh>> &meshes, const OVOParserSettings &settings) {
+    if (settings.lod_generation_levels > 0) {
+        MeshSimplifier::generate_lods(meshes, settings.lod_generation_levels);
+    }
+    if (settings.mesh_optimization) {
+        MeshOptimizer::optimize(meshes);
+    }
+    if (settings.meshlet_min_face_count > 0) {
+        MeshletBuilder::build(meshes, settings.meshlet_min_face_count);
+    }
+}
+
+/**
+ * Hands the meshes of a file over to the shared lazy mesh loader, with their bounds as stored in
+ * the file. Each decoder keeps the file data alive, and decodes and processes its chunk into a staging mesh.
+ *
+ * @param storage The owner of the data of the chunks: the mapped file, or its decompressed image,
+ * kept until every mesh is loaded or destroyed.
+ * @param mesh_chunks The mesh chunks.
+ * @param settings The parser settings.
+ */
+void ENG_API OVOParser::defer_meshes(const std::shared_ptr<const void> &storage, const std::vector<MeshChunk> &mesh_chunks, const OVOParserSettings &settings) {
+    LazyMeshLoader &loader = LazyMeshLoader::get_shared();
+    for (const MeshChunk &chunk : mesh_chunks) {
+        MeshChunk payload = chunk;
+        payload.mesh = nullptr;
+        loader.add(chunk.mesh, chunk.bounds_min, chunk.bounds_max, [storage, payload, settings](const std::shared_ptr<Mesh> &mesh) {
+            MeshChunk staging = payload;
+            staging.mesh = mesh;
+            OVOParser::decode_mesh_chunk(staging);
+            OVOParser::process_mesh(*mesh, settings);
+        });
+    }
+}
+
+/**
+ * Prepares a single loaded mesh for rendering, as `process_meshes` does, on the calling thread.
+ *
+ * @param mesh The mesh to process.
+ * @param settings The parser settings.
+ */
+void ENG_API OVOParser::process_mesh(Mesh &mesh, const OVOParserSettings &settings) {
+    if (settings.lod_generation_levels > 0) {
+        MeshSimplifier::generate_lods(mesh, settings.lod_generation_levels);
+    }
+    if (settings.mesh_optimization) {
+        MeshOptimizer::optimize(mesh);
+    }
+    if (settings.meshlet_min_face_count > 0) {
+        MeshletBuilder::build(mesh, settings.meshlet_min_face_count);
+    }
+}
+
+/**
+ * Decodes mesh and material chunks on the shared thread pool.
+ * Largest chunks are decoded first, so that a single large mesh does not end up last on a thread.
+ *
+ * @param material_chunks The material chunks to decode.
+ * @param mesh_chunks The mesh chunks to decode.
+ */
+void ENG_API OVOParser::decode_chunks(std::vector<MaterialChunk> &material_chunks, const std::vector<MeshChunk> &mesh_chunks) {
+    std::vector<size_t> order(mesh_chunks.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+        return mesh_chunks[a].size > mesh_chunks[b].size;
+    });
+    const size_t task_count = mesh_chunks.size() + material_chunks.size();
+    ThreadPool::get_shared().parallel_for_each(task_count, [&](const size_t i) {
+        if (i < order.size()) {
+            OVOParser::decode_mesh_chunk(mesh_chunks[order[i]]);
+        } else {
+            MaterialChunk &chunk = material_chunks[i - order.size()];
+            chunk.texture_name = OVOParser::parse_material_chunk(*chunk.material, chunk.data, chunk.size);
+        }
+    });
+}
+
 /**
  * Parses a node chunk from OVO data.
+ * A truncated chunk gives a node without children.
  *
  * @param data Pointer to the chunk data.
  * @param size Size of the chunk data.
- * @return A pair containing the parsed Node and the number of bytes read.
+ * @return A pair containing the parsed Node and the number of child nodes.
  */
 std::pair<std::shared_ptr<Node>, uint32_t> ENG_API OVOParser::parse_node_chunk(const uint8_t* data, const uint32_t size) {
-    std::shared_ptr<Node> node = std::make_shared<Node>();
+    std::shared_ptr<Node> node = NodePool::get_shared().create<Node>();
     uint32_t child_cnt = 0;
     uint32_t ptr = 0;
     {
-        const std::string name = OVOParser::parse_string(data + ptr);
+        const std::string name = OVOParser::parse_string(data, size);
         ptr += name.length() + 1;
         node->set_name(name);
     }
+    if (UNLIKELY(!fits(ptr, size, sizeof(glm::mat4) + sizeof(uint32_t)))) {
+        WARN("Truncated OVO node chunk '%s'.", node->get_name().c_str());
+        return std::make_pair(node, 0u);
+    }
     {
         glm::mat4 matr;
         memcpy(&matr, data + ptr, sizeof(glm::mat4));
@@ -118,22 +654,28 @@ std::pair<std::shared_ptr<Node>, uint32_t> ENG_API OVOParser::parse_node_chunk(c
 }
 
 /**
- * Parses a mesh chunk from OVO data.
+ * Parses the header of a mesh chunk from OVO data, up to its levels of detail.
+ * A corrupted header gives a mesh without geometry, material or children.
  *
  * @param data Pointer to the chunk data.
  * @param size Size of the chunk data.
- * @return A pair containing the parsed Mesh and the number of child nodes.
+ * @return A pair containing the mesh chunk, with its levels of detail still to decode, and the number of child nodes.
  */
-std::pair<std::shared_ptr<Mesh>, uint32_t> ENG_API OVOParser::parse_mesh_chunk(const uint8_t* data, const uint32_t size) {
-    std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+std::pair<OVOParser::MeshChunk, uint32_t> ENG_API OVOParser::parse_mesh_chunk(const uint8_t* data, const uint32_t size) {
+    std::shared_ptr<Mesh> mesh = NodePool::get_shared().create<Mesh>();
+    const auto skip = [&]() {
+        WARN("Corrupted OVO mesh chunk '%s', skipped.", mesh->get_name().c_str());
+        return std::make_pair(MeshChunk{ mesh, "[none]", data, 0, glm::vec3(0.0f), glm::vec3(0.0f) }, 0u);
+    };
+    std::string mat_name;
     uint32_t child_cnt = 0;
-    uint32_t lod_cnt = 0;
     uint32_t ptr = 0;
     {
-        const std::string name = OVOParser::parse_string(data + ptr);
+        const std::string name = OVOParser::parse_string(data, size);
         ptr += name.length() + 1;
         mesh->set_name(name);
     }
+    if (UNLIKELY(!fits(ptr, size, sizeof(glm::mat4) + sizeof(uint32_t)))) return skip();
     {
         glm::mat4 matr;
         memcpy(&matr, data + ptr, sizeof(glm::mat4));
@@ -144,20 +686,21 @@ std::pair<std::shared_ptr<Mesh>, uint32_t> ENG_API OVOParser::parse_mesh_chunk(c
         memcpy(&child_cnt, data + ptr, sizeof(uint32_t));
         ptr += sizeof(uint32_t);
     }
-    ptr += OVOParser::parse_string(data + ptr).length() + 1;
+    if (UNLIKELY(!fits(ptr, size, 0))) return skip();
+    ptr += OVOParser::parse_string(data + ptr, size - ptr).length() + 1;
     ptr += sizeof(uint8_t);
+    if (UNLIKELY(!fits(ptr, size, 0))) return skip();
     {
-        const std::string mat_name = OVOParser::parse_string(data + ptr);
+        mat_name = OVOParser::parse_string(data + ptr, size - ptr);
         ptr += mat_name.length() + 1;
-        if (mat_name == "[none]");
-        else if (OVOParser::materials.find(mat_name) == OVOParser::materials.end()) {
-            WARN("Material %s not found in material library.", mat_name.c_str());
-        } else {
-            mesh->set_material(OVOParser::materials[mat_name]);
-        }
     }
+    if (UNLIKELY(!fits(ptr, size, sizeof(float) + 2 * sizeof(glm::vec3) + sizeof(uint8_t)))) return skip();
     ptr += sizeof(float);
+    glm::vec3 bounds_min;
+    memcpy(&bounds_min, data + ptr, sizeof(glm::vec3));
     ptr += sizeof(glm::vec3);
+    glm::vec3 bounds_max;
+    memcpy(&bounds_max, data + ptr, sizeof(glm::vec3));
     ptr += sizeof(glm::vec3);
     {
         uint8_t has_phys;
@@ -165,94 +708,139 @@ std::pair<std::shared_ptr<Mesh>, uint32_t> ENG_API OVOParser::parse_mesh_chunk(c
         ptr += sizeof(uint8_t);
         if (has_phys) {
             DEBUG("Physics present at ptr=%u", ptr);
+            if (UNLIKELY(!fits(ptr, size, 40 + sizeof(uint32_t) + 20))) return skip();
             ptr += 40;
             uint32_t hull_cnt;
             memcpy(&hull_cnt, data + ptr, sizeof(uint32_t));
             ptr += sizeof(uint32_t);
             ptr += 20;
             for (uint32_t i = 0; i < hull_cnt; i++) { 
+                if (UNLIKELY(!fits(ptr, size, 2 * sizeof(uint32_t)))) return skip();
                 uint32_t hull_vert_cnt;
                 memcpy(&hull_vert_cnt, data + ptr, sizeof(uint32_t));
                 ptr += sizeof(uint32_t);
                 uint32_t hull_faces_cnt;
                 memcpy(&hull_faces_cnt, data + ptr, sizeof(uint32_t));
                 ptr += sizeof(uint32_t);
-                ptr += sizeof(glm::vec3) + hull_vert_cnt * sizeof(glm::vec3) + hull_faces_cnt * 3 * sizeof(uint32_t);
+                const uint64_t hull_size = sizeof(glm::vec3) + (uint64_t)hull_vert_cnt * sizeof(glm::vec3) + (uint64_t)hull_faces_cnt * 3 * sizeof(uint32_t);
+                if (UNLIKELY(!fits(ptr, size, hull_size))) return skip();
+                ptr += (uint32_t)hull_size;
             }
         }
     }
-    memcpy(&lod_cnt, data + ptr, sizeof(uint32_t));
-    ptr += sizeof(uint32_t);
-    if (lod_cnt > 1) {
-        WARN("Mesh LODs not supported, only first LOD will be parsed out of %d.", lod_cnt);
-    }
+    return std::make_pair(MeshChunk{ mesh, mat_name, data + ptr, size - ptr, bounds_min, bounds_max }, child_cnt);
+}
+
+/**
+ * Decodes the levels of detail of a mesh chunk into its mesh.
+ * Only the mesh of the chunk is modified, so chunks can be decoded concurrently. Every count and
+ * index is checked against the chunk, and a corrupted chunk leaves the mesh without geometry.
+ *
+ * @param chunk The mesh chunk to decode.
+ * @param coarsest_only Whether to decode only the coarsest level, as level 0.
+ */
+void ENG_API OVOParser::decode_mesh_chunk(const MeshChunk &chunk, const bool coarsest_only) {
+    constexpr size_t vertex_stride = VertexDecoder::STRIDE;
+    const std::shared_ptr<Mesh> &mesh = chunk.mesh;
+    const uint8_t* data = chunk.data;
+    const uint32_t size = chunk.size;
+    const uint32_t lod_cnt = OVOParser::get_lod_count(chunk);
+    // Levels are only handed over once the whole chunk is known to be valid
+    std::vector<MeshBuilder> levels;
+    uint32_t ptr = sizeof(uint32_t);
     for (uint32_t i = 0; i < lod_cnt; i++) {
+        if (UNLIKELY(!fits(ptr, size, 2 * sizeof(uint32_t)))) {
+            WARN("Corrupted OVO mesh chunk '%s', skipped.", mesh->get_name().c_str());
+            return;
+        }
         uint32_t vert_cnt;
         memcpy(&vert_cnt, data + ptr, sizeof(uint32_t));
         ptr += sizeof(uint32_t);
         uint32_t face_cnt;
         memcpy(&face_cnt, data + ptr, sizeof(uint32_t));
         ptr += sizeof(uint32_t);
-        std::vector<glm::vec3> vertices;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> uvs;
-        for (uint32_t v = 0; v < vert_cnt; v++) {
-            glm::vec3 vertex;
-            memcpy(&vertex, data + ptr, sizeof(glm::vec3));
-            ptr += sizeof(glm::vec3);
-            vertices.push_back(vertex);
-            uint32_t normal_raw;
-            memcpy(&normal_raw, data + ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-            const glm::vec3 normal = glm::vec3(glm::unpackSnorm3x10_1x2(normal_raw));
-            normals.push_back(normal);
-            uint32_t uv_raw;
-            memcpy(&uv_raw, data + ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-            const glm::vec2 uv = glm::unpackHalf2x16(uv_raw);
-            uvs.push_back(uv);
-            ptr += sizeof(uint32_t);
+        const uint64_t level_size = (uint64_t)vert_cnt * vertex_stride + (uint64_t)face_cnt * 3 * sizeof(uint32_t);
+        if (UNLIKELY(!fits(ptr, size, level_size))) {
+            WARN("Corrupted OVO mesh chunk '%s', skipped.", mesh->get_name().c_str());
+            return;
+        }
+        if (coarsest_only && i + 1 < lod_cnt) {
+            ptr += (uint32_t)level_size;
+            continue;
         }
-        std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
+        // Decode straight into the arrays the mesh will own
+        MeshBuilder &builder = levels.emplace_back();
+        builder.resize(vert_cnt, face_cnt);
+        const std::span<glm::vec3> vertices = builder.get_vertices();
+        const std::span<glm::vec3> normals = builder.get_normals();
+        const std::span<glm::vec2> uvs = builder.get_uvs();
+        // Each vertex is stored as its position, packed normal, packed UV and packed tangent
+        VertexDecoder::decode(data + ptr, vertices, normals, uvs);
+        ptr += vert_cnt * vertex_stride;
+        const std::span<std::tuple<uint32_t, uint32_t, uint32_t>> faces = builder.get_faces();
+        const uint8_t* face_data = data + ptr;
+        uint32_t max_index = 0;
         for (uint32_t f = 0; f < face_cnt; f++) {
-            uint32_t f0;
-            memcpy(&f0, data + ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-            uint32_t f1;
-            memcpy(&f1, data + ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-            uint32_t f2;
-            memcpy(&f2, data + ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-            const auto face = std::make_tuple(f0, f1, f2);
-            faces.push_back(face);
+            uint32_t indices[3];
+            memcpy(indices, face_data + f * sizeof(indices), sizeof(indices));
+            max_index = std::max({ max_index, indices[0], indices[1], indices[2] });
+            faces[f] = std::make_tuple(indices[0], indices[1], indices[2]);
+        }
+        if (UNLIKELY(face_cnt > 0 && max_index >= vert_cnt)) {
+            WARN("Corrupted OVO mesh chunk '%s', skipped: vertex index %u out of %u vertices.", mesh->get_name().c_str(), max_index, vert_cnt);
+            return;
+        }
+        ptr += face_cnt * 3 * sizeof(uint32_t);
+    }
+    for (size_t i = 0; i < levels.size(); i++) {
+        if (i == 0) {
+            levels[i].build(*mesh);
+        } else {
+            levels[i].build_lod(*mesh);
         }
-        mesh->set_mesh_data(vertices, faces, normals, uvs);
-        break;
     }
-    return std::make_pair(mesh, child_cnt);
 }
 
 /**
- * Parses a material chunk from OVO data.
+ * Reads the number of levels of detail stored in a mesh chunk.
+ * A chunk too short to hold the count has none.
  *
+ * @param chunk The mesh chunk.
+ * @return The number of levels of detail.
+ */
+uint32_t ENG_API OVOParser::get_lod_count(const MeshChunk &chunk) {
+    if (UNLIKELY(chunk.size < sizeof(uint32_t))) return 0;
+    uint32_t lod_cnt;
+    memcpy(&lod_cnt, chunk.data, sizeof(uint32_t));
+    return lod_cnt;
+}
+
+/**
+ * Parses a material chunk from OVO data into a material.
+ * The texture is not loaded, so that materials can be parsed concurrently. A truncated chunk
+ * keeps the default values of the fields it misses, and gives no texture.
+ *
+ * @param material The material to fill.
  * @param data Pointer to the chunk data.
  * @param size Size of the chunk data.
- * @return A pair containing the parsed Material and its name.
+ * @return The name of the texture of the material, or "[none]".
  */
-std::pair<std::shared_ptr<Material>, std::string> ENG_API OVOParser::parse_material_chunk(const uint8_t* data, const uint32_t size) {
-    std::shared_ptr<Material> material = std::make_shared<Material>();
+std::string ENG_API OVOParser::parse_material_chunk(Material &material, const uint8_t* data, const uint32_t size) {
     uint32_t ptr = 0;
     {
-        std::string mat_name = OVOParser::parse_string(data + ptr);
+        std::string mat_name = OVOParser::parse_string(data, size);
         ptr += mat_name.length() + 1;
-        material->set_name(mat_name);
+        material.set_name(mat_name);
+    }
+    if (UNLIKELY(!fits(ptr, size, 2 * sizeof(glm::vec3) + 3 * sizeof(float)))) {
+        WARN("Truncated OVO material chunk '%s'.", material.get_name().c_str());
+        return "[none]";
     }
     {
         glm::vec3 emission;
         memcpy(&emission, data + ptr, sizeof(glm::vec3));
         ptr += sizeof(glm::vec3);
-        material->set_emission_color(emission);
+        material.set_emission_color(emission);
     }
     glm::vec3 albedo;
     {
@@ -266,30 +854,36 @@ std::pair<std::shared_ptr<Material>, std::string> ENG_API OVOParser::parse_mater
     }
     //metallic;
     ptr += sizeof(float);
-    // Transparency
-    ptr += sizeof(float);
     {
-        std::string tex_name = OVOParser::parse_string(data + ptr);
-        ptr += tex_name.length() + 1;
-        if (tex_name != "[none]") {
-            std::shared_ptr<Texture> texture = std::make_shared<Texture>(tex_name);
-            material->set_texture(texture);
+        float transparency;
+        memcpy(&transparency, data + ptr, sizeof(float));
+        ptr += sizeof(float);
+        material.set_transparency(transparency);
+        if (transparency < 1.0f) {
+            material.set_blend_mode(BlendMode::Alpha);
         }
     }
-    ptr += OVOParser::parse_string(data + ptr).length() + 1;
-    ptr += OVOParser::parse_string(data + ptr).length() + 1;
-    ptr += OVOParser::parse_string(data + ptr).length() + 1;
-    ptr += OVOParser::parse_string(data + ptr).length() + 1;
-    material->set_ambient_color(albedo);
-    material->set_specular_color(albedo);
-    material->set_diffuse_color(albedo);
-    material->set_shininess((1.0f - std::sqrt(roughness)) * 128.0f);
-    DEBUG("Parsed material '%s'", material->get_name().c_str());
-    return std::make_pair(material, material->get_name());
+    material.set_ambient_color(albedo);
+    material.set_specular_color(albedo);
+    material.set_diffuse_color(albedo);
+    material.set_shininess((1.0f - std::sqrt(roughness)) * 128.0f);
+    const std::string tex_name = OVOParser::parse_string(data + ptr, size - ptr);
+    ptr += tex_name.length() + 1;
+    // Normal, height, roughness and metalness maps follow, unused
+    for (int i = 0; i < 4 && fits(ptr, size, 0); i++) {
+        ptr += OVOParser::parse_string(data + ptr, size - ptr).length() + 1;
+    }
+    if (UNLIKELY(!fits(ptr, size, 0))) {
+        WARN("Truncated OVO material chunk '%s'.", material.get_name().c_str());
+        return "[none]";
+    }
+    DEBUG("Parsed material '%s'", material.get_name().c_str());
+    return tex_name;
 }
 
 /**
  * Parses a light chunk from OVO data.
+ * A truncated chunk gives a default point light without children.
  *
  * @param data Pointer to the chunk data.
  * @param size Size of the chunk data.
@@ -300,9 +894,13 @@ std::pair<std::shared_ptr<Light>, uint32_t> ENG_API OVOParser::parse_light_chunk
     uint32_t child_cnt;
     std::string light_name;
     {
-        light_name = OVOParser::parse_string(data + ptr);
+        light_name = OVOParser::parse_string(data, size);
         ptr += light_name.length() + 1;
     }
+    if (UNLIKELY(!fits(ptr, size, sizeof(glm::mat4) + sizeof(uint32_t)))) {
+        WARN("Truncated OVO light chunk '%s'. Defaulting to a point light.", light_name.c_str());
+        return std::make_pair(NodePool::get_shared().create<PointLight>(), 0u);
+    }
     glm::mat4 matrix;
     {
         memcpy(&matrix, data + ptr, sizeof(glm::mat4));
@@ -312,7 +910,11 @@ std::pair<std::shared_ptr<Light>, uint32_t> ENG_API OVOParser::parse_light_chunk
         memcpy(&child_cnt, data + ptr, sizeof(uint32_t));
         ptr += sizeof(uint32_t);
     }
-    ptr += OVOParser::parse_string(data + ptr).length() + 1;
+    ptr += OVOParser::parse_string(data + ptr, size - ptr).length() + 1;
+    if (UNLIKELY(!fits(ptr, size, sizeof(uint8_t) + 2 * sizeof(glm::vec3) + 3 * sizeof(float)))) {
+        WARN("Truncated OVO light chunk '%s'. Defaulting to a point light.", light_name.c_str());
+        return std::make_pair(NodePool::get_shared().create<PointLight>(), 0u);
+    }
     uint8_t subtype;
     {
         memcpy(&subtype, data + ptr, sizeof(uint8_t));
@@ -345,7 +947,7 @@ std::pair<std::shared_ptr<Light>, uint32_t> ENG_API OVOParser::parse_light_chunk
         ptr += sizeof(float);
     }
     if (subtype == 0) {
-        std::shared_ptr<PointLight> light = std::make_shared<PointLight>();
+        std::shared_ptr<PointLight> light = NodePool::get_shared().create<PointLight>();
         light->set_name(light_name);
         light->set_base_matrix(matrix);
         light->set_diffuse_color(color);
@@ -354,7 +956,7 @@ std::pair<std::shared_ptr<Light>, uint32_t> ENG_API OVOParser::parse_light_chunk
         return std::make_pair(light, child_cnt);
     }
     else if (subtype == 1) {
-        std::shared_ptr<DirectionalLight> light = std::make_shared<DirectionalLight>();
+        std::shared_ptr<DirectionalLight> light = NodePool::get_shared().create<DirectionalLight>();
         light->set_name(light_name);
         light->set_base_matrix(matrix);
         light->set_diffuse_color(color);
@@ -363,7 +965,7 @@ std::pair<std::shared_ptr<Light>, uint32_t> ENG_API OVOParser::parse_light_chunk
         return std::make_pair(light, child_cnt);
     }
     else if (subtype == 2) {
-        std::shared_ptr<SpotLight> light = std::make_shared<SpotLight>();
+        std::shared_ptr<SpotLight> light = NodePool::get_shared().create<SpotLight>();
         light->set_name(light_name);
         light->set_base_matrix(matrix);
         light->set_diffuse_color(color);
@@ -375,23 +977,21 @@ std::pair<std::shared_ptr<Light>, uint32_t> ENG_API OVOParser::parse_light_chunk
         return std::make_pair(light, child_cnt);
     } else {
         WARN("Unknown light subtype: %d. Defaulting to a point light.", (uint32_t)subtype);
-        return std::make_pair(std::make_shared<PointLight>(), 0);
+        return std::make_pair(NodePool::get_shared().create<PointLight>(), 0);
     }
 }
 
 /**
- * Parses a null-terminated string from OVO data.
+ * Parses a null-terminated string from OVO data, within the data left in its chunk.
+ * A string missing its terminator is returned whole, so that skipping its length plus the
+ * terminator runs past the end of the chunk, which callers check for.
  *
  * @param data Pointer to the string data.
+ * @param size Number of bytes left in the chunk.
  * @return The parsed string.
  */
-std::string ENG_API OVOParser::parse_string(const uint8_t* data) {
-    std::string str;
-    uint32_t ptr = 0;
-    while (data[ptr] != 0x00) {
-        const char character = (char)data[ptr];
-        str += character;
-        ptr++;
-    }
-    return str;
+std::string ENG_API OVOParser::parse_string(const uint8_t* data, const size_t size) {
+    const void* end = memchr(data, 0x00, size);
+    const size_t length = end != nullptr ? (size_t)((const uint8_t*)end - data) : size;
+    return std::string((const char*)data, length);
 }   
@@ -9,30 +9,133 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <stack>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "light.h"
+#include "mapped_file.h"
 #include "material.h"
 #include "mesh.h"
+#include "meshlet.h"
 #include "node.h"
+#include "ovo_index.h"
 
 namespace lrvg {
 
+class SceneLoadHandle;
+
+/**
+ * @brief Size, timings and throughput of an OVO file load.
+ * Parsing covers the decoding of the chunks, the total also includes the processing of the meshes;
+ * throughputs are in megabytes of file per second.
+ */
+struct ENG_API OVOLoadStats {
+    size_t file_size;
+    size_t chunk_count;
+    size_t mesh_count;
+    double parse_seconds;
+    double total_seconds;
+    double parse_throughput;
+    double total_throughput;
+};
+
+/**
+ * @brief How an OVO parser processes the meshes it loads.
+ * See the static setters of `OVOParser`, which change the settings of parsers created afterwards.
+ */
+struct ENG_API OVOParserSettings {
+    unsigned int lod_generation_levels = 0;
+    bool mesh_optimization = true;
+    size_t meshlet_min_face_count = MeshletBuilder::MIN_FACE_COUNT;
+    bool lazy_loading = false;
+    bool persist_chunk_index = false;
+};
+
 /**
  * @brief OVO file parser class.
+ * Each parser instance has its own settings, material library and statistics, so several files
+ * can be loaded at once by different parsers, on different threads. The static interface loads
+ * through a temporary parser with the default settings.
  */
 class ENG_API OVOParser {
 public:
+    explicit OVOParser(const OVOParserSettings &settings = OVOParser::get_default_settings());
+    std::shared_ptr<Node>                                    load(const std::string &path);
+    std::shared_ptr<Node>                                    load(const std::string &path, const OVOFilter &filter);
+    const OVOParserSettings                                  &get_settings() const;
+    const OVOLoadStats                                       &get_stats() const;
+    float                                                    get_progress() const;
+    const std::unordered_map<std::string, std::shared_ptr<Material>> &get_materials() const;
     static std::shared_ptr<Node>                             from_file(const std::string path);
+    static std::shared_ptr<Node>                             from_file(const std::string path, const OVOFilter &filter);
+    static std::shared_ptr<SceneLoadHandle>                  load_async(const std::string &path, const OVOParserSettings &settings = OVOParser::get_default_settings());
+    static OVOLoadStats                                      get_load_stats();
+    static OVOParserSettings                                 get_default_settings();
+    static void                                              set_lod_generation(const unsigned int level_count);
+    static void                                              set_mesh_optimization(const bool enabled);
+    static void                                              set_meshlet_generation(const size_t min_face_count);
+    static void                                              set_lazy_loading(const bool enabled);
 private:
+    friend class OVOArchive;
+    friend class OVOIndex;
+    friend class SceneCache;
+    friend class SceneStreamer;
+    struct Chunk {
+        uint32_t type;
+        uint32_t size;
+        const uint8_t* data;
+    };
+    struct MeshChunk {
+        std::shared_ptr<Mesh> mesh;
+        std::string material_name;
+        const uint8_t* data;
+        uint32_t size;
+        glm::vec3 bounds_min;
+        glm::vec3 bounds_max;
+    };
+    struct MaterialChunk {
+        std::shared_ptr<Material> material;
+        std::string texture_name;
+        const uint8_t* data;
+        uint32_t size;
+    };
+    struct SceneState {
+        std::shared_ptr<Node> root;
+        std::stack<std::pair<std::shared_ptr<Node>, uint32_t>> hierarchy;
+        std::vector<MaterialChunk> material_chunks;
+        std::vector<MeshChunk> mesh_chunks;
+    };
+    static std::vector<Chunk>                                scan_chunks(const uint8_t* data, const size_t size);
+    static std::shared_ptr<Node>                             build_scene(const std::vector<Chunk> &chunks, std::vector<MaterialChunk> &material_chunks, std::vector<MeshChunk> &mesh_chunks);
+    std::shared_ptr<Node>                                    build_filtered_scene(const std::string &path, const MappedFile &file, const uint8_t* data, const size_t size, const OVOFilter &filter, std::vector<Chunk> &chunks, std::vector<MaterialChunk> &material_chunks, std::vector<MeshChunk> &mesh_chunks) const;
+    static void                                              begin_scene(SceneState &state);
+    static void                                              add_chunk(SceneState &state, const Chunk &chunk);
+    static void                                              decode_chunks(std::vector<MaterialChunk> &material_chunks, const std::vector<MeshChunk> &mesh_chunks);
+    static std::vector<std::shared_ptr<Mesh>>                link_chunks(std::unordered_map<std::string, std::shared_ptr<Material>> &library, const std::vector<MaterialChunk> &material_chunks, const std::vector<MeshChunk> &mesh_chunks);
+    static void                                              link_material(std::unordered_map<std::string, std::shared_ptr<Material>> &library, const MaterialChunk &chunk);
+    static void                                              link_mesh(const std::unordered_map<std::string, std::shared_ptr<Material>> &library, const MeshChunk &chunk);
+    static void                                              process_meshes(const std::vector<std::shared_ptr<Mesh>> &meshes, const OVOParserSettings &settings);
+    static void                                              process_mesh(Mesh &mesh, const OVOParserSettings &settings);
+    static void                                              defer_meshes(const std::shared_ptr<const void> &storage, const std::vector<MeshChunk> &mesh_chunks, const OVOParserSettings &settings);
     static std::pair<std::shared_ptr<Node>, uint32_t>        parse_node_chunk(const uint8_t* data, const uint32_t size);
-    static std::pair<std::shared_ptr<Mesh>, uint32_t>        parse_mesh_chunk(const uint8_t* data, const uint32_t size);
-    static std::pair<std::shared_ptr<Material>, std::string> parse_material_chunk(const uint8_t* data, const uint32_t size);
+    static std::pair<MeshChunk, uint32_t>                    parse_mesh_chunk(const uint8_t* data, const uint32_t size);
+    static void                                              decode_mesh_chunk(const MeshChunk &chunk, const bool coarsest_only = false);
+    static uint32_t                                          get_lod_count(const MeshChunk &chunk);
+    static std::string                                       parse_material_chunk(Material &material, const uint8_t* data, const uint32_t size);
     static std::pair<std::shared_ptr<Light>, uint32_t>       parse_light_chunk(const uint8_t* data, const uint32_t size);
-    static std::string                                       parse_string(const uint8_t* data);
-    static std::unordered_map<std::string, std::shared_ptr<Material>> materials;
+    static std::string                                       parse_string(const uint8_t* data, const size_t size);
+    OVOParserSettings settings;
+    OVOLoadStats stats;
+    std::atomic<float> progress;
+    std::unordered_map<std::string, std::shared_ptr<Material>> materials;
+    static std::mutex defaults_mutex;
+    static OVOParserSettings default_settings;
+    static OVOLoadStats load_stats;
 };
 
 }
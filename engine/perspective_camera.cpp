@@ -18,6 +18,18 @@
 
 using namespace lrvg;
 
+/**
+ * Computes the perspective projection matrix of the camera.
+ * The matrix is built from the camera's field of view, the aspect ratio of the window
+ * and the clipping planes.
+ * 
+ * @return A glm::mat4 representing the projection matrix.
+ */
+glm::mat4 ENG_API PerspectiveCamera::get_projection_matrix() const {
+    const float aspect_ratio = static_cast<float>(this->window_width) / static_cast<float>(this->window_height);
+    return glm::perspective(glm::radians(this->fov), aspect_ratio, this->near_clipping, this->far_clipping);
+}
+
 /**
  * Renders the scene from the perspective camera's point of view.
  * This method sets up the perspective projection matrix based on the camera's field of view,
@@ -30,9 +42,7 @@ using namespace lrvg;
 void ENG_API PerspectiveCamera::render(const glm::mat4 world_matrix) const {
     if (!this->is_active) return;
     Node::render(world_matrix);
-    const float aspect_ratio = static_cast<float>(this->window_width) / static_cast<float>(this->window_height);
-    const glm::mat4 perspective_matrix =
-        glm::perspective(glm::radians(this->fov), aspect_ratio, this->near_clipping, this->far_clipping);
+    const glm::mat4 perspective_matrix = this->get_projection_matrix();
     glMatrixMode(GL_PROJECTION);
     glLoadMatrixf(glm::value_ptr(perspective_matrix));
 }
@@ -23,6 +23,7 @@ namespace lrvg {
  */
 class ENG_API PerspectiveCamera : public Camera {
 public:
+	glm::mat4 get_projection_matrix() const override;
 	void render(const glm::mat4 world_matrix) const override;
 };
 
@@ -9,45 +9,78 @@
 
 #include "plane.h"
 
+#include <algorithm>
+#include <span>
+#include <tuple>
+
 #include <glad/gl.h>
 #include <glm/glm.hpp>
 
+#include "geometry_cache.h"
+#include "mesh_builder.h"
+#include "mesh_optimizer.h"
+
 using namespace lrvg;
 
 /**
  * Creates a new instance of Plane with predefined mesh data.
  * The plane is centered at the origin and lies on the XZ plane.
  * The plane has a size of 2x2 units (from -1 to 1 in both X and Z dimensions).
+ * Planes with the same segment count share their geometry.
  * 
- * @param segments Number of subdivisions along each axis (default: 10)
+ * @param segments Number of subdivisions along each axis (default: 80)
  */
 Plane::Plane(int segments) {
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> uvs;
-    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
+    segments = std::max(segments, 1);
+    this->set_geometry(GeometryCache::get_shared().get(PrimitiveType::Plane, segments, 0, [=]() {
+        return Plane::generate(segments);
+    }));
+    this->set_cast_shadows(true);
+}
+
+/**
+ * Generates the optimized geometry of a plane. Rows are generated in parallel for large planes.
+ * 
+ * @param segments Number of subdivisions along each axis
+ * @return The full-resolution level of detail of the plane.
+ */
+MeshLOD Plane::generate(int segments) {
+    const size_t row_size = (size_t)segments + 1;
+    MeshBuilder builder;
+    builder.resize(row_size * row_size, 2 * (size_t)segments * segments);
+    const std::span<glm::vec3> vertices = builder.get_vertices();
+    const std::span<glm::vec3> normals = builder.get_normals();
+    const std::span<glm::vec2> uvs = builder.get_uvs();
+    const std::span<std::tuple<uint32_t, uint32_t, uint32_t>> faces = builder.get_faces();
     glm::vec3 normal_up(0, 1, 0);
-    for (int z = 0; z <= segments; ++z) {
-        for (int x = 0; x <= segments; ++x) {
-            float xPos = -1.0f + (2.0f * x / segments);
-            float zPos = -1.0f + (2.0f * z / segments);
-            float u = (float)x / segments;
-            float v = (float)z / segments;
-            vertices.push_back(glm::vec3(xPos, 0, zPos));
-            normals.push_back(normal_up);
-            uvs.push_back(glm::vec2(u, v));
+    GeometryCache::parallel_rows(row_size, row_size, [&](const size_t begin, const size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            for (int x = 0; x <= segments; ++x) {
+                float xPos = -1.0f + (2.0f * x / segments);
+                float zPos = -1.0f + (2.0f * z / segments);
+                float u = (float)x / segments;
+                float v = (float)z / segments;
+                const size_t i = z * row_size + x;
+                vertices[i] = glm::vec3(xPos, 0, zPos);
+                normals[i] = normal_up;
+                uvs[i] = glm::vec2(u, v);
+            }
         }
-    }
-    for (int z = 0; z < segments; ++z) {
-        for (int x = 0; x < segments; ++x) {
-            uint32_t topLeft = z * (segments + 1) + x;
-            uint32_t topRight = topLeft + 1;
-            uint32_t bottomLeft = (z + 1) * (segments + 1) + x;
-            uint32_t bottomRight = bottomLeft + 1;
-            faces.push_back(std::make_tuple(topLeft, bottomLeft, topRight));
-            faces.push_back(std::make_tuple(topRight, bottomLeft, bottomRight));
+    });
+    GeometryCache::parallel_rows(segments, row_size, [&](const size_t begin, const size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            for (int x = 0; x < segments; ++x) {
+                uint32_t topLeft = (uint32_t)(z * row_size + x);
+                uint32_t topRight = topLeft + 1;
+                uint32_t bottomLeft = topLeft + (uint32_t)row_size;
+                uint32_t bottomRight = bottomLeft + 1;
+                const size_t f = 2 * (z * segments + x);
+                faces[f] = std::make_tuple(topLeft, bottomLeft, topRight);
+                faces[f + 1] = std::make_tuple(topRight, bottomLeft, bottomRight);
+            }
         }
-    }
-    this->set_mesh_data(vertices, faces, normals, uvs);
-    this->set_cast_shadows(true);
+    });
+    MeshLOD lod = builder.build();
+    MeshOptimizer::optimize(lod);
+    return lod;
 }
@@ -20,6 +20,7 @@ namespace lrvg {
 class ENG_API Plane : public Mesh {
 public:
     Plane(int segments = 80);
+    static MeshLOD generate(int segments);
 };
 
 }
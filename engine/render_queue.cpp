@@ -0,0 +1,205 @@
+/**
+ * @file	render_queue.cpp
+ * @brief	Render queue class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "render_queue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common.h"
+#include "material.h"
+#include "mesh.h"
+#include "texture.h"
+
+using namespace lrvg;
+
+// Key layout, from the least significant bit
+static constexpr int DEPTH_BITS = 28;
+static constexpr int MATERIAL_BITS = 14;
+static constexpr int TEXTURE_BITS = 12;
+static constexpr int PRIORITY_BITS = 8;
+static constexpr int MATERIAL_SHIFT = DEPTH_BITS;
+static constexpr int TEXTURE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+static constexpr int PRIORITY_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+static constexpr int PASS_SHIFT = PRIORITY_SHIFT + PRIORITY_BITS;
+// The blended pass swaps the depth and state fields
+static constexpr int BLENDED_STATE_SHIFT = 0;
+static constexpr int BLENDED_DEPTH_SHIFT = MATERIAL_BITS + TEXTURE_BITS;
+
+// Below this size, a comparison sort beats the fixed cost of the radix passes
+static constexpr size_t RADIX_SORT_THRESHOLD = 64;
+
+/**
+ * Creates a new, empty render queue.
+ */
+ENG_API RenderQueue::RenderQueue() {
+}
+
+/**
+ * Removes every entry from the queue, keeping the allocated memory for the next frame.
+ */
+void ENG_API RenderQueue::clear() {
+	this->entries.clear();
+}
+
+/**
+ * Reserves memory for a given number of entries.
+ *
+ * @param count The number of entries to reserve memory for.
+ */
+void ENG_API RenderQueue::reserve(const size_t count) {
+	this->entries.reserve(count);
+}
+
+/**
+ * Appends a draw to the queue.
+ *
+ * @param key The sort key of the draw, as built by `make_key`.
+ * @param index The index of the draw in the caller's render list.
+ */
+void ENG_API RenderQueue::push(const uint64_t key, const uint32_t index) {
+	this->entries.push_back(Entry{ key, index });
+}
+
+/**
+ * Sorts the queue by ascending key.
+ * The sort is an LSD radix sort over the bytes of the keys; bytes equal across the whole queue,
+ * such as the pass and priority of most frames, are skipped.
+ */
+void ENG_API RenderQueue::sort() {
+	const size_t count = this->entries.size();
+	if (count < RADIX_SORT_THRESHOLD) {
+		std::sort(this->entries.begin(), this->entries.end(), [](const Entry &a, const Entry &b) {
+			return a.key < b.key;
+		});
+		return;
+	}
+	// Histograms of all the bytes are gathered in a single pass over the keys
+	uint32_t histograms[8][256];
+	std::memset(histograms, 0, sizeof(histograms));
+	for (const Entry &entry : this->entries) {
+		for (int byte = 0; byte < 8; byte++) {
+			histograms[byte][(entry.key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+	this->scratch.resize(count);
+	for (int byte = 0; byte < 8; byte++) {
+		uint32_t *histogram = histograms[byte];
+		const int shift = byte * 8;
+		if (histogram[(this->entries[0].key >> shift) & 0xFF] == count) continue;
+		uint32_t offset = 0;
+		for (int digit = 0; digit < 256; digit++) {
+			const uint32_t digit_count = histogram[digit];
+			histogram[digit] = offset;
+			offset += digit_count;
+		}
+		for (const Entry &entry : this->entries) {
+			this->scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+		}
+		this->entries.swap(this->scratch);
+	}
+}
+
+/**
+ * Retrieves the number of entries in the queue.
+ *
+ * @return The number of entries.
+ */
+size_t ENG_API RenderQueue::size() const {
+	return this->entries.size();
+}
+
+/**
+ * Retrieves the sort key of an entry.
+ *
+ * @param position The position of the entry in the queue.
+ * @return The sort key of the entry.
+ */
+uint64_t ENG_API RenderQueue::get_key(const size_t position) const {
+	return this->entries[position].key;
+}
+
+/**
+ * Retrieves the render list index of an entry.
+ *
+ * @param position The position of the entry in the queue.
+ * @return The index of the draw in the caller's render list.
+ */
+uint32_t ENG_API RenderQueue::get_index(const size_t position) const {
+	return this->entries[position].index;
+}
+
+/**
+ * Retrieves the render pass of an entry.
+ *
+ * @param position The position of the entry in the queue.
+ * @return The render pass of the entry.
+ */
+uint32_t ENG_API RenderQueue::get_pass(const size_t position) const {
+	return (uint32_t)(this->entries[position].key >> PASS_SHIFT);
+}
+
+/**
+ * Packs a sort key.
+ * Depths are quantized through their IEEE-754 representation, which is monotonic for positive
+ * floats, so that no depth range is needed; negative depths (behind the camera) clamp to 0.
+ * In the blended pass the depth is inverted and takes precedence over the state, so that
+ * draws come back to front.
+ *
+ * @param pass The render pass.
+ * @param priority The priority of the object, clamped to [-128, 127]; higher priorities sort first.
+ * @param texture The texture identifier, truncated to 12 bits.
+ * @param material The material identifier, truncated to 14 bits.
+ * @param depth The view-space depth, positive in front of the camera.
+ * @return The sort key.
+ */
+uint64_t ENG_API RenderQueue::make_key(const uint32_t pass, const int priority, const uint32_t texture, const uint32_t material, const float depth) {
+	const uint64_t priority_bits = (uint64_t)(127 - std::clamp(priority, -128, 127));
+	const float positive_depth = depth > 0.0f ? depth : 0.0f;
+	uint32_t depth_bits;
+	std::memcpy(&depth_bits, &positive_depth, sizeof(depth_bits));
+	// The sign bit is always clear, the low mantissa bits are dropped
+	depth_bits = (depth_bits >> (31 - DEPTH_BITS)) & ((1u << DEPTH_BITS) - 1);
+	const uint64_t state_bits = ((uint64_t)(texture & ((1u << TEXTURE_BITS) - 1)) << MATERIAL_BITS)
+		| (uint64_t)(material & ((1u << MATERIAL_BITS) - 1));
+	const uint64_t header_bits = ((uint64_t)(pass & 0x3) << PASS_SHIFT) | (priority_bits << PRIORITY_SHIFT);
+	if (pass == RenderQueue::PASS_BLENDED) {
+		const uint64_t inverted_depth = ((1u << DEPTH_BITS) - 1) - depth_bits;
+		return header_bits | (inverted_depth << BLENDED_DEPTH_SHIFT) | (state_bits << BLENDED_STATE_SHIFT);
+	}
+	return header_bits | (state_bits << MATERIAL_SHIFT) | (uint64_t)depth_bits;
+}
+
+/**
+ * Builds the sort key of a node for the current frame.
+ * Meshes are keyed by their texture, their material and the depth of the center of their bounds,
+ * and go to the blended pass if their material is blended; other nodes are keyed by the depth of their origin.
+ *
+ * @param node The node to draw.
+ * @param model_view The model-view matrix of the node.
+ * @return The sort key.
+ */
+uint64_t ENG_API RenderQueue::make_key(const Node &node, const glm::mat4 &model_view) {
+	const Mesh *mesh = dynamic_cast<const Mesh *>(&node);
+	if (mesh == nullptr) {
+		return RenderQueue::make_key(RenderQueue::PASS_OPAQUE, node.get_priority(), 0, 0, -model_view[3].z);
+	}
+	const glm::vec3 center = 0.5f * (mesh->get_bounds_min() + mesh->get_bounds_max());
+	const float depth = -(model_view[0].z * center.x + model_view[1].z * center.y + model_view[2].z * center.z + model_view[3].z);
+	const Material *material = mesh->get_material().get();
+	const Texture *texture = material->get_texture().get();
+	return RenderQueue::make_key(
+		material->is_blended() ? RenderQueue::PASS_BLENDED : RenderQueue::PASS_OPAQUE,
+		mesh->get_priority(),
+		texture != nullptr ? (uint32_t)texture->get_id() + 1 : 0,
+		(uint32_t)material->get_id(),
+		depth
+	);
+}
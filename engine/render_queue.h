@@ -0,0 +1,58 @@
+/**
+ * @file	render_queue.h
+ * @brief	Render queue class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "node.h"
+
+namespace lrvg {
+
+/**
+ * @brief Queue of draws ordered by 64-bit sort keys.
+ * Entries only carry a key and the index of the draw in the caller's render list; the queue is
+ * sorted with an LSD radix sort, in linear time. From the most to the least significant bits, a key holds:
+ * * pass (2 bits), opaque draws first
+ * * priority (8 bits, higher priorities first)
+ * * in the opaque pass: texture (12 bits) and material (14 bits), to group draws sharing the same state,
+ *   then view-space depth (28 bits), front to back for early depth rejection
+ * * in the blended pass: view-space depth (28 bits), back to front as blending requires,
+ *   then texture and material
+ */
+class ENG_API RenderQueue final {
+public:
+	static constexpr uint32_t PASS_OPAQUE = 0;
+	static constexpr uint32_t PASS_BLENDED = 1;
+	RenderQueue();
+	void clear();
+	void reserve(const size_t count);
+	void push(const uint64_t key, const uint32_t index);
+	void sort();
+	size_t size() const;
+	uint64_t get_key(const size_t position) const;
+	uint32_t get_index(const size_t position) const;
+	uint32_t get_pass(const size_t position) const;
+	static uint64_t make_key(const uint32_t pass, const int priority, const uint32_t texture, const uint32_t material, const float depth);
+	static uint64_t make_key(const Node &node, const glm::mat4 &model_view);
+private:
+	struct Entry {
+		uint64_t key;
+		uint32_t index;
+	};
+	std::vector<Entry> entries;
+	std::vector<Entry> scratch;
+};
+
+}
@@ -0,0 +1,479 @@
+/**
+ * @file	scene_cache.cpp
+ * @brief	Baked scene cache class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "scene_cache.h"
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include "meshlet.h"
+#include "node.h"
+#include "ovo_archive.h"
+#include "ovo_parser.h"
+#include "thread_pool.h"
+
+using namespace lrvg;
+
+/**
+ * Alignment of every blob and record in a cache file, suitable for direct GPU uploads.
+ */
+static constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+/**
+ * Signature at the start of every cache file.
+ */
+static constexpr char MAGIC[8] = { 'L', 'R', 'V', 'G', 'S', 'C', 'N', '\0' };
+
+/**
+ * Gets the modification time of a file, as stored in cache headers.
+ *
+ * @param path The path of the file.
+ * @return The modification time, or 0 if it cannot be read.
+ */
+static int64_t get_file_time(const std::string &path) {
+	std::error_code error;
+	const auto time = std::filesystem::last_write_time(path, error);
+	return error ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+/**
+ * Checks whether a range of bytes lies within a mapped file.
+ *
+ * @param file The mapped file.
+ * @param offset The offset of the first byte.
+ * @param size The size of the range, in bytes.
+ * @return Whether the whole range is in the file.
+ */
+static bool in_bounds(const MappedFile &file, const uint64_t offset, const uint64_t size) {
+	return offset <= file.size() && size <= file.size() - offset;
+}
+
+/**
+ * Checks that every value of an array stored in a mapped file stays below a bound.
+ *
+ * @param data Pointer to the array, which may be unaligned.
+ * @param count The number of values.
+ * @param limit The bound, exclusive.
+ * @return Whether all the values are below the bound.
+ */
+template <typename T>
+static bool values_below(const uint8_t *data, const uint64_t count, const uint64_t limit) {
+	for (uint64_t i = 0; i < count; i++) {
+		T value;
+		memcpy(&value, data + i * sizeof(T), sizeof(T));
+		if (UNLIKELY(value >= limit)) return false;
+	}
+	return true;
+}
+
+/**
+ * Bakes an OVO file into a scene cache.
+ * Meshes are decoded and processed with the current OVO parser settings, exactly as they would
+ * be when loading the OVO file; nodes, lights and materials are kept as OVO chunks, so baking
+ * needs no rendering context. The cache is written next to its final path and then renamed, so
+ * that an interrupted bake never leaves a partial cache behind.
+ *
+ * @param source_path The path of the OVO file.
+ * @param path The path of the cache file to write.
+ * @return Whether the cache was written.
+ */
+bool ENG_API SceneCache::bake(const std::string &source_path, const std::string &path) {
+	UNREF const auto start_time = std::chrono::steady_clock::now();
+	const MappedFile source(source_path);
+	if (UNLIKELY(!source.is_open())) {
+		ERROR("Failed to read file '%s'", source_path.c_str());
+		return false;
+	}
+	const OVOParserSettings settings = OVOParser::get_default_settings();
+	std::vector<uint8_t> image;
+	if (OVOArchive::is_compressed(source.data(), source.size()) && UNLIKELY(!OVOArchive::decompress(source.data(), source.size(), image))) {
+		ERROR("Failed to decompress file '%s'", source_path.c_str());
+		return false;
+	}
+	const std::vector<OVOParser::Chunk> chunks = image.empty() ? OVOParser::scan_chunks(source.data(), source.size()) : OVOParser::scan_chunks(image.data(), image.size());
+	std::vector<OVOParser::MeshChunk> mesh_chunks;
+	for (const OVOParser::Chunk &chunk : chunks) {
+		// Only mesh chunks are decoded
+		if (chunk.type == 18) mesh_chunks.push_back(OVOParser::parse_mesh_chunk(chunk.data, chunk.size).first);
+	}
+	std::vector<OVOParser::MaterialChunk> material_chunks;
+	OVOParser::decode_chunks(material_chunks, mesh_chunks);
+	std::vector<std::shared_ptr<Mesh>> meshes;
+	meshes.reserve(mesh_chunks.size());
+	for (const OVOParser::MeshChunk &chunk : mesh_chunks) {
+		meshes.push_back(chunk.mesh);
+	}
+	OVOParser::process_meshes(meshes, settings);
+
+	const std::string temp_path = path + ".tmp";
+	FILE *file = fopen(temp_path.c_str(), "wb");
+	if (UNLIKELY(file == nullptr)) {
+		ERROR("Failed to write file '%s'", temp_path.c_str());
+		return false;
+	}
+	Header header = SceneCache::make_header(settings);
+	header.chunk_count = (uint32_t)chunks.size();
+	header.source_size = source.size();
+	header.source_time = get_file_time(source_path);
+	header.source_hash = SceneCache::hash(source.data(), source.size());
+	uint64_t offset = 0;
+	SceneCache::write_blob(file, offset, &header, sizeof(Header));
+	std::vector<ChunkRecord> records(chunks.size());
+	size_t mesh_index = 0;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		const OVOParser::Chunk &chunk = chunks[i];
+		ChunkRecord &record = records[i];
+		record.type = chunk.type;
+		record.size = chunk.size;
+		record.geometry_offset = 0;
+		if (chunk.type == 18) {
+			// Mesh chunks keep their header only, their geometry is stored baked
+			const OVOParser::MeshChunk &mesh_chunk = mesh_chunks[mesh_index++];
+			record.size = (uint32_t)(mesh_chunk.data - chunk.data);
+			record.geometry_offset = SceneCache::write_geometry(file, offset, *mesh_chunk.mesh->get_geometry());
+		}
+		record.offset = SceneCache::write_blob(file, offset, chunk.data, record.size);
+	}
+	header.chunk_table_offset = SceneCache::write_blob(file, offset, records.data(), records.size() * sizeof(ChunkRecord));
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(Header), 1, file);
+	const bool failed = ferror(file) != 0;
+	fclose(file);
+	std::error_code error;
+	if (!failed) std::filesystem::rename(temp_path, path, error);
+	if (UNLIKELY(failed || error)) {
+		ERROR("Failed to write file '%s'", path.c_str());
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+	DEBUG("Baked '%s' into '%s': %zu meshes, %.2f MB, in %.1f ms.", source_path.c_str(), path.c_str(), meshes.size(),
+		(double)offset / (1024.0 * 1024.0), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+	return true;
+}
+
+/**
+ * Loads a scene from its cache, if the cache is up to date.
+ * Node, light and material chunks are parsed as in an OVO file, while the geometry of meshes is
+ * copied from the cache, in parallel, without any further processing.
+ *
+ * @param path The path of the cache file.
+ * @param source_path The path of the OVO file the cache was baked from.
+ * @return A shared pointer to the root Node of the scene graph, or `nullptr` if the cache is
+ * missing, stale or corrupted and the OVO file must be loaded instead.
+ */
+std::shared_ptr<Node> ENG_API SceneCache::load(const std::string &path, const std::string &source_path) {
+	UNREF const auto start_time = std::chrono::steady_clock::now();
+	const MappedFile file(path);
+	if (!file.is_open()) return nullptr;
+	if (!SceneCache::validate(file, source_path, OVOParser::get_default_settings())) {
+		DEBUG("Scene cache '%s' is out of date.", path.c_str());
+		return nullptr;
+	}
+	Header header;
+	memcpy(&header, file.data(), sizeof(Header));
+	if (UNLIKELY(!in_bounds(file, header.chunk_table_offset, (uint64_t)header.chunk_count * sizeof(ChunkRecord)))) {
+		ERROR("Corrupted scene cache '%s'", path.c_str());
+		return nullptr;
+	}
+	std::vector<OVOParser::Chunk> chunks(header.chunk_count);
+	std::vector<uint64_t> geometry_offsets;
+	for (uint32_t i = 0; i < header.chunk_count; i++) {
+		ChunkRecord record;
+		memcpy(&record, file.data() + header.chunk_table_offset + i * sizeof(ChunkRecord), sizeof(ChunkRecord));
+		if (UNLIKELY(!in_bounds(file, record.offset, record.size) ||
+				(record.type == 18 && !SceneCache::check_geometry(file, record.geometry_offset)))) {
+			ERROR("Corrupted scene cache '%s'", path.c_str());
+			return nullptr;
+		}
+		chunks[i] = OVOParser::Chunk{ record.type, record.size, file.data() + record.offset };
+		if (record.type == 18) geometry_offsets.push_back(record.geometry_offset);
+	}
+	std::vector<OVOParser::MaterialChunk> material_chunks;
+	std::vector<OVOParser::MeshChunk> mesh_chunks;
+	const std::shared_ptr<Node> root = OVOParser::build_scene(chunks, material_chunks, mesh_chunks);
+	OVOParser::decode_chunks(material_chunks, std::vector<OVOParser::MeshChunk>());
+	ThreadPool::get_shared().parallel_for_each(mesh_chunks.size(), [&](const size_t i) {
+		mesh_chunks[i].mesh->set_geometry(SceneCache::read_geometry(file, geometry_offsets[i]));
+	});
+	std::unordered_map<std::string, std::shared_ptr<Material>> library;
+	OVOParser::link_chunks(library, material_chunks, mesh_chunks);
+	DEBUG("Scene cache '%s' loaded successfully: %.2f MB in %.1f ms.", path.c_str(), (double)file.size() / (1024.0 * 1024.0),
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+	return root;
+}
+
+/**
+ * Checks whether a cache is up to date with its OVO file and the current OVO parser settings.
+ *
+ * @param path The path of the cache file.
+ * @param source_path The path of the OVO file the cache was baked from.
+ * @return Whether the cache can be loaded.
+ */
+bool ENG_API SceneCache::is_valid(const std::string &path, const std::string &source_path) {
+	const MappedFile file(path);
+	return file.is_open() && SceneCache::validate(file, source_path, OVOParser::get_default_settings());
+}
+
+/**
+ * Gets the path of the cache of an OVO file, next to it.
+ *
+ * @param source_path The path of the OVO file.
+ * @return The path of the cache file.
+ */
+std::string ENG_API SceneCache::get_default_path(const std::string &source_path) {
+	return std::filesystem::path(source_path).replace_extension(".lrvgscene").string();
+}
+
+/**
+ * Computes the 64-bit hash used to detect changes to OVO files.
+ * Four independent lanes consume 32 bytes per step, so that hashing runs close to memory speed.
+ *
+ * @param data Pointer to the data to hash.
+ * @param size Size of the data, in bytes.
+ * @return The hash of the data.
+ */
+uint64_t ENG_API SceneCache::hash(const uint8_t *data, const size_t size) {
+	constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+	uint64_t lanes[4] = { PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1 };
+	size_t i = 0;
+	for (; i + 4 * sizeof(uint64_t) <= size; i += 4 * sizeof(uint64_t)) {
+		for (int k = 0; k < 4; k++) {
+			uint64_t word;
+			memcpy(&word, data + i + k * sizeof(uint64_t), sizeof(uint64_t));
+			lanes[k] = std::rotl(lanes[k] + word * PRIME_2, 31) * PRIME_1;
+		}
+	}
+	uint64_t h = (uint64_t)size * PRIME_1;
+	for (int k = 0; k < 4; k++) {
+		h = (h ^ std::rotl(lanes[k] * PRIME_2, 31) * PRIME_1) * PRIME_1 + PRIME_2;
+	}
+	for (; i < size; i++) {
+		h = std::rotl(h ^ (data[i] * PRIME_1), 11) * PRIME_2;
+	}
+	h ^= h >> 33;
+	h *= PRIME_2;
+	h ^= h >> 29;
+	return h;
+}
+
+/**
+ * Creates the header of a cache baked with the given OVO parser settings.
+ *
+ * @param settings The OVO parser settings.
+ * @return The header, without any information on the source file.
+ */
+SceneCache::Header ENG_API SceneCache::make_header(const OVOParserSettings &settings) {
+	Header header{};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = SceneCache::VERSION;
+	header.lod_generation_levels = settings.lod_generation_levels;
+	header.mesh_optimization = settings.mesh_optimization ? 1 : 0;
+	header.meshlet_min_face_count = settings.meshlet_min_face_count;
+	header.meshlet_size = sizeof(Meshlet);
+	return header;
+}
+
+/**
+ * Checks the header of a cache against its OVO file and OVO parser settings.
+ * The source is hashed only when its size matches but its modification time changed; a missing
+ * source is accepted, so that scenes can be shipped baked only.
+ *
+ * @param file The mapped cache file.
+ * @param source_path The path of the OVO file the cache was baked from.
+ * @param settings The OVO parser settings the cache must have been baked with.
+ * @return Whether the cache is up to date.
+ */
+bool ENG_API SceneCache::validate(const MappedFile &file, const std::string &source_path, const OVOParserSettings &settings) {
+	if (file.size() < sizeof(Header)) return false;
+	Header header;
+	memcpy(&header, file.data(), sizeof(Header));
+	const Header expected = SceneCache::make_header(settings);
+	if (memcmp(header.magic, expected.magic, sizeof(MAGIC)) != 0 ||
+			header.version != expected.version ||
+			header.lod_generation_levels != expected.lod_generation_levels ||
+			header.mesh_optimization != expected.mesh_optimization ||
+			header.meshlet_min_face_count != expected.meshlet_min_face_count ||
+			header.meshlet_size != expected.meshlet_size) {
+		return false;
+	}
+	std::error_code error;
+	if (!std::filesystem::exists(source_path, error)) return true;
+	if (std::filesystem::file_size(source_path, error) != header.source_size || error) return false;
+	if (get_file_time(source_path) == header.source_time) return true;
+	const MappedFile source(source_path);
+	return source.is_open() && SceneCache::hash(source.data(), source.size()) == header.source_hash;
+}
+
+/**
+ * Checks that a geometry record and all of its blobs lie within a cache file, and that the
+ * blobs agree with the counts of the record: faces and indices refer to existing vertices, the
+ * indices match the faces and `max_index`, and meshlets cover existing faces.
+ *
+ * @param file The mapped cache file.
+ * @param offset The offset of the geometry record.
+ * @return Whether the geometry can be read.
+ */
+bool ENG_API SceneCache::check_geometry(const MappedFile &file, const uint64_t offset) {
+	if (!in_bounds(file, offset, sizeof(GeometryRecord))) return false;
+	GeometryRecord record;
+	memcpy(&record, file.data() + offset, sizeof(GeometryRecord));
+	const uint64_t lods_offset = offset + sizeof(GeometryRecord);
+	if (!in_bounds(file, lods_offset, (uint64_t)record.lod_count * sizeof(LODRecord))) return false;
+	for (uint32_t l = 0; l < record.lod_count; l++) {
+		LODRecord lod;
+		memcpy(&lod, file.data() + lods_offset + l * sizeof(LODRecord), sizeof(LODRecord));
+		if (!in_bounds(file, lod.vertices, (uint64_t)lod.vertex_count * sizeof(glm::vec3)) ||
+				!in_bounds(file, lod.normals, (uint64_t)lod.vertex_count * sizeof(glm::vec3)) ||
+				!in_bounds(file, lod.uvs, (uint64_t)lod.vertex_count * sizeof(glm::vec2)) ||
+				!in_bounds(file, lod.faces, (uint64_t)lod.face_count * 3 * sizeof(uint32_t)) ||
+				!in_bounds(file, lod.indices, (uint64_t)lod.index_count * lod.index_size) ||
+				!in_bounds(file, lod.meshlets, (uint64_t)lod.meshlet_count * sizeof(Meshlet)) ||
+				(lod.index_size != sizeof(uint16_t) && lod.index_size != sizeof(uint32_t)) ||
+				lod.index_count != (uint64_t)lod.face_count * 3 ||
+				(lod.index_count > 0 && lod.max_index >= lod.vertex_count)) {
+			return false;
+		}
+		const uint8_t *data = file.data();
+		if (!values_below<uint32_t>(data + lod.faces, (uint64_t)lod.face_count * 3, lod.vertex_count)) return false;
+		if (lod.index_size == sizeof(uint16_t)) {
+			if (!values_below<uint16_t>(data + lod.indices, lod.index_count, (uint64_t)lod.max_index + 1)) return false;
+		} else {
+			if (!values_below<uint32_t>(data + lod.indices, lod.index_count, (uint64_t)lod.max_index + 1)) return false;
+		}
+		for (uint32_t m = 0; m < lod.meshlet_count; m++) {
+			Meshlet meshlet;
+			memcpy(&meshlet, data + lod.meshlets + m * sizeof(Meshlet), sizeof(Meshlet));
+			if ((uint64_t)meshlet.faces.offset + meshlet.faces.count > lod.face_count) return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Reads a mesh geometry from a cache file, checked beforehand with `check_geometry`.
+ * The blobs are copied out of the mapping into the arrays the geometry owns.
+ *
+ * @param file The mapped cache file.
+ * @param offset The offset of the geometry record.
+ * @return The geometry, ready to be drawn.
+ */
+std::shared_ptr<const MeshGeometry> ENG_API SceneCache::read_geometry(const MappedFile &file, const uint64_t offset) {
+	const uint8_t *data = file.data();
+	GeometryRecord record;
+	memcpy(&record, data + offset, sizeof(GeometryRecord));
+	std::shared_ptr<MeshGeometry> geometry = std::make_shared<MeshGeometry>();
+	if (record.lod_count > 0) geometry->lods.resize(record.lod_count);
+	geometry->bounds_min = record.bounds_min;
+	geometry->bounds_max = record.bounds_max;
+	for (uint32_t l = 0; l < record.lod_count; l++) {
+		LODRecord lod_record;
+		memcpy(&lod_record, data + offset + sizeof(GeometryRecord) + l * sizeof(LODRecord), sizeof(LODRecord));
+		MeshLOD &lod = geometry->lods[l];
+		lod.vertices.resize(lod_record.vertex_count);
+		lod.normals.resize(lod_record.vertex_count);
+		lod.uvs.resize(lod_record.vertex_count);
+		memcpy(lod.vertices.data(), data + lod_record.vertices, lod.vertices.size() * sizeof(glm::vec3));
+		memcpy(lod.normals.data(), data + lod_record.normals, lod.normals.size() * sizeof(glm::vec3));
+		memcpy(lod.uvs.data(), data + lod_record.uvs, lod.uvs.size() * sizeof(glm::vec2));
+		const uint32_t *faces = reinterpret_cast<const uint32_t *>(data + lod_record.faces);
+		lod.faces.resize(lod_record.face_count);
+		for (uint32_t f = 0; f < lod_record.face_count; f++) {
+			lod.faces[f] = std::make_tuple(faces[3 * f], faces[3 * f + 1], faces[3 * f + 2]);
+		}
+		if (lod_record.index_size == sizeof(uint16_t)) {
+			lod.indices.assign(std::span<const uint16_t>(reinterpret_cast<const uint16_t *>(data + lod_record.indices), lod_record.index_count), lod_record.max_index);
+		} else {
+			lod.indices.assign(std::span<const uint32_t>(reinterpret_cast<const uint32_t *>(data + lod_record.indices), lod_record.index_count), lod_record.max_index);
+		}
+		lod.meshlets.resize(lod_record.meshlet_count);
+		memcpy(lod.meshlets.data(), data + lod_record.meshlets, lod.meshlets.size() * sizeof(Meshlet));
+		lod.screen_size = lod_record.screen_size;
+	}
+	return geometry;
+}
+
+/**
+ * Writes the blobs of a mesh geometry to a cache file, followed by its records.
+ *
+ * @param file The cache file being written.
+ * @param offset The current offset in the file, advanced past the geometry.
+ * @param geometry The geometry to write.
+ * @return The offset of the geometry record.
+ */
+uint64_t ENG_API SceneCache::write_geometry(FILE *file, uint64_t &offset, const MeshGeometry &geometry) {
+	std::vector<LODRecord> lod_records(geometry.lods.size());
+	std::vector<uint32_t> faces;
+	for (size_t l = 0; l < geometry.lods.size(); l++) {
+		const MeshLOD &lod = geometry.lods[l];
+		LODRecord &record = lod_records[l];
+		record = LODRecord{};
+		record.vertex_count = (uint32_t)lod.vertices.size();
+		record.face_count = (uint32_t)lod.faces.size();
+		record.index_count = (uint32_t)lod.indices.size();
+		record.index_size = lod.indices.is_narrow() ? sizeof(uint16_t) : sizeof(uint32_t);
+		record.max_index = lod.indices.get_max_index();
+		record.meshlet_count = (uint32_t)lod.meshlets.size();
+		record.screen_size = lod.screen_size;
+		record.vertices = SceneCache::write_blob(file, offset, lod.vertices.data(), lod.vertices.size() * sizeof(glm::vec3));
+		record.normals = SceneCache::write_blob(file, offset, lod.normals.data(), lod.normals.size() * sizeof(glm::vec3));
+		record.uvs = SceneCache::write_blob(file, offset, lod.uvs.data(), lod.uvs.size() * sizeof(glm::vec2));
+		faces.clear();
+		faces.reserve(lod.faces.size() * 3);
+		for (const auto &[a, b, c] : lod.faces) {
+			faces.push_back(a);
+			faces.push_back(b);
+			faces.push_back(c);
+		}
+		record.faces = SceneCache::write_blob(file, offset, faces.data(), faces.size() * sizeof(uint32_t));
+		record.indices = SceneCache::write_blob(file, offset, lod.indices.data(), lod.indices.get_size_bytes());
+		record.meshlets = SceneCache::write_blob(file, offset, lod.meshlets.data(), lod.meshlets.size() * sizeof(Meshlet));
+	}
+	const GeometryRecord record{ (uint32_t)lod_records.size(), 0, geometry.bounds_min, geometry.bounds_max };
+	const uint64_t record_offset = SceneCache::write_blob(file, offset, &record, sizeof(GeometryRecord));
+	fwrite(lod_records.data(), sizeof(LODRecord), lod_records.size(), file);
+	offset += lod_records.size() * sizeof(LODRecord);
+	return record_offset;
+}
+
+/**
+ * Writes a blob to a cache file, at the next aligned offset.
+ *
+ * @param file The cache file being written.
+ * @param offset The current offset in the file, advanced past the blob.
+ * @param data Pointer to the blob.
+ * @param size Size of the blob, in bytes.
+ * @return The offset of the blob.
+ */
+uint64_t ENG_API SceneCache::write_blob(FILE *file, uint64_t &offset, const void *data, const size_t size) {
+	static const uint8_t padding[BLOB_ALIGNMENT] = {};
+	const uint64_t padding_size = (BLOB_ALIGNMENT - offset % BLOB_ALIGNMENT) % BLOB_ALIGNMENT;
+	fwrite(padding, 1, padding_size, file);
+	offset += padding_size;
+	const uint64_t blob_offset = offset;
+	if (size > 0) fwrite(data, 1, size, file);
+	offset += size;
+	return blob_offset;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file	scene_cache.h
+ * @brief	Baked scene cache class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include "node.h"
+#include "ovo_parser.h"
+
+namespace lrvg {
+
+/**
+ * @brief Engine-native cache of an OVO scene, baked offline so that it loads with almost no parsing.
+ * The small node, light and material chunks of the OVO file are kept as they are, while the
+ * geometry of each mesh is stored fully processed (levels of detail in optimized order, index
+ * buffers, meshlets and bounds) in aligned blobs that are copied straight into the meshes.
+ * A cache is stale once its source file or the OVO parser settings change.
+ */
+class ENG_API SceneCache final {
+public:
+	static constexpr uint32_t VERSION = 1;
+	static bool bake(const std::string &source_path, const std::string &path);
+	static std::shared_ptr<Node> load(const std::string &path, const std::string &source_path);
+	static bool is_valid(const std::string &path, const std::string &source_path);
+	static std::string get_default_path(const std::string &source_path);
+	static uint64_t hash(const uint8_t *data, const size_t size);
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t chunk_count;
+		uint64_t source_size;
+		int64_t source_time;
+		uint64_t source_hash;
+		uint64_t chunk_table_offset;
+		uint32_t lod_generation_levels;
+		uint32_t mesh_optimization;
+		uint64_t meshlet_min_face_count;
+		uint32_t meshlet_size;
+		uint32_t reserved;
+	};
+	struct ChunkRecord {
+		uint32_t type;
+		uint32_t size;
+		uint64_t offset;
+		uint64_t geometry_offset;
+	};
+	struct GeometryRecord {
+		uint32_t lod_count;
+		uint32_t reserved;
+		glm::vec3 bounds_min;
+		glm::vec3 bounds_max;
+	};
+	struct LODRecord {
+		uint32_t vertex_count;
+		uint32_t face_count;
+		uint32_t index_count;
+		uint32_t index_size;
+		uint32_t max_index;
+		uint32_t meshlet_count;
+		float screen_size;
+		uint32_t reserved;
+		uint64_t vertices;
+		uint64_t normals;
+		uint64_t uvs;
+		uint64_t faces;
+		uint64_t indices;
+		uint64_t meshlets;
+	};
+	static Header make_header(const OVOParserSettings &settings);
+	static bool validate(const MappedFile &file, const std::string &source_path, const OVOParserSettings &settings);
+	static bool check_geometry(const MappedFile &file, const uint64_t offset);
+	static std::shared_ptr<const MeshGeometry> read_geometry(const MappedFile &file, const uint64_t offset);
+	static uint64_t write_geometry(FILE *file, uint64_t &offset, const MeshGeometry &geometry);
+	static uint64_t write_blob(FILE *file, uint64_t &offset, const void *data, const size_t size);
+};
+
+}
@@ -0,0 +1,309 @@
+/**
+ * @file	scene_index.cpp
+ * @brief	Scene index class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "scene_index.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+#include "node.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new, empty scene index.
+ */
+ENG_API SceneIndex::SceneIndex() {
+}
+
+/**
+ * Destroys the scene index.
+ * Every node still registered is detached, so that it no longer reports changes to the index.
+ */
+ENG_API SceneIndex::~SceneIndex() {
+	for (auto &item : this->by_id) {
+		item.second.node->index = nullptr;
+	}
+}
+
+/**
+ * Retrieves the number of nodes registered in the index.
+ *
+ * @return The number of indexed nodes.
+ */
+size_t ENG_API SceneIndex::size() const {
+	return this->by_id.size();
+}
+
+/**
+ * Retrieves the flat list of registered nodes, in no particular order.
+ * The list is updated in place as subtrees are attached and detached.
+ *
+ * @return A constant reference to the list of nodes.
+ */
+const std::vector<Node *> ENG_API &SceneIndex::get_nodes() const {
+	return this->nodes;
+}
+
+/**
+ * Finds a node by name.
+ * When several nodes share the same name, the first one registered is returned.
+ * Nodes that were never named are found by their default name, "[id]".
+ *
+ * @param name The name of the node to find.
+ * @return A shared pointer to the node, or nullptr if not found.
+ */
+std::shared_ptr<Node> ENG_API SceneIndex::find_by_name(const std::string_view name) const {
+	const auto it = this->by_name.find(Atom::find(name));
+	if (it != this->by_name.end() && !it->second.empty()) {
+		return it->second.front()->weak_from_this().lock();
+	}
+	// Default names are never interned, so they are resolved through the id
+	if (name.size() < 3 || name.size() > 11 || name.front() != '[' || name.back() != ']') return nullptr;
+	int id = 0;
+	for (size_t i = 1; i + 1 < name.size(); i++) {
+		if (name[i] < '0' || name[i] > '9') return nullptr;
+		id = id * 10 + (name[i] - '0');
+	}
+	const auto id_it = this->by_id.find(id);
+	if (id_it == this->by_id.end() || id_it->second.node->has_name()) return nullptr;
+	return id_it->second.node->weak_from_this().lock();
+}
+
+/**
+ * Finds a node by hierarchical path.
+ * A path is made of the names of the node's ancestors below the scene root and of the node itself,
+ * separated by '/' (e.g. "Root/Tower1/Disk3"). The scene root has the empty path.
+ * When several nodes share the same path, the first one registered is returned.
+ *
+ * @param path The path of the node to find.
+ * @return A shared pointer to the node, or nullptr if not found.
+ */
+std::shared_ptr<Node> ENG_API SceneIndex::find_by_path(const std::string_view path) const {
+	const auto it = this->by_path.find(path);
+	if (it == this->by_path.end() || it->second.empty()) return nullptr;
+	return it->second.front()->weak_from_this().lock();
+}
+
+/**
+ * Finds a node by its unique id.
+ *
+ * @param id The id of the node to find.
+ * @return A shared pointer to the node, or nullptr if not found.
+ */
+std::shared_ptr<Node> ENG_API SceneIndex::find_by_id(const int id) const {
+	const auto it = this->by_id.find(id);
+	if (it == this->by_id.end()) return nullptr;
+	return it->second.node->weak_from_this().lock();
+}
+
+/**
+ * Retrieves the hierarchical path of a registered node.
+ *
+ * @param node The node whose path to retrieve.
+ * @return The path of the node, or an empty string if the node is not registered.
+ */
+std::string ENG_API SceneIndex::get_path(const Node &node) const {
+	const auto it = this->by_id.find(node.get_id());
+	if (it == this->by_id.end()) return std::string();
+	return it->second.path;
+}
+
+/**
+ * Registers a node and its whole subtree.
+ * This method is called automatically when a subtree is attached to an indexed node.
+ *
+ * @param node The root of the subtree to register.
+ */
+void ENG_API SceneIndex::insert(Node &node) {
+	std::vector<Node *> stack{ &node };
+	while (!stack.empty()) {
+		Node *current = stack.back();
+		stack.pop_back();
+		if (current->index == this) continue;
+		if (UNLIKELY(current->index != nullptr)) {
+			current->index->remove(*current);
+		}
+		current->index = this;
+		Entry &entry = this->by_id[current->get_id()];
+		entry.node = current;
+		entry.slot = this->nodes.size();
+		this->nodes.push_back(current);
+		entry.path = this->build_path(*current);
+		this->insert_path(*current, entry);
+		if (current->has_name()) {
+			this->by_name[current->get_name_atom()].push_back(current);
+		}
+		for (auto it = current->children.rbegin(); it != current->children.rend(); ++it) {
+			stack.push_back(it->get());
+		}
+	}
+}
+
+/**
+ * Unregisters a node and its whole subtree.
+ * This method is called automatically when a subtree is destroyed or detached from the indexed scene.
+ *
+ * @param node The root of the subtree to unregister.
+ */
+void ENG_API SceneIndex::remove(Node &node) {
+	std::vector<Node *> stack{ &node };
+	while (!stack.empty()) {
+		Node *current = stack.back();
+		stack.pop_back();
+		if (current->index != this) continue;
+		this->unregister(*current);
+		for (const auto &child : current->children) {
+			stack.push_back(child.get());
+		}
+	}
+}
+
+/**
+ * Updates the index after a node has been renamed.
+ * The paths of the node and of its whole subtree are rebuilt.
+ *
+ * @param node The renamed node.
+ * @param old_name The name of the node before the change.
+ */
+void ENG_API SceneIndex::rename(Node &node, const Atom old_name) {
+	if (node.index != this) return;
+	this->erase_name(node, old_name);
+	if (node.has_name()) {
+		this->by_name[node.get_name_atom()].push_back(&node);
+	}
+	std::vector<Node *> stack{ &node };
+	while (!stack.empty()) {
+		Node *current = stack.back();
+		stack.pop_back();
+		if (current->index != this) continue;
+		Entry &entry = this->by_id.at(current->get_id());
+		this->erase_path(*current, entry);
+		entry.path = this->build_path(*current);
+		this->insert_path(*current, entry);
+		for (const auto &child : current->children) {
+			stack.push_back(child.get());
+		}
+	}
+}
+
+/**
+ * Reorders the flat node list into depth-first traversal order, parents before children.
+ * Attaching and detaching subtrees shuffles the list over time; restoring the traversal order
+ * keeps the render list walk cache-friendly and visits parents before their children.
+ */
+void ENG_API SceneIndex::defragment() {
+	std::vector<Node *> ordered;
+	ordered.reserve(this->nodes.size());
+	std::vector<Node *> stack;
+	for (Node *node : this->nodes) {
+		if (node->parent != nullptr && node->parent->index == this) continue;
+		stack.push_back(node);
+		while (!stack.empty()) {
+			Node *current = stack.back();
+			stack.pop_back();
+			if (current->index != this) continue;
+			this->by_id.at(current->get_id()).slot = ordered.size();
+			ordered.push_back(current);
+			for (auto it = current->children.rbegin(); it != current->children.rend(); ++it) {
+				stack.push_back(it->get());
+			}
+		}
+	}
+	this->nodes.swap(ordered);
+}
+
+/**
+ * Builds the path of a node from the path of its parent, which must already be registered.
+ *
+ * @param node The node whose path to build.
+ * @return The path of the node.
+ */
+std::string SceneIndex::build_path(const Node &node) const {
+	if (node.parent == nullptr || node.parent->index != this) return std::string();
+	const std::string &parent_path = this->by_id.at(node.parent->get_id()).path;
+	std::string path;
+	if (!parent_path.empty()) {
+		path.reserve(parent_path.size() + 16);
+		path.append(parent_path).push_back('/');
+	}
+	if (node.has_name()) {
+		path.append(node.get_name_atom().str());
+	} else {
+		path.append(node.get_default_name());
+	}
+	return path;
+}
+
+/**
+ * Registers the path of a node. Nodes sharing the same path are all kept, in registration order.
+ *
+ * @param node The node to register.
+ * @param entry The index entry of the node.
+ */
+void SceneIndex::insert_path(Node &node, Entry &entry) {
+	this->by_path[entry.path].push_back(&node);
+}
+
+/**
+ * Unregisters the path of a node.
+ *
+ * @param node The node to unregister.
+ * @param entry The index entry of the node.
+ */
+void SceneIndex::erase_path(const Node &node, const Entry &entry) {
+	const auto it = this->by_path.find(entry.path);
+	if (it == this->by_path.end()) return;
+	auto &nodes = it->second;
+	nodes.erase(std::remove(nodes.begin(), nodes.end(), &node), nodes.end());
+	if (nodes.empty()) {
+		this->by_path.erase(it);
+	}
+}
+
+/**
+ * Unregisters a node from the name table.
+ *
+ * @param node The node to unregister.
+ * @param name The name under which the node is registered.
+ */
+void SceneIndex::erase_name(const Node &node, const Atom name) {
+	const auto it = this->by_name.find(name);
+	if (it == this->by_name.end()) return;
+	auto &nodes = it->second;
+	nodes.erase(std::remove(nodes.begin(), nodes.end(), &node), nodes.end());
+	if (nodes.empty()) {
+		this->by_name.erase(it);
+	}
+}
+
+/**
+ * Unregisters a single node from every table and detaches it from the index.
+ *
+ * @param node The node to unregister.
+ */
+void SceneIndex::unregister(Node &node) {
+	const auto it = this->by_id.find(node.get_id());
+	if (it != this->by_id.end()) {
+		this->erase_path(node, it->second);
+		// Swap-remove from the node list, so that detaching costs O(1) per node
+		const size_t slot = it->second.slot;
+		Node *last = this->nodes.back();
+		this->nodes[slot] = last;
+		this->by_id.at(last->get_id()).slot = slot;
+		this->nodes.pop_back();
+		this->by_id.erase(it);
+	}
+	this->erase_name(node, node.get_name_atom());
+	node.index = nullptr;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file	scene_index.h
+ * @brief	Scene index class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "atom.h"
+#include "common.h"
+
+namespace lrvg {
+
+class Node;
+
+/**
+ * @brief Hash index over the nodes of a scene graph, by name, by hierarchical path and by id.
+ * The index also keeps a flat list of the nodes, used as render list.
+ * Nodes keep the index up to date as they are attached, detached, renamed and destroyed.
+ */
+class ENG_API SceneIndex final {
+public:
+	SceneIndex();
+	SceneIndex(SceneIndex const &) = delete;
+	void operator=(SceneIndex const &) = delete;
+	~SceneIndex();
+	size_t size() const;
+	const std::vector<Node *> &get_nodes() const;
+	std::shared_ptr<Node> find_by_name(const std::string_view name) const;
+	std::shared_ptr<Node> find_by_path(const std::string_view path) const;
+	std::shared_ptr<Node> find_by_id(const int id) const;
+	std::string get_path(const Node &node) const;
+	void insert(Node &node);
+	void remove(Node &node);
+	void rename(Node &node, const Atom old_name);
+	void defragment();
+private:
+	struct StringHash {
+		using is_transparent = void;
+		size_t operator()(const std::string_view key) const {
+			return std::hash<std::string_view>{}(key);
+		}
+	};
+	struct Entry {
+		Node *node;
+		size_t slot;
+		std::string path;
+	};
+	std::string build_path(const Node &node) const;
+	void insert_path(Node &node, Entry &entry);
+	void erase_path(const Node &node, const Entry &entry);
+	void erase_name(const Node &node, const Atom name);
+	void unregister(Node &node);
+	std::vector<Node *> nodes;
+	std::unordered_map<int, Entry> by_id;
+	std::unordered_map<Atom, std::vector<Node *>> by_name;
+	std::unordered_map<std::string, std::vector<Node *>, StringHash, std::equal_to<>> by_path;
+};
+
+}
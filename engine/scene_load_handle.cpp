@@ -0,0 +1,146 @@
+/**
+ * @file	scene_load_handle.cpp
+ * @brief	Asynchronous OVO scene load handle class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "scene_load_handle.h"
+
+#include <chrono>
+#include <unordered_set>
+
+#include "common.h"
+#include "material.h"
+
+using namespace lrvg;
+
+/**
+ * Share of the progress taken by parsing, the rest going to texture uploads.
+ */
+static constexpr float PARSE_PROGRESS_SHARE = 0.9f;
+
+/**
+ * Creates a new instance of SceneLoadHandle and starts parsing the file on a worker thread.
+ *
+ * @param path The file path to the OVO file.
+ * @param settings How the meshes of the file are processed.
+ */
+ENG_API SceneLoadHandle::SceneLoadHandle(const std::string &path, const OVOParserSettings &settings) : parser{ settings }, parsed{ false }, done{ false }, next{ 0 }, time_budget{ 0.002 } {
+	this->future = this->promise.get_future().share();
+	this->worker = std::thread(&SceneLoadHandle::worker_loop, this, path);
+}
+
+/**
+ * Destroys the SceneLoadHandle instance, waiting for the file to be parsed if it still is.
+ * A future obtained before and not ready yet reports a broken promise.
+ */
+ENG_API SceneLoadHandle::~SceneLoadHandle() {
+	if (this->worker.joinable()) {
+		this->worker.join();
+	}
+}
+
+/**
+ * Sets how long each call to `update` may spend uploading textures, at most.
+ * A single texture is always uploaded per call, however long it takes.
+ *
+ * @param seconds The time budget, in seconds (default: 0.002).
+ */
+void ENG_API SceneLoadHandle::set_time_budget(const double seconds) {
+	this->time_budget = seconds;
+}
+
+/**
+ * Uploads the next textures of the parsed scene, within the time budget, and makes the future
+ * ready once they are all uploaded.
+ * This is meant to be called once per frame, from the thread that owns the rendering context.
+ *
+ * @return Whether the whole scene is loaded.
+ */
+bool ENG_API SceneLoadHandle::update() {
+	if (this->done) {
+		return true;
+	}
+	if (!this->parsed.load(std::memory_order_acquire)) {
+		return false;
+	}
+	if (this->worker.joinable()) {
+		this->worker.join();
+	}
+	const auto start_time = std::chrono::steady_clock::now();
+	bool first = true;
+	while (this->next < this->textures.size()) {
+		if (!first && std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >= this->time_budget) {
+			return false;
+		}
+		first = false;
+		this->textures[this->next++]->upload();
+	}
+	this->textures.clear();
+	this->done = true;
+	this->promise.set_value(this->root);
+	return true;
+}
+
+/**
+ * Checks whether the whole scene is loaded, and the future ready.
+ *
+ * @return Whether the whole scene is loaded.
+ */
+bool ENG_API SceneLoadHandle::is_done() const {
+	return this->done;
+}
+
+/**
+ * Retrieves how far the load is, parsing first, then the texture uploads.
+ *
+ * @return The progress, from 0 to 1.
+ */
+float ENG_API SceneLoadHandle::get_progress() const {
+	if (this->done) {
+		return 1.0f;
+	}
+	if (!this->parsed.load(std::memory_order_acquire)) {
+		return this->parser.get_progress() * PARSE_PROGRESS_SHARE;
+	}
+	const float uploaded = this->textures.empty() ? 1.0f : (float)this->next / (float)this->textures.size();
+	return PARSE_PROGRESS_SHARE + uploaded * (1.0f - PARSE_PROGRESS_SHARE);
+}
+
+/**
+ * Retrieves the future to the root of the scene graph, ready once the whole scene is loaded.
+ *
+ * @return The future to the root Node of the scene graph.
+ */
+std::shared_future<std::shared_ptr<Node>> ENG_API SceneLoadHandle::get_future() const {
+	return this->future;
+}
+
+/**
+ * Gets the statistics of the load, once the file is parsed.
+ *
+ * @return The size, chunk count, timings and throughput of the load.
+ */
+const OVOLoadStats ENG_API &SceneLoadHandle::get_stats() const {
+	return this->parser.get_stats();
+}
+
+/**
+ * Parses the file, then lists the textures of the scene to upload, each once.
+ *
+ * @param path The file path to the OVO file.
+ */
+void SceneLoadHandle::worker_loop(const std::string path) {
+	this->root = this->parser.load(path);
+	std::unordered_set<const Texture *> seen;
+	for (const auto &[name, material] : this->parser.get_materials()) {
+		const std::shared_ptr<Texture> &texture = material->get_texture();
+		if (texture != nullptr && !texture->is_uploaded() && seen.insert(texture.get()).second) {
+			this->textures.push_back(texture);
+		}
+	}
+	this->parsed.store(true, std::memory_order_release);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file	scene_load_handle.h
+ * @brief	Asynchronous OVO scene load handle class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "node.h"
+#include "ovo_parser.h"
+#include "texture.h"
+
+namespace lrvg {
+
+/**
+ * @brief Loads an OVO scene in the background, as returned by `OVOParser::load_async`.
+ * The file is parsed and its meshes processed on a worker thread, while the calling thread keeps
+ * rendering. The textures of the scene are then uploaded by `update`, a few per call within a time
+ * budget, on the thread owning the rendering context; only then is the future made ready.
+ * Waiting on the future from that thread without calling `update` never returns.
+ */
+class ENG_API SceneLoadHandle final {
+public:
+	SceneLoadHandle(const std::string &path, const OVOParserSettings &settings);
+	SceneLoadHandle(SceneLoadHandle const &) = delete;
+	void operator=(SceneLoadHandle const &) = delete;
+	~SceneLoadHandle();
+	void set_time_budget(const double seconds);
+	bool update();
+	bool is_done() const;
+	float get_progress() const;
+	std::shared_future<std::shared_ptr<Node>> get_future() const;
+	const OVOLoadStats &get_stats() const;
+private:
+	void worker_loop(const std::string path);
+	OVOParser parser;
+	std::shared_ptr<Node> root;
+	std::vector<std::shared_ptr<Texture>> textures;
+	std::promise<std::shared_ptr<Node>> promise;
+	std::shared_future<std::shared_ptr<Node>> future;
+	std::thread worker;
+	std::atomic<bool> parsed;
+	bool done;
+	size_t next;
+	double time_budget;
+};
+
+}
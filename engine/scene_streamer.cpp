@@ -0,0 +1,241 @@
+/**
+ * @file	scene_streamer.cpp
+ * @brief	Progressive OVO scene loader class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "scene_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "common.h"
+#include "ovo_archive.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new instance of SceneStreamer for an OVO file.
+ * The file is mapped and its chunks are scanned right away; nothing is attached to the root
+ * until the first call to `update`.
+ *
+ * @param path The file path to the OVO file.
+ */
+ENG_API SceneStreamer::SceneStreamer(const std::string &path) : settings{ OVOParser::get_default_settings() }, stopping{ false }, stage{ Stage::Hierarchy }, next{ 0 }, remaining{ 0 }, applied_bytes{ 0 }, time_budget{ 0.002 }, byte_budget{ 0 } {
+	OVOParser::begin_scene(this->state);
+	if (UNLIKELY(!this->file.open(path))) {
+		ERROR("Failed to read file '%s'", path.c_str());
+		this->stage = Stage::Done;
+		return;
+	}
+	DEBUG("Streaming file '%s'...", path.c_str());
+	if (OVOArchive::is_compressed(this->file.data(), this->file.size())) {
+		if (UNLIKELY(!OVOArchive::decompress(this->file.data(), this->file.size(), this->image))) {
+			ERROR("Failed to decompress file '%s'", path.c_str());
+			this->stage = Stage::Done;
+			return;
+		}
+		this->chunks = OVOParser::scan_chunks(this->image.data(), this->image.size());
+		return;
+	}
+	this->chunks = OVOParser::scan_chunks(this->file.data(), this->file.size());
+}
+
+/**
+ * Destroys the SceneStreamer instance, abandoning the meshes not decoded yet.
+ * The scene graph attached so far stays valid.
+ */
+ENG_API SceneStreamer::~SceneStreamer() {
+	this->stopping = true;
+	if (this->worker.joinable()) {
+		this->worker.join();
+	}
+}
+
+/**
+ * Sets how long each call to `update` may take, at most.
+ * A single piece of the scene is always loaded per call, however long it takes.
+ *
+ * @param seconds The time budget, in seconds (default: 0.002).
+ */
+void ENG_API SceneStreamer::set_time_budget(const double seconds) {
+	this->time_budget = seconds;
+}
+
+/**
+ * Sets how many bytes of the file each call to `update` may load, at most.
+ * A single piece of the scene is always loaded per call, however large it is.
+ *
+ * @param bytes The byte budget, or 0 for no limit (default: 0).
+ */
+void ENG_API SceneStreamer::set_byte_budget(const size_t bytes) {
+	this->byte_budget = bytes;
+}
+
+/**
+ * Retrieves the root of the scene, which grows as the streamer is updated.
+ *
+ * @return A shared pointer to the root Node of the scene graph.
+ */
+std::shared_ptr<Node> ENG_API SceneStreamer::get_root() const {
+	return this->state.root;
+}
+
+/**
+ * Loads the next pieces of the scene into the scene graph, within the time and byte budgets.
+ * This is meant to be called once per frame, from the thread that owns the rendering context.
+ *
+ * @return Whether the whole scene is loaded.
+ */
+bool ENG_API SceneStreamer::update() {
+	const auto start_time = std::chrono::steady_clock::now();
+	size_t spent_bytes = 0;
+	bool first = true;
+	while (this->stage != Stage::Done) {
+		if (!first) {
+			const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+			if (elapsed >= this->time_budget || (this->byte_budget > 0 && spent_bytes >= this->byte_budget)) {
+				break;
+			}
+		}
+		first = false;
+		if (this->stage == Stage::Hierarchy) {
+			if (this->next == this->chunks.size()) {
+				this->start_meshes();
+				continue;
+			}
+			const OVOParser::Chunk &chunk = this->chunks[this->next++];
+			OVOParser::add_chunk(this->state, chunk);
+			// Materials and meshes are accounted for once they are decoded
+			if (chunk.type != 9 && chunk.type != 18) {
+				spent_bytes += chunk.size;
+				this->applied_bytes += chunk.size;
+			}
+		} else if (this->stage == Stage::Materials) {
+			if (this->next == this->state.material_chunks.size()) {
+				for (const OVOParser::MeshChunk &chunk : this->state.mesh_chunks) {
+					OVOParser::link_mesh(this->materials, chunk);
+				}
+				this->stage = this->remaining > 0 ? Stage::Meshes : Stage::Done;
+				continue;
+			}
+			OVOParser::MaterialChunk &chunk = this->state.material_chunks[this->next++];
+			chunk.texture_name = OVOParser::parse_material_chunk(*chunk.material, chunk.data, chunk.size);
+			OVOParser::link_material(this->materials, chunk);
+			spent_bytes += chunk.size;
+			this->applied_bytes += chunk.size;
+		} else {
+			Result result;
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				if (this->results.empty()) {
+					break;
+				}
+				result = std::move(this->results.front());
+				this->results.pop_front();
+			}
+			const OVOParser::MeshChunk &chunk = this->state.mesh_chunks[result.index];
+			chunk.mesh->set_geometry(result.geometry);
+			spent_bytes += chunk.size;
+			if (!result.coarse) {
+				this->applied_bytes += chunk.size;
+				if (--this->remaining == 0) {
+					this->stage = Stage::Done;
+				}
+			}
+		}
+	}
+	if (this->stage == Stage::Done && this->worker.joinable()) {
+		this->worker.join();
+		DEBUG("Scene streamed successfully: %.2f MB.", (double)this->get_data_size() / (1024.0 * 1024.0));
+	}
+	return this->stage == Stage::Done;
+}
+
+/**
+ * Checks whether the whole scene is loaded.
+ *
+ * @return Whether the whole scene is loaded.
+ */
+bool ENG_API SceneStreamer::is_done() const {
+	return this->stage == Stage::Done;
+}
+
+/**
+ * Retrieves the fraction of the file loaded into the scene graph so far.
+ *
+ * @return The progress, from 0 to 1.
+ */
+float ENG_API SceneStreamer::get_progress() const {
+	if (this->stage == Stage::Done || this->get_data_size() == 0) {
+		return 1.0f;
+	}
+	return std::min((float)this->applied_bytes / (float)this->get_data_size(), 1.0f);
+}
+
+/**
+ * Gets the size of the OVO data being streamed, decompressed if the file is compressed.
+ *
+ * @return The size of the data, in bytes.
+ */
+size_t SceneStreamer::get_data_size() const {
+	return this->image.empty() ? this->file.size() : this->image.size();
+}
+
+/**
+ * Queues the meshes of the scene for decoding and starts the worker thread.
+ * The coarsest level of detail of every mesh that stores several is decoded first, so the whole
+ * scene shows up quickly, then the full meshes, from the smallest to the largest. Each job decodes
+ * into a staging mesh of its own, whose geometry is then shared with the mesh in the scene graph.
+ */
+void SceneStreamer::start_meshes() {
+	const std::vector<OVOParser::MeshChunk> &mesh_chunks = this->state.mesh_chunks;
+	std::vector<size_t> order(mesh_chunks.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+		return mesh_chunks[a].size < mesh_chunks[b].size;
+	});
+	for (const size_t i : order) {
+		if (OVOParser::get_lod_count(mesh_chunks[i]) > 1) {
+			OVOParser::MeshChunk chunk = mesh_chunks[i];
+			chunk.mesh = std::make_shared<Mesh>();
+			this->jobs.push_back(Job{ i, true, chunk });
+		}
+	}
+	for (const size_t i : order) {
+		OVOParser::MeshChunk chunk = mesh_chunks[i];
+		chunk.mesh = std::make_shared<Mesh>();
+		this->jobs.push_back(Job{ i, false, chunk });
+	}
+	this->remaining = mesh_chunks.size();
+	this->stage = Stage::Materials;
+	this->next = 0;
+	if (!this->jobs.empty()) {
+		this->worker = std::thread(&SceneStreamer::worker_loop, this);
+	}
+}
+
+/**
+ * Decodes and processes the queued meshes, one at a time, handing each geometry over to `update`.
+ * A dedicated thread is used rather than the shared thread pool, so that long decodes never hold
+ * back the other engine stages; processing still spreads over the pool where it can.
+ */
+void SceneStreamer::worker_loop() {
+	for (const Job &job : this->jobs) {
+		if (this->stopping) {
+			return;
+		}
+		const OVOParser::MeshChunk &chunk = job.chunk;
+		OVOParser::decode_mesh_chunk(chunk, job.coarse);
+		if (!job.coarse) {
+			OVOParser::process_mesh(*chunk.mesh, this->settings);
+		}
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->results.push_back(Result{ job.index, job.coarse, chunk.mesh->get_geometry() });
+	}
+}
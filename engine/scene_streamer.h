@@ -0,0 +1,92 @@
+/**
+ * @file	scene_streamer.h
+ * @brief	Progressive OVO scene loader class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common.h"
+#include "mapped_file.h"
+#include "material.h"
+#include "mesh.h"
+#include "node.h"
+#include "ovo_parser.h"
+
+namespace lrvg {
+
+/**
+ * @brief Loads an OVO scene progressively, a few pieces per frame, into a scene graph that is
+ * already live.
+ * Each call to `update` spends at most a time or byte budget: the hierarchy is attached first,
+ * with meshes still empty, then the materials and textures, and finally the geometry of the meshes,
+ * which is decoded and processed on a worker thread. Meshes stored with several levels of detail
+ * first get their coarsest one, then their full geometry, smallest meshes first.
+ * Meshes are processed with the default OVO parser settings at the time the streamer is created.
+ * Compressed OVO files are decompressed up front, when the streamer is created.
+ */
+class ENG_API SceneStreamer final {
+public:
+	explicit SceneStreamer(const std::string &path);
+	SceneStreamer(SceneStreamer const &) = delete;
+	void operator=(SceneStreamer const &) = delete;
+	~SceneStreamer();
+	void set_time_budget(const double seconds);
+	void set_byte_budget(const size_t bytes);
+	std::shared_ptr<Node> get_root() const;
+	bool update();
+	bool is_done() const;
+	float get_progress() const;
+private:
+	enum class Stage {
+		Hierarchy,
+		Materials,
+		Meshes,
+		Done
+	};
+	struct Job {
+		size_t index;
+		bool coarse;
+		OVOParser::MeshChunk chunk;
+	};
+	struct Result {
+		size_t index;
+		bool coarse;
+		std::shared_ptr<const MeshGeometry> geometry;
+	};
+	void start_meshes();
+	void worker_loop();
+	size_t get_data_size() const;
+	MappedFile file;
+	std::vector<uint8_t> image;
+	std::vector<OVOParser::Chunk> chunks;
+	OVOParserSettings settings;
+	OVOParser::SceneState state;
+	std::unordered_map<std::string, std::shared_ptr<Material>> materials;
+	std::vector<Job> jobs;
+	std::deque<Result> results;
+	std::mutex mutex;
+	std::thread worker;
+	std::atomic<bool> stopping;
+	Stage stage;
+	size_t next;
+	size_t remaining;
+	size_t applied_bytes;
+	double time_budget;
+	size_t byte_budget;
+};
+
+}
@@ -9,43 +9,83 @@
 
 #include "sphere.h"
 
+#include <algorithm>
+#include <span>
+#include <tuple>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
 #include "common.h"
+#include "geometry_cache.h"
 #include "mesh.h"
+#include "mesh_builder.h"
+#include "mesh_optimizer.h"
 
 using namespace lrvg;
 
+/**
+ * Creates a new instance of Sphere, of radius 1 and centered at the origin.
+ * Spheres with the same segment counts share their geometry.
+ * 
+ * @param lat_segments Number of subdivisions from pole to pole (default: 20)
+ * @param lon_segments Number of subdivisions around the axis (default: 20)
+ */
 Sphere::Sphere(int lat_segments, int lon_segments) {
-	std::vector<glm::vec3> vertices;
-	std::vector<glm::vec3> normals;
-	std::vector<glm::vec2> uvs;
-	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> faces;
-	for (int y = 0; y <= lat_segments; ++y) {
-		float v = (float)y / (float)lat_segments;
-		float theta = v * glm::pi<float>();
-		for (int x = 0; x <= lon_segments; ++x) {
-			float u = (float)x / (float)lon_segments;
-			float phi = u * glm::two_pi<float>();
-			float xs = sin(theta) * cos(phi);
-			float ys = cos(theta);
-			float zs = sin(theta) * sin(phi);
-			vertices.emplace_back(xs, ys, zs);
-			normals.emplace_back(glm::normalize(glm::vec3(xs, ys, zs)));
-			uvs.emplace_back(u, 1.0f - v);
+	lat_segments = std::max(lat_segments, 1);
+	lon_segments = std::max(lon_segments, 1);
+	this->set_geometry(GeometryCache::get_shared().get(PrimitiveType::Sphere, lat_segments, lon_segments, [=]() {
+		return Sphere::generate(lat_segments, lon_segments);
+	}));
+	this->set_cast_shadows(true);
+}
+
+/**
+ * Generates the optimized geometry of a sphere. Rows are generated in parallel for large spheres.
+ * 
+ * @param lat_segments Number of subdivisions from pole to pole
+ * @param lon_segments Number of subdivisions around the axis
+ * @return The full-resolution level of detail of the sphere.
+ */
+MeshLOD Sphere::generate(int lat_segments, int lon_segments) {
+	const size_t row_size = (size_t)lon_segments + 1;
+	MeshBuilder builder;
+	builder.resize((size_t)(lat_segments + 1) * row_size, 2 * (size_t)lat_segments * lon_segments);
+	const std::span<glm::vec3> vertices = builder.get_vertices();
+	const std::span<glm::vec3> normals = builder.get_normals();
+	const std::span<glm::vec2> uvs = builder.get_uvs();
+	const std::span<std::tuple<uint32_t, uint32_t, uint32_t>> faces = builder.get_faces();
+	GeometryCache::parallel_rows(lat_segments + 1, row_size, [&](const size_t begin, const size_t end) {
+		for (size_t y = begin; y < end; ++y) {
+			float v = (float)y / (float)lat_segments;
+			float theta = v * glm::pi<float>();
+			for (int x = 0; x <= lon_segments; ++x) {
+				float u = (float)x / (float)lon_segments;
+				float phi = u * glm::two_pi<float>();
+				float xs = sin(theta) * cos(phi);
+				float ys = cos(theta);
+				float zs = sin(theta) * sin(phi);
+				const size_t i = y * row_size + x;
+				vertices[i] = glm::vec3(xs, ys, zs);
+				normals[i] = glm::normalize(glm::vec3(xs, ys, zs));
+				uvs[i] = glm::vec2(u, 1.0f - v);
+			}
 		}
-	}
-	for (int y = 0; y < lat_segments; ++y) {
-		for (int x = 0; x < lon_segments; ++x) {
-			uint32_t i0 = y * (lon_segments + 1) + x;
-			uint32_t i1 = i0 + 1;
-			uint32_t i2 = i0 + (lon_segments + 1);
-			uint32_t i3 = i2 + 1;
-			faces.emplace_back(i0, i1, i2);
-			faces.emplace_back(i2, i1, i3);
+	});
+	GeometryCache::parallel_rows(lat_segments, row_size, [&](const size_t begin, const size_t end) {
+		for (size_t y = begin; y < end; ++y) {
+			for (int x = 0; x < lon_segments; ++x) {
+				uint32_t i0 = (uint32_t)(y * row_size + x);
+				uint32_t i1 = i0 + 1;
+				uint32_t i2 = i0 + (uint32_t)row_size;
+				uint32_t i3 = i2 + 1;
+				const size_t f = 2 * (y * lon_segments + x);
+				faces[f] = std::make_tuple(i0, i1, i2);
+				faces[f + 1] = std::make_tuple(i2, i1, i3);
+			}
 		}
-	}
-	this->set_mesh_data(vertices, faces, normals, uvs);
-	this->set_cast_shadows(true);
+	});
+	MeshLOD lod = builder.build();
+	MeshOptimizer::optimize(lod);
+	return lod;
 }
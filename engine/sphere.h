@@ -20,6 +20,7 @@ namespace lrvg {
 class ENG_API Sphere : public Mesh {
 public:
     Sphere(int lat_segments = 20, int lon_segments = 20);
+    static MeshLOD generate(int lat_segments, int lon_segments);
 };
 
 }
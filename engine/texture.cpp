@@ -44,16 +44,34 @@ ENG_API Texture::Texture(const std::string path) {
 		return;
 	}
 	this->bitmap = (void*)converted;
-	const int width = FreeImage_GetWidth(converted);
-	const int height = FreeImage_GetHeight(converted);
-	BYTE* bits = FreeImage_GetBits(converted);
-	if (bits == nullptr || width == 0 || height == 0) {
+	this->texture_id = 0;
+	if (FreeImage_GetBits(converted) == nullptr || FreeImage_GetWidth(converted) == 0 || FreeImage_GetHeight(converted) == 0) {
 		ERROR("Invalid image data for texture: %s", path.c_str());
 		FreeImage_Unload(converted);
 		this->bitmap = nullptr;
-		this->texture_id = 0;
-		return;
 	}
+}
+
+/**
+ * Checks whether the texture has been uploaded to OpenGL.
+ *
+ * @return true if the texture is uploaded, false otherwise.
+ */
+bool ENG_API Texture::is_uploaded() const {
+	return this->texture_id != 0;
+}
+
+/**
+ * Uploads the image of the texture to OpenGL, if not done yet.
+ * This happens the first time the texture is rendered, but can be done earlier to spread the
+ * work over several frames; either way, only on the thread owning the rendering context.
+ */
+void ENG_API Texture::upload() const {
+	if (this->texture_id != 0 || this->bitmap == nullptr) return;
+	FIBITMAP* converted = (FIBITMAP*)this->bitmap;
+	const int width = FreeImage_GetWidth(converted);
+	const int height = FreeImage_GetHeight(converted);
+	BYTE* bits = FreeImage_GetBits(converted);
 	glGenTextures(1, &this->texture_id);
 	glBindTexture(GL_TEXTURE_2D, this->texture_id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -82,13 +100,14 @@ ENG_API Texture::~Texture() {
 
 /**
  * Renders the texture using the provided world transformation matrix.
- * This method binds the texture and enables 2D texturing in OpenGL.
+ * This method uploads the texture on first use, then binds it in OpenGL.
  * 
  * 
  * @param world_matrix A glm::mat4 representing the world transformation matrix.
  */
 void ENG_API Texture::render(const glm::mat4 world_matrix) const {
     (void)world_matrix;
+	this->upload();
 	if (this->texture_id == 0) return;
 	glBindTexture(GL_TEXTURE_2D, this->texture_id);
 }
@@ -32,10 +32,12 @@ class ENG_API Texture : public Object {
 public:
 	Texture(const std::string path);
 	~Texture();
+	bool is_uploaded() const;
+	void upload() const;
 	void render(const glm::mat4 world_matrix) const override;
 private:
 	void* bitmap;
-	unsigned int texture_id;
+	mutable unsigned int texture_id;
 };
 
 }
@@ -0,0 +1,168 @@
+/**
+ * @file	thread_pool.cpp
+ * @brief	Thread pool class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "common.h"
+
+using namespace lrvg;
+
+/**
+ * Creates a new thread pool.
+ *
+ * A `thread_count` of 0 sizes the pool after the hardware concurrency, keeping one core for the
+ * calling thread, which always takes part in `parallel_for`. At least one worker is always
+ * spawned, so that tasks queued with `enqueue` or `submit` make progress on single-core machines.
+ *
+ * @param thread_count The number of worker threads to spawn (0 for automatic sizing).
+ */
+ENG_API ThreadPool::ThreadPool(const unsigned int thread_count) : stopping{ false } {
+	unsigned int count = thread_count;
+	if (count == 0) {
+		const unsigned int hw = std::thread::hardware_concurrency();
+		count = hw > 1 ? hw - 1 : 1;
+	}
+	this->workers.reserve(count);
+	for (unsigned int i = 0; i < count; i++) {
+		this->workers.emplace_back(&ThreadPool::worker_loop, this);
+	}
+}
+
+/**
+ * Destroys the thread pool.
+ * Pending tasks are drained before the workers are joined.
+ */
+ENG_API ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->cv.notify_all();
+	for (auto &worker : this->workers) {
+		worker.join();
+	}
+}
+
+/**
+ * Retrieves the number of worker threads owned by the pool.
+ *
+ * @return The number of worker threads.
+ */
+unsigned int ENG_API ThreadPool::get_thread_count() const {
+	return (unsigned int)this->workers.size();
+}
+
+/**
+ * Queues a task for asynchronous execution on one of the workers.
+ *
+ * @param task The task to execute.
+ */
+void ENG_API ThreadPool::enqueue(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push(std::move(task));
+	}
+	this->cv.notify_one();
+}
+
+/**
+ * Splits the range [0, count) into contiguous chunks and processes them in parallel.
+ * The calling thread processes chunks as well and the call returns once every chunk is done,
+ * so it is safe to invoke `parallel_for` from within a pool task.
+ *
+ * @param count The number of items to process.
+ * @param fn The function invoked once per chunk with the [begin, end) item range.
+ */
+void ENG_API ThreadPool::parallel_for(const size_t count, const std::function<void(const size_t begin, const size_t end)> &fn) {
+	if (UNLIKELY(count == 0)) return;
+	const size_t chunks = std::min(count, (size_t)this->workers.size() + 1);
+	if (chunks <= 1) {
+		fn(0, count);
+		return;
+	}
+	struct State {
+		std::atomic<size_t> next{ 0 };
+		size_t done = 0;
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+	// Helpers that start after every chunk has been claimed only touch the shared state,
+	// which outlives this call, never `fn`.
+	auto state = std::make_shared<State>();
+	const std::function<void(const size_t, const size_t)> *body = &fn;
+	auto run = [state, body, count, chunks]() {
+		size_t chunk;
+		while ((chunk = state->next.fetch_add(1)) < chunks) {
+			const size_t begin = count * chunk / chunks;
+			const size_t end = count * (chunk + 1) / chunks;
+			(*body)(begin, end);
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (++state->done == chunks) {
+				state->cv.notify_all();
+			}
+		}
+	};
+	for (size_t i = 1; i < chunks; i++) {
+		this->enqueue(run);
+	}
+	run();
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->cv.wait(lock, [&state, chunks]() { return state->done == chunks; });
+}
+
+/**
+ * Processes the items of the range [0, count) in parallel, handing them out one at a time.
+ * Unlike `parallel_for`, whose chunks are fixed up front, a thread takes the next item as soon as
+ * it is done with one, which balances the load when items vary widely in cost. Items that are
+ * sorted from most to least expensive make the best use of it.
+ *
+ * @param count The number of items to process.
+ * @param fn The function invoked once per item with its index.
+ */
+void ENG_API ThreadPool::parallel_for_each(const size_t count, const std::function<void(const size_t index)> &fn) {
+	// The cursor lives on this stack frame: `parallel_for` returns only once every chunk is done,
+	// and late helpers never run the chunk body
+	std::atomic<size_t> next{ 0 };
+	this->parallel_for(count, [&](const size_t, const size_t) {
+		size_t i;
+		while ((i = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+			fn(i);
+		}
+	});
+}
+
+/**
+ * Retrieves the process-wide pool used by the engine stages.
+ *
+ * @return A reference to the shared thread pool.
+ */
+ThreadPool ENG_API &ThreadPool::get_shared() {
+	static ThreadPool pool;
+	return pool;
+}
+
+/**
+ * Worker thread body: pops and runs tasks until the pool is stopped and drained.
+ */
+void ThreadPool::worker_loop() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->cv.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+			if (this->stopping && this->tasks.empty()) return;
+			task = std::move(this->tasks.front());
+			this->tasks.pop();
+		}
+		task();
+	}
+}
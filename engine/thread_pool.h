@@ -0,0 +1,58 @@
+/**
+ * @file	thread_pool.h
+ * @brief	Thread pool class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Fixed-size pool of worker threads shared by the CPU-side engine stages.
+ */
+class ENG_API ThreadPool final {
+public:
+	explicit ThreadPool(const unsigned int thread_count = 0);
+	ThreadPool(ThreadPool const &) = delete;
+	void operator=(ThreadPool const &) = delete;
+	~ThreadPool();
+	unsigned int get_thread_count() const;
+	void parallel_for(const size_t count, const std::function<void(const size_t begin, const size_t end)> &fn);
+	void parallel_for_each(const size_t count, const std::function<void(const size_t index)> &fn);
+	void enqueue(std::function<void()> task);
+	template <typename F>
+	std::future<std::invoke_result_t<F>> submit(F &&fn) {
+		using result_t = std::invoke_result_t<F>;
+		auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(fn));
+		std::future<result_t> future = task->get_future();
+		this->enqueue([task]() { (*task)(); });
+		return future;
+	}
+	static ThreadPool &get_shared();
+private:
+	void worker_loop();
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool stopping;
+};
+
+}
@@ -0,0 +1,183 @@
+/**
+ * @file	vertex_decoder.cpp
+ * @brief	Packed vertex stream decoder class implementation
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#include "vertex_decoder.h"
+
+#include <cstring>
+
+#include <glm/gtc/packing.hpp>
+
+#include "common.h"
+
+#if defined(HAS_SSE2)
+#include <emmintrin.h>
+#elif defined(HAS_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace lrvg;
+
+/**
+ * Scale of the signed normalized 10-bit components of packed normals.
+ */
+static constexpr float SNORM10_SCALE = 1.0f / 511.0f;
+
+/**
+ * Decodes the vertices in [begin, end) of a packed vertex stream, one at a time.
+ *
+ * @param data The packed vertex stream.
+ * @param begin The first vertex to decode.
+ * @param end The vertex past the last one to decode.
+ * @param vertices The array of positions to fill.
+ * @param normals The array of normals to fill.
+ * @param uvs The array of UVs to fill.
+ */
+static void decode_range(const uint8_t *data, const size_t begin, const size_t end, glm::vec3 *vertices, glm::vec3 *normals, glm::vec2 *uvs) {
+	for (size_t v = begin; v < end; v++) {
+		const uint8_t *vertex = data + v * VertexDecoder::STRIDE;
+		uint32_t packed[2];
+		memcpy(&vertices[v], vertex, sizeof(glm::vec3));
+		memcpy(packed, vertex + sizeof(glm::vec3), sizeof(packed));
+		normals[v] = glm::vec3(glm::unpackSnorm3x10_1x2(packed[0]));
+		uvs[v] = glm::unpackHalf2x16(packed[1]);
+	}
+}
+
+#if defined(HAS_SSE2)
+/**
+ * Converts four half floats, in the low 16 bits of each lane, to floats.
+ * Without F16C, the exponent is rebased with a multiplication, which also normalizes denormals;
+ * infinities and NaNs get their exponent restored afterwards.
+ *
+ * @param halves The half floats.
+ * @return The floats.
+ */
+static INLINE __m128 half_to_float(const __m128i halves) {
+	const __m128i exponent_mantissa = _mm_and_si128(halves, _mm_set1_epi32(0x7fff));
+	const __m128i sign = _mm_slli_epi32(_mm_xor_si128(halves, exponent_mantissa), 16);
+	const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponent_mantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+	const __m128i inf_nan = _mm_cmpgt_epi32(exponent_mantissa, _mm_set1_epi32(0x7bff));
+	const __m128 inf_nan_exponent = _mm_and_ps(_mm_castsi128_ps(inf_nan), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+	return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), inf_nan_exponent));
+}
+
+/**
+ * Extracts a signed normalized 10-bit component from four packed normals, as a float in [-1, 1].
+ *
+ * @tparam SHIFT The position of the component in the packed normals.
+ * @param packed The packed normals.
+ * @return The components.
+ */
+template <int SHIFT>
+static INLINE __m128 unpack_snorm10(const __m128i packed) {
+	const __m128i component = _mm_srai_epi32(_mm_slli_epi32(packed, 22 - SHIFT), 22);
+	const __m128 value = _mm_mul_ps(_mm_cvtepi32_ps(component), _mm_set1_ps(SNORM10_SCALE));
+	return _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+#elif defined(HAS_NEON)
+/**
+ * Converts four half floats, in the low 16 bits of each lane, to floats.
+ * The exponent is rebased with a multiplication, which also normalizes denormals; infinities and
+ * NaNs get their exponent restored afterwards.
+ *
+ * @param halves The half floats.
+ * @return The floats.
+ */
+static INLINE float32x4_t half_to_float(const uint32x4_t halves) {
+	const uint32x4_t exponent_mantissa = vandq_u32(halves, vdupq_n_u32(0x7fff));
+	const uint32x4_t sign = vshlq_n_u32(veorq_u32(halves, exponent_mantissa), 16);
+	const float32x4_t scaled = vmulq_f32(vreinterpretq_f32_u32(vshlq_n_u32(exponent_mantissa, 13)), vreinterpretq_f32_u32(vdupq_n_u32((254 - 15) << 23)));
+	const uint32x4_t inf_nan = vandq_u32(vcgtq_u32(exponent_mantissa, vdupq_n_u32(0x7bff)), vdupq_n_u32(255 << 23));
+	return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(scaled), vorrq_u32(sign, inf_nan)));
+}
+
+/**
+ * Extracts a signed normalized 10-bit component from four packed normals, as a float in [-1, 1].
+ *
+ * @tparam SHIFT The position of the component in the packed normals.
+ * @param packed The packed normals.
+ * @return The components.
+ */
+template <int SHIFT>
+static INLINE float32x4_t unpack_snorm10(const uint32x4_t packed) {
+	const int32x4_t component = vshrq_n_s32(vreinterpretq_s32_u32(vshlq_n_u32(packed, 22 - SHIFT)), 22);
+	const float32x4_t value = vmulq_f32(vcvtq_f32_s32(component), vdupq_n_f32(SNORM10_SCALE));
+	return vminq_f32(vmaxq_f32(value, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+}
+#endif
+
+/**
+ * Decodes a stream of packed vertices into pre-sized arrays of positions, normals and UVs.
+ * Blocks of four vertices are unpacked with SSE2 or NEON when available, the rest one at a time.
+ *
+ * @param data The packed vertex stream, with `vertices.size()` vertices.
+ * @param vertices The array of positions to fill.
+ * @param normals The array of normals to fill, of the same size.
+ * @param uvs The array of UVs to fill, of the same size.
+ */
+void ENG_API VertexDecoder::decode(const uint8_t *data, const std::span<glm::vec3> vertices, const std::span<glm::vec3> normals, const std::span<glm::vec2> uvs) {
+	const size_t count = vertices.size();
+	size_t v = 0;
+#if defined(HAS_SSE2)
+	for (; v + 4 <= count; v += 4) {
+		const uint8_t *block = data + v * STRIDE;
+		memcpy(&vertices[v], block, sizeof(glm::vec3));
+		memcpy(&vertices[v + 1], block + STRIDE, sizeof(glm::vec3));
+		memcpy(&vertices[v + 2], block + 2 * STRIDE, sizeof(glm::vec3));
+		memcpy(&vertices[v + 3], block + 3 * STRIDE, sizeof(glm::vec3));
+		// Gather the packed normal and UV of each vertex, then split them into two vectors
+		const __m128i packed01 = _mm_unpacklo_epi64(
+			_mm_loadl_epi64((const __m128i *)(block + sizeof(glm::vec3))),
+			_mm_loadl_epi64((const __m128i *)(block + STRIDE + sizeof(glm::vec3))));
+		const __m128i packed23 = _mm_unpacklo_epi64(
+			_mm_loadl_epi64((const __m128i *)(block + 2 * STRIDE + sizeof(glm::vec3))),
+			_mm_loadl_epi64((const __m128i *)(block + 3 * STRIDE + sizeof(glm::vec3))));
+		const __m128i packed_normals = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(packed01), _mm_castsi128_ps(packed23), _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i packed_uvs = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(packed01), _mm_castsi128_ps(packed23), _MM_SHUFFLE(3, 1, 3, 1)));
+		// Normals: x0..x3, y0..y3 and z0..z3, interleaved back into three vectors of xyz triples
+		const __m128 x = unpack_snorm10<0>(packed_normals);
+		const __m128 y = unpack_snorm10<10>(packed_normals);
+		const __m128 z = unpack_snorm10<20>(packed_normals);
+		const __m128 xy_lo = _mm_unpacklo_ps(x, y);
+		const __m128 xy_hi = _mm_unpackhi_ps(x, y);
+		float *normal_out = &normals[v].x;
+		_mm_storeu_ps(normal_out, _mm_shuffle_ps(xy_lo, _mm_shuffle_ps(z, xy_lo, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(normal_out + 4, _mm_shuffle_ps(_mm_shuffle_ps(xy_lo, z, _MM_SHUFFLE(1, 1, 3, 3)), xy_hi, _MM_SHUFFLE(1, 0, 2, 0)));
+		_mm_storeu_ps(normal_out + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, xy_hi, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(xy_hi, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+		// UVs: u in the low halves, v in the high ones
+		const __m128 u = half_to_float(_mm_and_si128(packed_uvs, _mm_set1_epi32(0xffff)));
+		const __m128 w = half_to_float(_mm_srli_epi32(packed_uvs, 16));
+		float *uv_out = &uvs[v].x;
+		_mm_storeu_ps(uv_out, _mm_unpacklo_ps(u, w));
+		_mm_storeu_ps(uv_out + 4, _mm_unpackhi_ps(u, w));
+	}
+#elif defined(HAS_NEON)
+	for (; v + 4 <= count; v += 4) {
+		const uint8_t *block = data + v * STRIDE;
+		alignas(16) uint32_t packed[2][4];
+		for (int lane = 0; lane < 4; lane++) {
+			memcpy(&vertices[v + lane], block + lane * STRIDE, sizeof(glm::vec3));
+			memcpy(&packed[0][lane], block + lane * STRIDE + sizeof(glm::vec3), sizeof(uint32_t));
+			memcpy(&packed[1][lane], block + lane * STRIDE + sizeof(glm::vec3) + sizeof(uint32_t), sizeof(uint32_t));
+		}
+		const uint32x4_t packed_normals = vld1q_u32(packed[0]);
+		const uint32x4_t packed_uvs = vld1q_u32(packed[1]);
+		float32x4x3_t normal;
+		normal.val[0] = unpack_snorm10<0>(packed_normals);
+		normal.val[1] = unpack_snorm10<10>(packed_normals);
+		normal.val[2] = unpack_snorm10<20>(packed_normals);
+		vst3q_f32(&normals[v].x, normal);
+		float32x4x2_t uv;
+		uv.val[0] = half_to_float(vandq_u32(packed_uvs, vdupq_n_u32(0xffff)));
+		uv.val[1] = half_to_float(vshrq_n_u32(packed_uvs, 16));
+		vst2q_f32(&uvs[v].x, uv);
+	}
+#endif
+	decode_range(data, v, count, vertices.data(), normals.data(), uvs.data());
+}
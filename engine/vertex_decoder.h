@@ -0,0 +1,35 @@
+/**
+ * @file	vertex_decoder.h
+ * @brief	Packed vertex stream decoder class definition
+ *
+ * @author	Luca Mazza          (C) SUPSI [luca.mazza@student.supsi.ch]
+ * @author	Roeld Hoxha         (C) SUPSI [roeld.hoxha@student.supsi.ch]
+ * @author	Vasco Silva Pereira (C) SUPSI [vasco.silvapereira@student.supsi.ch]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "common.h"
+
+namespace lrvg {
+
+/**
+ * @brief Decodes whole streams of packed vertices into pre-sized arrays.
+ * Vertices are stored as in OVO files: a position, a normal packed as signed normalized 10-10-10-2,
+ * a UV packed as two half floats, and a packed tangent, which is skipped. Normals and UVs are
+ * unpacked four vertices at a time with SSE2 or NEON when available, with the same results as
+ * `glm::unpackSnorm3x10_1x2` and `glm::unpackHalf2x16`.
+ */
+class ENG_API VertexDecoder final {
+public:
+	static constexpr size_t STRIDE = sizeof(glm::vec3) + 3 * sizeof(uint32_t);
+	static void decode(const uint8_t *data, const std::span<glm::vec3> vertices, const std::span<glm::vec3> normals, const std::span<glm::vec2> uvs);
+};
+
+}